@@ -0,0 +1,216 @@
+/*
+    Copyright 2013 Adobe
+    Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*/
+/******************************************************************************/
+
+#ifndef ADOBE_FILTERED_SEQUENCE_MODEL_HPP
+#define ADOBE_FILTERED_SEQUENCE_MODEL_HPP
+
+/******************************************************************************/
+
+#include <adobe/config.hpp>
+
+#include <vector>
+
+#include <boost/function.hpp>
+
+#include <adobe/implementation/derived_sequence_model.hpp>
+
+/******************************************************************************/
+
+namespace adobe {
+
+/******************************************************************************/
+/*!
+    \ingroup sequence_mvc
+
+    \brief The elements of a sequence_model that satisfy a predicate, in
+    the order of the source.
+
+    A filtered_sequence_model is attached to its source as a
+    SequenceView (for instance with attach_sequence_view_to_sequence_model)
+    and serves as the model for any number of downstream views, which
+    attach to it the same way. It follows the notifications of the
+    source: a change to one element costs O(log n) and results in at
+    most one notification downstream. Elements moved in the source are
+    moved downstream, not erased and extended.
+
+    Changing the predicate re-evaluates every element, but the views are
+    only told about the elements whose visibility changed: one erase for
+    those hidden and one extend_set per run of those shown.
+
+    The keys the downstream views see are the keys of the source model.
+*/
+template <typename T>
+class filtered_sequence_model : public implementation::derived_sequence_model<T>
+{
+    typedef implementation::derived_sequence_model<T> base_type;
+    typedef typename base_type::node_t                node_t;
+    typedef typename base_type::tree_type             tree_type;
+
+public:
+    typedef typename base_type::value_type     value_type;
+    typedef typename base_type::size_type      size_type;
+    typedef typename base_type::cow_value_type cow_value_type;
+    typedef typename base_type::key_type       key_type;
+
+    /// an empty predicate lets every element through
+    typedef boost::function<bool (const value_type&)> predicate_t;
+
+    explicit filtered_sequence_model(const predicate_t& predicate = predicate_t()) :
+        predicate_m(predicate)
+    { }
+
+    const predicate_t& predicate() const
+    { return predicate_m; }
+
+    void set_predicate(const predicate_t& predicate);
+
+    /*
+        SequenceView requirements, called by the source model.
+    */
+
+    void refresh(key_type key, const cow_value_type& value)
+    {
+        node_t* node(this->node_for(key));
+
+        if (node == 0)
+            return;
+
+        size_type old_weight(node->weight_m);
+        size_type new_weight(weight(*value));
+
+        node->value_m.value_m = value;
+
+        if (old_weight == new_weight)
+        {
+            if (new_weight != 0)
+                this->notify_refresh(key, value);
+
+            return;
+        }
+
+        this->tree_m.set_weight(node, new_weight);
+
+        if (new_weight != 0)
+            this->notify_extend(this->visible_after(node), key, value);
+        else
+            this->notify_erase(std::vector<key_type>(1, key));
+    }
+
+    void extend(key_type before, key_type key, const cow_value_type& value)
+    {
+        node_t* node(this->add(this->node_for(before), key, value, weight(*value)));
+
+        if (node->weight_m != 0)
+            this->notify_extend(this->visible_after(node), key, value);
+    }
+
+    void extend_set(key_type before, const std::vector<key_type>& key_set)
+    {
+        typedef typename std::vector<key_type>::const_iterator const_iterator;
+
+        node_t*              before_node(this->node_for(before));
+        std::vector<node_t*> shown;
+
+        for (const_iterator iter(key_set.begin()), last(key_set.end()); iter != last; ++iter)
+        {
+            cow_value_type value(base_type::at(*iter));
+            node_t*        node(this->add(before_node, *iter, value, weight(*value)));
+
+            if (node->weight_m != 0)
+                shown.push_back(node);
+        }
+
+        this->notify_shown(shown);
+    }
+
+    void move(const std::vector<key_type>& key_set, key_type before)
+    {
+        typedef typename std::vector<key_type>::const_iterator const_iterator;
+
+        node_t*               before_node(this->node_for(before));
+        node_t*               node(0);
+        std::vector<key_type> moved;
+
+        for (const_iterator iter(key_set.begin()), last(key_set.end()); iter != last; ++iter)
+        {
+            node = this->node_for(*iter);
+
+            if (node == 0)
+                continue;
+
+            size_type      node_weight(node->weight_m);
+            cow_value_type value(node->value_m.value_m);
+
+            this->remove(node);
+
+            node = this->add(before_node, *iter, value, node_weight);
+
+            if (node_weight != 0)
+                moved.push_back(*iter);
+        }
+
+        if (!moved.empty())
+            this->notify_move(moved, this->visible_after(this->node_for(moved.back())));
+    }
+
+private:
+    size_type weight(const value_type& value) const
+    { return !predicate_m || predicate_m(value) ? 1 : 0; }
+
+    predicate_t predicate_m;
+};
+
+/******************************************************************************/
+
+template <typename T>
+void filtered_sequence_model<T>::set_predicate(const predicate_t& predicate)
+{
+    predicate_m = predicate;
+
+    std::vector<key_type> hidden;
+    std::vector<node_t*>  shown;
+
+    for (node_t* node(this->tree_m.front()); node; node = tree_type::next(node))
+    {
+        size_type new_weight(weight(*node->value_m.value_m));
+
+        if (node->weight_m == new_weight)
+            continue;
+
+        if (new_weight == 0)
+        {
+            hidden.push_back(node->value_m.key_m);
+
+            this->tree_m.set_weight(node, 0);
+        }
+        else
+        {
+            shown.push_back(node);
+        }
+    }
+
+    // The hidden elements go first so the views never see a position
+    // relative to an element that is about to disappear.
+
+    if (!hidden.empty())
+        this->notify_erase(hidden);
+
+    for (typename std::vector<node_t*>::iterator iter(shown.begin()), last(shown.end());
+         iter != last; ++iter)
+        this->tree_m.set_weight(*iter, 1);
+
+    this->notify_shown(shown);
+}
+
+/******************************************************************************/
+
+} // namespace adobe
+
+/******************************************************************************/
+// ADOBE_FILTERED_SEQUENCE_MODEL_HPP
+#endif
+/******************************************************************************/
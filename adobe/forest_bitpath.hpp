@@ -12,6 +12,11 @@
 
 #include <adobe/config.hpp>
 
+#include <algorithm>
+#include <ostream>
+#include <vector>
+
+#include <boost/cstdint.hpp>
 #include <boost/dynamic_bitset.hpp>
 #include <boost/operators.hpp>
 
@@ -32,126 +37,225 @@ enum
 
 /**************************************************************************************************/
 
+/*!
+    A path from the root of a forest to one of its nodes: bit n is the step
+    taken n steps before the last (bitpath_first_child or
+    bitpath_next_sibling), and the highest bit is always 1.
+
+    The bits are kept in the order they were pushed, so push() and pop()
+    touch only the last bit. Paths of up to inline_size_k bits are kept
+    within the bitpath_t itself; deeper ones are moved to the heap.
+*/
 struct bitpath_t : boost::totally_ordered<bitpath_t>
 {
     typedef unsigned char                     value_type;
     typedef boost::dynamic_bitset<value_type> path_type;
     typedef path_type::size_type              size_type;
 
+    enum
+    {
+        word_size_k = 64,
+        inline_word_count_k = 2,
+        inline_size_k = word_size_k * inline_word_count_k
+    };
+
     bitpath_t() :
-        path_m(size_type(1), path_type::block_type(1))
-    { }
+        size_m(0)
+    {
+        clear_inline();
+
+        push(true);
+    }
 
     template <typename ForestFullorderIterator>
     bitpath_t(ForestFullorderIterator node,
-              ForestFullorderIterator root)
+              ForestFullorderIterator root) :
+        size_m(0)
     {
-        while (true)
-        {
-            node = --adobe::leading_of(node);
-    
-            if (node == root)
-                break;
-    
-            path_m.push_back(node.edge() == adobe::forest_trailing_edge);
-        }
+        clear_inline();
+
+        // the steps are found last first: count them, then fill them in from the top
+
+        size_type               step_count(0);
+        ForestFullorderIterator iter(node);
+
+        while ((iter = --adobe::leading_of(iter)) != root)
+            ++step_count;
 
-        path_m.push_back(true);
+        resize(step_count + 1);
+
+        set(0, true);
+
+        for (size_type n(0); (node = --adobe::leading_of(node)) != root; ++n)
+            set(size_m - 1 - n, node.edge() == adobe::forest_trailing_edge);
     }
 
     template <typename Container>
     explicit bitpath_t(const Container& x) :
-        path_m(boost::begin(x), boost::end(x))
+        size_m(0)
     {
-        clip_zero_fill();
+        clear_inline();
+
+        assign(path_type(boost::begin(x), boost::end(x)));
     }
 
     explicit bitpath_t(const path_type& path) :
-        path_m(path)
+        size_m(0)
     {
-        clip_zero_fill();
-    }
+        clear_inline();
 
-    bitpath_t(const bitpath_t& rhs) :
-        path_m(rhs.path_m)
-    { }
+        assign(path);
+    }
 
     bool empty() const
-    { return path_m.empty(); }
+    { return size_m == 0; }
     size_type size() const
-    { return path_m.size(); }
+    { return size_m; }
 
     bool valid() const
-    { return !empty() && path_m[path_m.size() - 1] == 1; }
+    { return !empty() && get(0); }
 
     bool operator[](size_type n) const
-    { return path_m[n]; }
+    { return get(size_m - 1 - n); }
 
     void push(bool value = bitpath_first_child)
     {
-        path_m.resize(path_m.size() + 1);
-    
-        path_m <<= 1;
-    
-        path_m[0] = value;
+        if (size_m == capacity())
+            grow();
+
+        set(size_m++, value);
     }
 
     bool pop()
     {
-        bool result(path_m[0]);
-
-        path_m >>= 1;
+        bool result(get(--size_m));
 
-        path_m.resize(path_m.size() - 1);
+        set(size_m, false);
 
         return result;
     }
 
     adobe::vector<value_type> portable() const
     {
-        adobe::vector<value_type> result;
+        const size_type bits_per_block(path_type::bits_per_block);
 
-        result.reserve(path_m.size() / path_m.bits_per_block + 1);
+        adobe::vector<value_type> result((size_m + bits_per_block - 1) / bits_per_block,
+                                         value_type(0));
 
-        to_block_range(path_m, std::back_inserter(result));
+        for (size_type n(0); n != size_m; ++n)
+            if ((*this)[n])
+                result[n / bits_per_block] |= value_type(1) << (n % bits_per_block);
 
         return result;
     }
 
     inline friend bool operator==(const bitpath_t& x, const bitpath_t& y)
-    { return x.size() == y.size() && x.path_m == y.path_m; }
+    {
+        return x.size() == y.size() &&
+               std::equal(x.words(), x.words() + x.word_count(), y.words());
+    }
 
     inline friend bool operator<(const bitpath_t& x, const bitpath_t& y)
     {
         bitpath_t::size_type xs(x.size());
         bitpath_t::size_type ys(y.size());
 
-        // dynamic_bitset asserts if xs != ys
+        if (xs != ys)
+            return xs < ys;
+
+        // paths of a size compare as unsigned numbers, the highest bit (the first pushed)
+        // most significant; bits past the end are always zero
+
+        const word_type* xw(x.words());
+        const word_type* yw(y.words());
 
-        return xs < ys || (xs == ys && x.path_m < y.path_m);
+        for (size_type i(0), count(x.word_count()); i != count; ++i)
+        {
+            word_type difference(xw[i] ^ yw[i]);
+
+            if (difference != 0)
+                return (xw[i] & (difference & (~difference + 1))) == 0;
+        }
+
+        return false;
     }
 
     inline friend std::ostream& operator<<(std::ostream& s, const bitpath_t& x)
-    { return s << x.path_m; }
+    {
+        for (size_type n(0); n != x.size_m; ++n)
+            s << (x.get(n) ? '1' : '0');
+
+        return s;
+    }
 
 private:
-    void clip_zero_fill()
+    typedef boost::uint64_t word_type;
+
+    // position n is the n-th bit pushed
+
+    bool get(size_type n) const
+    { return (words()[n / word_size_k] >> (n % word_size_k)) & 1; }
+
+    void set(size_type n, bool value)
+    {
+        word_type  mask(word_type(1) << (n % word_size_k));
+        word_type& word(words()[n / word_size_k]);
+
+        word = value ? (word | mask) : (word & ~mask);
+    }
+
+    word_type* words()
+    { return heap_m.empty() ? inline_m : &heap_m[0]; }
+    const word_type* words() const
+    { return heap_m.empty() ? inline_m : &heap_m[0]; }
+
+    size_type word_count() const
+    { return (size_m + word_size_k - 1) / word_size_k; }
+
+    size_type capacity() const
+    { return heap_m.empty() ? size_type(inline_size_k) : heap_m.size() * word_size_k; }
+
+    void clear_inline()
+    { std::fill(inline_m, inline_m + inline_word_count_k, word_type(0)); }
+
+    void grow()
+    {
+        if (heap_m.empty())
+            heap_m.assign(inline_m, inline_m + inline_word_count_k);
+
+        heap_m.resize(heap_m.size() * 2, word_type(0));
+    }
+
+    void resize(size_type size)
+    {
+        while (capacity() < size)
+            grow();
+
+        size_m = size;
+    }
+
+    void assign(const path_type& path)
     {
         // bitpaths must always start with a 1, so we
         // need to clip the zero-fill from the import.
 
-        size_type orig(path_m.size());
-        size_type size(orig);
-    
-        while (--size)
-            if (path_m[size])
-                break;
+        size_type size(path.size());
+
+        while (size != 0 && !path[size - 1])
+            --size;
+
+        if (size == 0)
+            size = (std::min)(path.size(), size_type(1));
+
+        resize(size);
 
-        if (orig != ++size)
-            path_m.resize(size);
+        for (size_type n(0); n != size; ++n)
+            set(size - 1 - n, path[n]);
     }
 
-    path_type path_m;
+    word_type              inline_m[inline_word_count_k];
+    std::vector<word_type> heap_m;
+    size_type              size_m;
 };
 
 /**************************************************************************************************/
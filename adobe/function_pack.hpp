@@ -11,20 +11,26 @@
 
 #include <adobe/config.hpp>
 
+#include <algorithm>
+#include <exception>
 #include <stdexcept>
 #include <sstream>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 #include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/ref.hpp>
 #include <boost/static_assert.hpp>
 #include <boost/type_traits.hpp>
-#include <boost/utility/enable_if.hpp>
 
 #include <adobe/any_regular.hpp>
 #include <adobe/array.hpp>
 #include <adobe/closed_hash.hpp>
 #include <adobe/dictionary.hpp>
 #include <adobe/empty.hpp>
-#include <adobe/function_traits.hpp>
 #include <adobe/string.hpp>
 #include <adobe/virtual_machine.hpp>
 
@@ -59,6 +65,100 @@ template <typename T>
 struct undecorate<const T&>
 { typedef T type; };
 
+/******************************************************************************/
+/*!
+    The compile-time sequence 0, 1, ... N - 1, used to expand the arguments of a function of
+    arity N.
+*/
+template <std::size_t... I>
+struct index_sequence
+{ };
+
+template <std::size_t N, std::size_t... I>
+struct make_index_sequence :
+    make_index_sequence<N - 1, N - 1, I...>
+{ };
+
+template <std::size_t... I>
+struct make_index_sequence<0, I...>
+{ typedef index_sequence<I...> type; };
+
+/******************************************************************************/
+/*!
+    signature_traits gives the result type, arity and argument types (as a std::tuple) of the
+    functions a function_pack_t accepts: function pointers and references, boost::function, and
+    member function pointers, the first argument of which is a pointer to the object. Unlike
+    function_traits it has no limit on arity.
+*/
+template <typename F>
+struct signature_traits;
+
+template <typename R, typename... A>
+struct signature_traits<R (A...)>
+{
+    enum { arity = sizeof...(A) };
+
+    typedef R                 result_type;
+    typedef std::tuple<A...>  argument_types;
+    typedef boost::false_type is_member_type;
+};
+
+template <typename R, typename... A>
+struct signature_traits<R (*)(A...)> :
+    signature_traits<R (A...)>
+{ };
+
+template <typename R, typename... A>
+struct signature_traits<R (&)(A...)> :
+    signature_traits<R (A...)>
+{ };
+
+template <typename F>
+struct signature_traits<boost::function<F> > :
+    signature_traits<F>
+{ };
+
+template <typename R, typename C, typename... A>
+struct signature_traits<R (C::*)(A...)>
+{
+    enum { arity = sizeof...(A) + 1 };
+
+    typedef R                    result_type;
+    typedef std::tuple<C*, A...> argument_types;
+    typedef boost::true_type     is_member_type;
+};
+
+template <typename R, typename C, typename... A>
+struct signature_traits<R (C::*)(A...) const> :
+    signature_traits<R (C::*)(A...)>
+{ };
+
+/******************************************************************************/
+
+template <typename F>
+inline typename signature_traits<F>::result_type call_function(boost::false_type, const F& f)
+{
+    return f();
+}
+
+template <typename F, typename A1, typename... A>
+inline typename signature_traits<F>::result_type call_function(boost::false_type,
+                                                               const F&   f,
+                                                               A1&&       arg1,
+                                                               A&&...     args)
+{
+    return f(std::forward<A1>(arg1), std::forward<A>(args)...);
+}
+
+template <typename F, typename A1, typename... A>
+inline typename signature_traits<F>::result_type call_function(boost::true_type,
+                                                               const F&   f,
+                                                               A1&&       self,
+                                                               A&&...     args)
+{
+    return (self->*f)(std::forward<A>(args)...);
+}
+
 /******************************************************************************/
 
 inline any_regular_t& find_arg(dictionary_t& named_argument_set, name_t arg_name)
@@ -96,477 +196,428 @@ inline const any_regular_t& find_arg(const array_t& argument_set, std::size_t in
 }
 
 /******************************************************************************/
-
-#define ADOBE_FUNCTION_UNNAMED_ARG(param_index) \
-find_arg(argument_set, (param_index - 1)).cast<typename undecorate<typename traits_type::arg##param_index##_type>::type>()
-
-#define ADOBE_FUNCTION_NAMED_ARG(param_index) \
-find_arg(named_argument_set, name##param_index##_m).cast<typename undecorate<typename traits_type::arg##param_index##_type>::type>()
-
-/******************************************************************************/
-
+/*!
+    The non-throwing counterpart of find_arg for the prepared invocation
+    path: true if the argument is present and holds a T (as any_regular_t
+    stores it, promoted), so that casting it to T cannot throw.
+*/
 template <typename T>
-struct novoid
-{ typedef T type; };
-
-template <>
-struct novoid<void>
-{ typedef adobe::empty_t type; };
-
-/******************************************************************************/
-
-template <typename F>
-inline typename boost::disable_if<boost::is_same<typename F::result_type,
-                                                 void>,
-                                  typename F::result_type>::type
-invoke_novoid(const F& f)
+inline bool holds_argument(const any_regular_t* argument)
 {
-    return f();
+    return argument != 0 && argument->type_info() == type_info<typename promote<T>::type>();
 }
 
-template <typename F>
-inline typename boost::enable_if<boost::is_same<typename F::result_type,
-                                                void>,
-                                 adobe::empty_t>::type
-invoke_novoid(const F& f)
+template <>
+inline bool holds_argument<any_regular_t>(const any_regular_t* argument)
 {
-    f();
-
-    return adobe::empty_t();
+    return argument != 0;
 }
 
 /******************************************************************************/
-
-template <typename F, std::size_t Arity>
-struct function_pack_helper;
+/*!
+    The result of a function, moved into an any_regular_t when the function returns by value.
+*/
+template <typename T>
+inline any_regular_t wrap_regular(T&& x)
+{ return any_regular_t(std::forward<T>(x)); }
 
 /******************************************************************************/
-
-template <typename F>
-struct function_pack_helper<F, 0>
+/*!
+    Storage for the argument pointers of one call through a prepared_function_t: on the stack
+    for functions of up to local_size_k arguments, on the heap beyond that. Every slot starts
+    out null (missing).
+*/
+class slot_set_t : boost::noncopyable
 {
-    typedef function_traits<F>                        traits_type;
-    typedef typename traits_type::result_type         traits_result_type;
-    typedef typename novoid<traits_result_type>::type result_type;
-
-    explicit function_pack_helper(const F& f) :
-        f_m(f)
-    { }
+public:
+    enum { local_size_k = 8 };
 
-    template <typename T>
-    result_type operator()(const T&) const
+    explicit slot_set_t(std::size_t size) :
+        first_m(local_m)
     {
-        return invoke_novoid(boost::bind(f_m));
+        std::fill(local_m, local_m + local_size_k, static_cast<const any_regular_t*>(0));
+
+        if (size > local_size_k)
+        {
+            heap_m.resize(size);
+
+            first_m = &heap_m[0];
+        }
     }
 
+    const any_regular_t*& operator[](std::size_t index)
+    { return first_m[index]; }
+
+    const any_regular_t* const* get() const
+    { return first_m; }
+
 private:
-    typename traits_type::function_type f_m;
+    const any_regular_t*              local_m[local_size_k];
+    std::vector<const any_regular_t*> heap_m;
+    const any_regular_t**             first_m;
 };
 
 /******************************************************************************/
-
+/*!
+    function_pack_helper binds a function of any arity to the argument names it was registered
+    with (none, for a function registered with unnamed arguments). However it is invoked, the
+    arguments are first gathered into an array of pointers in argument order, and the function
+    is then called with each argument cast straight out of its any_regular_t; the result is
+    moved into the any_regular_t returned (empty_t for a function returning void).
+
+    The function_pack_helper itself is what function_pack_t stores in each of its
+    boost::function objects, so that a call through the pack costs a single indirect call.
+*/
 template <typename F>
-struct function_pack_helper<F, 1>
+class function_pack_helper
 {
-    typedef function_traits<F>                        traits_type;
-    typedef typename traits_type::result_type         traits_result_type;
-    typedef typename novoid<traits_result_type>::type result_type;
+    typedef signature_traits<F>                                          traits_type;
+    typedef typename traits_type::result_type                            traits_result_type;
+    typedef typename traits_type::argument_types                         argument_types;
+    typedef typename make_index_sequence<traits_type::arity>::type       index_type;
 
-    explicit function_pack_helper(const F& f,
-                                  name_t   arg1_name = name_t()) :
+    template <std::size_t I>
+    struct argument
+    {
+        typedef typename undecorate<typename std::tuple_element<I, argument_types>::type>::type type;
+    };
+
+public:
+    typedef any_regular_t result_type;
+
+    enum { arity = traits_type::arity };
+
+    explicit function_pack_helper(const F& f) :
+        f_m(f)
+    { }
+
+    function_pack_helper(const F& f, const std::vector<name_t>& name_set) :
         f_m(f),
-        name1_m(arg1_name)
+        name_set_m(name_set)
     { }
 
-    result_type operator()(const array_t& argument_set) const
+    any_regular_t operator()(const array_t& argument_set) const
     {
-        return invoke_novoid(boost::bind(f_m, ADOBE_FUNCTION_UNNAMED_ARG(1)));
+        const any_regular_t* slot_set[arity + 1] = { 0 };
+
+        for (std::size_t i(0); i != arity; ++i)
+            slot_set[i] = &find_arg(argument_set, i);
+
+        return invoke(slot_set, index_type(), boost::is_void<traits_result_type>());
     }
 
-    result_type operator()(const dictionary_t& named_argument_set) const
+    any_regular_t operator()(const dictionary_t& named_argument_set) const
     {
-        return invoke_novoid(boost::bind(f_m, ADOBE_FUNCTION_NAMED_ARG(1)));
-    }
+        const any_regular_t* slot_set[arity + 1] = { 0 };
 
-private:
-    typename traits_type::function_type f_m;
-    name_t name1_m;
-};
+        for (std::size_t i(0); i != arity; ++i)
+            slot_set[i] = &find_arg(named_argument_set, name_set_m[i]);
 
-/******************************************************************************/
+        return invoke(slot_set, index_type(), boost::is_void<traits_result_type>());
+    }
 
-template <typename F>
-struct function_pack_helper<F, 2>
-{
-    typedef function_traits<F>                        traits_type;
-    typedef typename traits_type::result_type         traits_result_type;
-    typedef typename novoid<traits_result_type>::type result_type;
+    /*
+        The non-throwing form: returns the index of the first argument missing (null) or not
+        holding the type the function expects, or arity if the function was called.
+    */
+    std::size_t operator()(const any_regular_t* const* slot_set, any_regular_t& result) const
+    {
+        std::size_t mismatch(find_mismatch(slot_set, index_type()));
 
-    explicit function_pack_helper(const F& f,
-                                  name_t   arg1_name = name_t(), name_t arg2_name = name_t()) :
-        f_m(f),
-        name1_m(arg1_name), name2_m(arg2_name)
-    { }
+        if (mismatch == arity)
+            result = invoke(slot_set, index_type(), boost::is_void<traits_result_type>());
 
-    result_type operator()(const array_t& argument_set) const
-    {
-        return invoke_novoid(boost::bind(f_m,
-                                         ADOBE_FUNCTION_UNNAMED_ARG(1), ADOBE_FUNCTION_UNNAMED_ARG(2)));
+        return mismatch;
     }
 
-    result_type operator()(const dictionary_t& named_argument_set) const
-    {
-        return invoke_novoid(boost::bind(f_m,
-                                         ADOBE_FUNCTION_NAMED_ARG(1), ADOBE_FUNCTION_NAMED_ARG(2)));
-    }
+    const std::vector<name_t>& name_set() const
+    { return name_set_m; }
 
 private:
-    typename traits_type::function_type f_m;
-    name_t name1_m;
-    name_t name2_m;
-};
+    template <std::size_t... I>
+    static std::size_t find_mismatch(const any_regular_t* const* slot_set, index_sequence<I...>)
+    {
+        const bool match_set[] = { true, holds_argument<typename argument<I>::type>(slot_set[I])... };
 
-/******************************************************************************/
+        std::size_t result(0);
 
-template <typename F>
-struct function_pack_helper<F, 3>
-{
-    typedef function_traits<F>                        traits_type;
-    typedef typename traits_type::result_type         traits_result_type;
-    typedef typename novoid<traits_result_type>::type result_type;
+        while (result != sizeof...(I) && match_set[result + 1])
+            ++result;
 
-    explicit function_pack_helper(const F& f,
-                                  name_t   arg1_name = name_t(), name_t arg2_name = name_t(),
-                                  name_t   arg3_name = name_t()) :
-        f_m(f),
-        name1_m(arg1_name), name2_m(arg2_name), name3_m(arg3_name)
-    { }
+        return result;
+    }
 
-    result_type operator()(const array_t& argument_set) const
+    template <std::size_t... I>
+    any_regular_t invoke(const any_regular_t* const* slot_set,
+                         index_sequence<I...>,
+                         boost::false_type) const
     {
-        return invoke_novoid(boost::bind(f_m,
-                                         ADOBE_FUNCTION_UNNAMED_ARG(1), ADOBE_FUNCTION_UNNAMED_ARG(2),
-                                         ADOBE_FUNCTION_UNNAMED_ARG(3)));
+        return wrap_regular(call_function(typename traits_type::is_member_type(), f_m,
+                                          slot_set[I]->template cast<typename argument<I>::type>()...));
     }
 
-    result_type operator()(const dictionary_t& named_argument_set) const
+    template <std::size_t... I>
+    any_regular_t invoke(const any_regular_t* const* slot_set,
+                         index_sequence<I...>,
+                         boost::true_type) const
     {
-        return invoke_novoid(boost::bind(f_m,
-                                         ADOBE_FUNCTION_NAMED_ARG(1), ADOBE_FUNCTION_NAMED_ARG(2),
-                                         ADOBE_FUNCTION_NAMED_ARG(3)));
+        call_function(typename traits_type::is_member_type(), f_m,
+                      slot_set[I]->template cast<typename argument<I>::type>()...);
+
+        return any_regular_t(empty_t());
     }
 
-private:
-    typename traits_type::function_type f_m;
-    name_t name1_m;
-    name_t name2_m;
-    name_t name3_m;
+    typename boost::decay<F>::type f_m;
+    std::vector<name_t>            name_set_m;
 };
 
 /******************************************************************************/
 
-template <typename F>
-struct function_pack_helper<F, 4>
+} // namespace implementation
+// ADOBE_NO_DOCUMENTATION
+#endif
+/******************************************************************************/
+
+/*!
+    Binds a function to the names of its arguments, one name per argument. The arity of the
+    function is asserted to match the number of names at compile time.
+*/
+template <typename F, typename... N>
+inline implementation::function_pack_helper<F>
+named_bind(const F& f, N... arg_names)
 {
-    typedef function_traits<F>                        traits_type;
-    typedef typename traits_type::result_type         traits_result_type;
-    typedef typename novoid<traits_result_type>::type result_type;
+    BOOST_STATIC_ASSERT((implementation::signature_traits<F>::arity == sizeof...(N)));
 
-    explicit function_pack_helper(const F& f,
-                                  name_t   arg1_name = name_t(), name_t arg2_name = name_t(),
-                                  name_t   arg3_name = name_t(), name_t arg4_name = name_t()) :
-        f_m(f),
-        name1_m(arg1_name), name2_m(arg2_name), name3_m(arg3_name), name4_m(arg4_name)
-    { }
+    const name_t name_set[] = { name_t(), arg_names... };
 
-    result_type operator()(const array_t& argument_set) const
-    {
-        return invoke_novoid(boost::bind(f_m,
-                                         ADOBE_FUNCTION_UNNAMED_ARG(1), ADOBE_FUNCTION_UNNAMED_ARG(2),
-                                         ADOBE_FUNCTION_UNNAMED_ARG(3), ADOBE_FUNCTION_UNNAMED_ARG(4)));
-    }
+    return implementation::function_pack_helper<F>(f,
+                                                   std::vector<name_t>(name_set + 1,
+                                                                       name_set + 1 + sizeof...(N)));
+}
 
-    result_type operator()(const dictionary_t& named_argument_set) const
-    {
-        return invoke_novoid(boost::bind(f_m,
-                                         ADOBE_FUNCTION_NAMED_ARG(1), ADOBE_FUNCTION_NAMED_ARG(2),
-                                         ADOBE_FUNCTION_NAMED_ARG(3), ADOBE_FUNCTION_NAMED_ARG(4)));
-    }
+/******************************************************************************/
+/*!
+    \brief A function of a function_pack_t with its argument names resolved to slots.
+    \ingroup apl_libraries
 
-private:
-    typename traits_type::function_type f_m;
-    name_t name1_m;
-    name_t name2_m;
-    name_t name3_m;
-    name_t name4_m;
-};
+    Obtained from function_pack_t::prepare(). The argument names the function was registered with
+    are resolved once, to slot positions (the order in which they were given); slot() returns the
+    position of an argument. The function can then be invoked with its arguments in slot order,
+    as an array_t or an array of pointers, without any lookup by name, or with a dictionary_t, in
+    which case each argument is found once per call and the function name not at all. (A function
+    registered with unnamed arguments has no names; its slots are its argument positions.)
 
-/******************************************************************************/
+    Invocation does not throw over the arguments: if one is missing or does not hold the type the
+    function expects, the function is not called and false is returned (invoke() returns the slot
+    of that argument instead). Exceptions thrown by the function itself are not caught.
 
-template <typename F>
-struct function_pack_helper<F, 5>
+    A prepared_function_t is a value; it stays valid whatever is later registered into (or
+    cleared from) the pack it came from.
+*/
+class prepared_function_t
 {
-    typedef function_traits<F>                        traits_type;
-    typedef typename traits_type::result_type         traits_result_type;
-    typedef typename novoid<traits_result_type>::type result_type;
-
-    explicit function_pack_helper(const F& f,
-                                  name_t   arg1_name = name_t(), name_t arg2_name = name_t(),
-                                  name_t   arg3_name = name_t(), name_t arg4_name = name_t(),
-                                  name_t   arg5_name = name_t()) :
-        f_m(f),
-        name1_m(arg1_name), name2_m(arg2_name), name3_m(arg3_name), name4_m(arg4_name),
-        name5_m(arg5_name)
+public:
+    typedef boost::function<std::size_t (const any_regular_t* const*, any_regular_t&)> slot_function_t;
+
+    prepared_function_t() :
+        arity_m(0)
     { }
 
-    result_type operator()(const array_t& argument_set) const
-    {
-        return invoke_novoid(boost::bind(f_m,
-                                         ADOBE_FUNCTION_UNNAMED_ARG(1), ADOBE_FUNCTION_UNNAMED_ARG(2),
-                                         ADOBE_FUNCTION_UNNAMED_ARG(3), ADOBE_FUNCTION_UNNAMED_ARG(4),
-                                         ADOBE_FUNCTION_UNNAMED_ARG(5)));
-    }
+    prepared_function_t(const std::vector<name_t>& name_set, const slot_function_t& f) :
+        name_set_m(name_set),
+        arity_m(name_set.size()),
+        f_m(f)
+    { }
+
+    prepared_function_t(std::size_t arity, const slot_function_t& f) :
+        arity_m(arity),
+        f_m(f)
+    { }
+
+    /// true if no function was found to prepare
+    bool empty() const
+    { return f_m.empty(); }
+
+    std::size_t arity() const
+    { return arity_m; }
 
-    result_type operator()(const dictionary_t& named_argument_set) const
+    /// the argument names, in slot order (none for a function with unnamed arguments)
+    const std::vector<name_t>& name_set() const
+    { return name_set_m; }
+
+    /// the slot of the argument named, or arity() if there is none
+    std::size_t slot(name_t argument) const
     {
-        return invoke_novoid(boost::bind(f_m,
-                                         ADOBE_FUNCTION_NAMED_ARG(1), ADOBE_FUNCTION_NAMED_ARG(2),
-                                         ADOBE_FUNCTION_NAMED_ARG(3), ADOBE_FUNCTION_NAMED_ARG(4),
-                                         ADOBE_FUNCTION_NAMED_ARG(5)));
-    }
+        std::size_t result(0);
 
-private:
-    typename traits_type::function_type f_m;
-    name_t name1_m;
-    name_t name2_m;
-    name_t name3_m;
-    name_t name4_m;
-    name_t name5_m;
-};
+        while (result != name_set_m.size() && name_set_m[result] != argument)
+            ++result;
 
-/******************************************************************************/
+        return name_set_m.empty() ? arity() : result;
+    }
 
-template <typename F>
-struct function_pack_helper<F, 6>
-{
-    typedef function_traits<F>                        traits_type;
-    typedef typename traits_type::result_type         traits_result_type;
-    typedef typename novoid<traits_result_type>::type result_type;
-
-    explicit function_pack_helper(const F& f,
-                                  name_t   arg1_name = name_t(), name_t arg2_name = name_t(),
-                                  name_t   arg3_name = name_t(), name_t arg4_name = name_t(),
-                                  name_t   arg5_name = name_t(), name_t arg6_name = name_t()) :
-        f_m(f),
-        name1_m(arg1_name), name2_m(arg2_name), name3_m(arg3_name), name4_m(arg4_name),
-        name5_m(arg5_name), name6_m(arg6_name)
-    { }
+    /*!
+        Invokes the function with slot_set[i] pointing to the argument for slot i (or null if
+        the argument is missing.) Returns the slot of the first argument missing or of the wrong
+        type, or arity() if the function was called.
 
-    result_type operator()(const array_t& argument_set) const
+        \pre !empty()
+    */
+    std::size_t invoke(const any_regular_t* const* slot_set, any_regular_t& result) const
     {
-        return invoke_novoid(boost::bind(f_m,
-                                         ADOBE_FUNCTION_UNNAMED_ARG(1), ADOBE_FUNCTION_UNNAMED_ARG(2),
-                                         ADOBE_FUNCTION_UNNAMED_ARG(3), ADOBE_FUNCTION_UNNAMED_ARG(4),
-                                         ADOBE_FUNCTION_UNNAMED_ARG(5), ADOBE_FUNCTION_UNNAMED_ARG(6)));
+        return f_m(slot_set, result);
     }
 
-    result_type operator()(const dictionary_t& named_argument_set) const
+    /// Invokes the function with its arguments in slot order.
+    std::size_t invoke(const array_t& argument_set, any_regular_t& result) const
     {
-        return invoke_novoid(boost::bind(f_m,
-                                         ADOBE_FUNCTION_NAMED_ARG(1), ADOBE_FUNCTION_NAMED_ARG(2),
-                                         ADOBE_FUNCTION_NAMED_ARG(3), ADOBE_FUNCTION_NAMED_ARG(4),
-                                         ADOBE_FUNCTION_NAMED_ARG(5), ADOBE_FUNCTION_NAMED_ARG(6)));
+        implementation::slot_set_t slot_set(arity());
+
+        for (std::size_t i(0), count(std::min(arity(), argument_set.size())); i != count; ++i)
+            slot_set[i] = &argument_set[i];
+
+        return invoke(slot_set.get(), result);
     }
 
-private:
-    typename traits_type::function_type f_m;
-    name_t name1_m;
-    name_t name2_m;
-    name_t name3_m;
-    name_t name4_m;
-    name_t name5_m;
-    name_t name6_m;
-};
+    /// Invokes the function with its arguments found by name.
+    std::size_t invoke(const dictionary_t& named_argument_set, any_regular_t& result) const
+    {
+        implementation::slot_set_t slot_set(arity());
 
-/******************************************************************************/
+        for (std::size_t i(0); i != name_set_m.size(); ++i)
+        {
+            dictionary_t::const_iterator found(named_argument_set.find(name_set_m[i]));
 
-template <typename F>
-struct function_pack_helper<F, 7>
-{
-    typedef function_traits<F>                        traits_type;
-    typedef typename traits_type::result_type         traits_result_type;
-    typedef typename novoid<traits_result_type>::type result_type;
-
-    explicit function_pack_helper(const F& f,
-                                  name_t   arg1_name = name_t(), name_t arg2_name = name_t(),
-                                  name_t   arg3_name = name_t(), name_t arg4_name = name_t(),
-                                  name_t   arg5_name = name_t(), name_t arg6_name = name_t(),
-                                  name_t   arg7_name = name_t()) :
-        f_m(f),
-        name1_m(arg1_name), name2_m(arg2_name), name3_m(arg3_name), name4_m(arg4_name),
-        name5_m(arg5_name), name6_m(arg6_name), name7_m(arg7_name)
-    { }
+            if (found != named_argument_set.end())
+                slot_set[i] = &found->second;
+        }
 
-    result_type operator()(const array_t& argument_set) const
+        return invoke(slot_set.get(), result);
+    }
+
+    /// true if the function was called
+    bool operator()(const any_regular_t* const* slot_set, any_regular_t& result) const
+    {
+        return !empty() && invoke(slot_set, result) == arity();
+    }
+
+    /// true if the function was called
+    bool operator()(const array_t& argument_set, any_regular_t& result) const
     {
-        return invoke_novoid(boost::bind(f_m,
-                                         ADOBE_FUNCTION_UNNAMED_ARG(1), ADOBE_FUNCTION_UNNAMED_ARG(2),
-                                         ADOBE_FUNCTION_UNNAMED_ARG(3), ADOBE_FUNCTION_UNNAMED_ARG(4),
-                                         ADOBE_FUNCTION_UNNAMED_ARG(5), ADOBE_FUNCTION_UNNAMED_ARG(6),
-                                         ADOBE_FUNCTION_UNNAMED_ARG(7)));
+        return !empty() && invoke(argument_set, result) == arity();
     }
 
-    result_type operator()(const dictionary_t& named_argument_set) const
+    /// true if the function was called
+    bool operator()(const dictionary_t& named_argument_set, any_regular_t& result) const
     {
-        return invoke_novoid(boost::bind(f_m,
-                                         ADOBE_FUNCTION_NAMED_ARG(1), ADOBE_FUNCTION_NAMED_ARG(2),
-                                         ADOBE_FUNCTION_NAMED_ARG(3), ADOBE_FUNCTION_NAMED_ARG(4),
-                                         ADOBE_FUNCTION_NAMED_ARG(5), ADOBE_FUNCTION_NAMED_ARG(6),
-                                         ADOBE_FUNCTION_NAMED_ARG(7)));
+        return !empty() && invoke(named_argument_set, result) == arity();
     }
 
 private:
-    typename traits_type::function_type f_m;
-    name_t name1_m;
-    name_t name2_m;
-    name_t name3_m;
-    name_t name4_m;
-    name_t name5_m;
-    name_t name6_m;
-    name_t name7_m;
+    std::vector<name_t> name_set_m;
+    std::size_t         arity_m;
+    slot_function_t     f_m;
 };
 
 /******************************************************************************/
-
-#undef ADOBE_FUNCTION_UNNAMED_ARG
-#undef ADOBE_FUNCTION_NAMED_ARG
+/*!
+    \brief Why a function_pack_t::try_invoke() call did not call its function.
+    \ingroup apl_libraries
+*/
+enum function_pack_status_t
+{
+    function_pack_success = 0,
+    function_pack_no_function_name,
+    function_pack_function_not_found,
+    function_pack_argument_missing,
+    function_pack_argument_mistyped
+};
 
 /******************************************************************************/
+/*!
+    \brief The outcome of function_pack_t::try_invoke(): the value returned by the function, or
+    why it was not called.
+    \ingroup apl_libraries
 
-template <typename T>
-any_regular_t wrap_regular(const T& x)
-{ return any_regular_t(x); }
+    Nothing is formatted when a call fails; message() builds the text the throwing interface of
+    function_pack_t would have thrown, on demand.
+*/
+struct try_invoke_result_t
+{
+    try_invoke_result_t() :
+        status_m(function_pack_success),
+        named_m(false),
+        argument_index_m(0)
+    { }
 
-template <>
-inline any_regular_t wrap_regular<any_regular_t>(const any_regular_t& x)
-{ return x; }
+    /// true if the function was called
+    bool succeeded() const
+    { return status_m == function_pack_success; }
 
-/******************************************************************************/
+    std::string message() const
+    {
+        const char* lookup(named_m ? "find_named" : "find_unnamed");
 
-} // namespace implementation
-// ADOBE_NO_DOCUMENTATION
-#endif
-/******************************************************************************/
+        switch (status_m)
+        {
+            case function_pack_success:
+                return std::string();
 
-template <typename F>
-inline implementation::function_pack_helper<F, 0>
-named_bind(const F& f)
-{
-    BOOST_STATIC_ASSERT((function_traits<F>::arity == 0));
+            case function_pack_no_function_name:
+                return make_string(lookup, ": no function name specified");
 
-    return implementation::function_pack_helper<F, 0>(f);
-}
+            case function_pack_function_not_found:
+                return make_string(lookup, ": function '", function_m.c_str()) + "' not found";
 
-template <typename F>
-inline implementation::function_pack_helper<F, 1>
-named_bind(const F& f,
-           name_t arg1_name)
-{
-    BOOST_STATIC_ASSERT((function_traits<F>::arity == 1));
+            default:
+                break;
+        }
 
-    return implementation::function_pack_helper<F, 1>(f,
-                                                      arg1_name);
-}
+        const char* problem(status_m == function_pack_argument_missing ? "No value" : "Wrong type");
 
-template <typename F>
-inline implementation::function_pack_helper<F, 2>
-named_bind(const F& f,
-           name_t arg1_name, name_t arg2_name)
-{
-    BOOST_STATIC_ASSERT((function_traits<F>::arity == 2));
+        if (named_m)
+            return make_string(problem, " for named argument '", argument_name_m.c_str()) + "'";
 
-    return implementation::function_pack_helper<F, 2>(f,
-                                                      arg1_name,
-                                                      arg2_name);
-}
+        std::stringstream result;
 
-template <typename F>
-inline implementation::function_pack_helper<F, 3>
-named_bind(const F& f,
-           name_t arg1_name, name_t arg2_name, name_t arg3_name)
-{
-    BOOST_STATIC_ASSERT((function_traits<F>::arity == 3));
+        result << problem << " for unnamed argument " << (argument_index_m + 1);
 
-    return implementation::function_pack_helper<F, 3>(f,
-                                                      arg1_name,
-                                                      arg2_name,
-                                                      arg3_name);
-}
+        return result.str();
+    }
 
-template <typename F>
-inline implementation::function_pack_helper<F, 4>
-named_bind(const F& f,
-           name_t arg1_name, name_t arg2_name, name_t arg3_name, name_t arg4_name)
-{
-    BOOST_STATIC_ASSERT((function_traits<F>::arity == 4));
+    any_regular_t          value_m;
+    function_pack_status_t status_m;
+    name_t                 function_m;
+    bool                   named_m;          ///< whether the arguments were named or unnamed
+    name_t                 argument_name_m;  ///< the named argument at fault
+    std::size_t            argument_index_m; ///< the argument at fault, counted from zero
+};
 
-    return implementation::function_pack_helper<F, 4>(f,
-                                                      arg1_name,
-                                                      arg2_name,
-                                                      arg3_name,
-                                                      arg4_name);
-}
+/******************************************************************************/
+/*!
+    \brief The outcome of one command of a batch run with function_pack_t::invoke_batch().
+    \ingroup apl_libraries
 
-template <typename F>
-inline implementation::function_pack_helper<F, 5>
-named_bind(const F& f,
-           name_t arg1_name, name_t arg2_name, name_t arg3_name, name_t arg4_name,
-           name_t arg5_name)
+    Either the value returned by the function (empty_t for a function returning void), or the
+    exception that stopped the command: the function not being found, a missing or mistyped
+    argument, or anything thrown by the function itself.
+*/
+struct function_result_t
 {
-    BOOST_STATIC_ASSERT((function_traits<F>::arity == 5));
-
-    return implementation::function_pack_helper<F, 5>(f,
-                                                      arg1_name,
-                                                      arg2_name,
-                                                      arg3_name,
-                                                      arg4_name,
-                                                      arg5_name);
-}
+    /// true if the function was called and returned normally
+    bool succeeded() const
+    { return !error_m; }
 
-template <typename F>
-inline implementation::function_pack_helper<F, 6>
-named_bind(const F& f,
-           name_t arg1_name, name_t arg2_name, name_t arg3_name, name_t arg4_name,
-           name_t arg5_name, name_t arg6_name)
-{
-    BOOST_STATIC_ASSERT((function_traits<F>::arity == 6));
-
-    return implementation::function_pack_helper<F, 6>(f,
-                                                      arg1_name,
-                                                      arg2_name,
-                                                      arg3_name,
-                                                      arg4_name,
-                                                      arg5_name,
-                                                      arg6_name);
-}
+    /// throws the exception that stopped the command, if any
+    void rethrow() const
+    {
+        if (error_m)
+            std::rethrow_exception(error_m);
+    }
 
-template <typename F>
-inline implementation::function_pack_helper<F, 7>
-named_bind(const F& f,
-           name_t arg1_name, name_t arg2_name, name_t arg3_name, name_t arg4_name,
-           name_t arg5_name, name_t arg6_name, name_t arg7_name)
-{
-    BOOST_STATIC_ASSERT((function_traits<F>::arity == 7));
-
-    return implementation::function_pack_helper<F, 7>(f,
-                                                      arg1_name,
-                                                      arg2_name,
-                                                      arg3_name,
-                                                      arg4_name,
-                                                      arg5_name,
-                                                      arg6_name,
-                                                      arg7_name);
-}
+    any_regular_t      value_m;
+    std::exception_ptr error_m;
+};
 
 /******************************************************************************/
 /*!
@@ -610,6 +661,10 @@ private:
 #endif
 
 public:
+    function_pack_t() :
+        generation_m(0)
+    { }
+
     /*!
         This routine is used to register unnamed functions of any arity to the function pack.
     */
@@ -619,8 +674,7 @@ public:
         // We can't check arity here because unnamed argument functions
         // pass through this, which could be of any arity.
 
-        attach_unnamed(name,
-                       implementation::function_pack_helper<F, function_traits<F>::arity>(f));
+        attach_unnamed(name, implementation::function_pack_helper<F>(f));
     }
 
     /*!
@@ -633,106 +687,17 @@ public:
     }
 
     /*!
-        This routine is used to register named functions of arity 1 to the function pack.
-
-        \note
-        The arity of the original function is asserted to be 1 at compile time.
-    */
-    template <typename F>
-    void register_function(name_t name, const F& f, name_t arg1_name)
-    {
-        attach_named(name,
-                     named_bind(f, arg1_name));
-    }
-
-    /*!
-        This routine is used to register named functions of arity 2 to the function pack.
-
-        \note
-        The arity of the original function is asserted to be 2 at compile time.
-    */
-    template <typename F>
-    void register_function(name_t name, const F& f, name_t arg1_name, name_t arg2_name)
-    {
-        attach_named(name, named_bind(f,
-                                      arg1_name, arg2_name));
-    }
-
-    /*!
-        This routine is used to register named functions of arity 3 to the function pack.
-
-        \note
-        The arity of the original function is asserted to be 3 at compile time.
-    */
-    template <typename F>
-    void register_function(name_t name, const F& f, name_t arg1_name, name_t arg2_name, name_t arg3_name)
-    {
-        attach_named(name, named_bind(f,
-                                      arg1_name, arg2_name, arg3_name));
-    }
-
-    /*!
-        This routine is used to register named functions of arity 4 to the function pack.
-
-        \note
-        The arity of the original function is asserted to be 4 at compile time.
-    */
-    template <typename F>
-    void register_function(name_t name, const F& f,
-                           name_t arg1_name, name_t arg2_name, name_t arg3_name, name_t arg4_name)
-    {
-        attach_named(name, named_bind(f,
-                                      arg1_name, arg2_name, arg3_name, arg4_name));
-    }
-
-    /*!
-        This routine is used to register named functions of arity 5 to the function pack.
-
-        \note
-        The arity of the original function is asserted to be 5 at compile time.
-    */
-    template <typename F>
-    void register_function(name_t name, const F& f,
-                           name_t arg1_name, name_t arg2_name, name_t arg3_name, name_t arg4_name,
-                           name_t arg5_name)
-    {
-        BOOST_STATIC_ASSERT((function_traits<F>::arity == 5));
-
-        attach_named(name, named_bind(f,
-                                      arg1_name, arg2_name, arg3_name, arg4_name,
-                                      arg5_name));
-    }
-
-    /*!
-        This routine is used to register named functions of arity 6 to the function pack.
-
-        \note
-        The arity of the original function is asserted to be 6 at compile time.
-    */
-    template <typename F>
-    void register_function(name_t name, const F& f,
-                           name_t arg1_name, name_t arg2_name, name_t arg3_name, name_t arg4_name,
-                           name_t arg5_name, name_t arg6_name)
-    {
-        attach_named(name, named_bind(f,
-                                      arg1_name, arg2_name, arg3_name, arg4_name,
-                                      arg5_name, arg6_name));
-    }
-
-    /*!
-        This routine is used to register named functions of arity 7 to the function pack.
+        This routine is used to register named functions of any arity (of one or more) to the
+        function pack, with one argument name per argument of the function.
 
         \note
-        The arity of the original function is asserted to be 7 at compile time.
+        The arity of the original function is asserted to match the number of names at compile
+        time.
     */
-    template <typename F>
-    void register_function(name_t name, const F& f,
-                           name_t arg1_name, name_t arg2_name, name_t arg3_name, name_t arg4_name,
-                           name_t arg5_name, name_t arg6_name, name_t arg7_name)
+    template <typename F, typename... N>
+    void register_function(name_t name, const F& f, name_t arg1_name, N... arg_names)
     {
-        attach_named(name, named_bind(f,
-                                      arg1_name, arg2_name, arg3_name, arg4_name,
-                                      arg5_name, arg6_name, arg7_name));
+        attach_named(name, named_bind(f, arg1_name, arg_names...));
     }
 
     /*!
@@ -740,7 +705,7 @@ public:
     */
     any_regular_t operator()(name_t function, const array_t& argument_set) const
     {
-        return find_unnamed(function)->second(argument_set);
+        return find_unnamed(function)(argument_set);
     }
 
     /*!
@@ -748,7 +713,7 @@ public:
     */
     any_regular_t operator()(name_t function, const dictionary_t& named_argument_set) const
     {
-        return find_named(function)->second(named_argument_set);
+        return find_named(function)(named_argument_set);
     }
 
     /*!
@@ -756,7 +721,7 @@ public:
     */
     any_regular_t operator()(name_t function, array_t& argument_set) const
     {
-        return find_unnamed(function)->second(argument_set);
+        return find_unnamed(function)(argument_set);
     }
 
     /*!
@@ -764,7 +729,7 @@ public:
     */
     any_regular_t operator()(name_t function, dictionary_t& named_argument_set) const
     {
-        return find_named(function)->second(named_argument_set);
+        return find_named(function)(named_argument_set);
     }
 
     /*!
@@ -821,81 +786,451 @@ public:
         return (*this)(function, named_argument_set);
     }
 
+    /*!
+        Invokes each command in [first, last), in order, and writes one function_result_t per
+        command to result; returns the end of the results written. A command is an array_t or a
+        dictionary_t naming its function as in the single-command operator() overloads above,
+        or an any_regular_t holding either.
+
+        Each function is looked up once per batch, on its first command; the commands after it
+        reuse the lookup. A command that fails records its exception in its result and the batch
+        carries on with the next command, so one bad command does not cost the rest.
+
+        \note
+        Functions must not be registered into (or cleared from) the pack while a batch is running
+        through it.
+    */
+    template <typename I, // I models InputIterator; value_type is array_t, dictionary_t or any_regular_t
+              typename O> // O models OutputIterator; accepts function_result_t
+    O invoke_batch(I first, I last, O result) const
+    {
+        batch_lookup_t lookup;
+
+        for (; first != last; ++first, ++result)
+            *result = invoke_command(*first, lookup);
+
+        return result;
+    }
+
+    /*!
+        The non-throwing counterpart of the operator() overloads above: the function is called
+        only if it is found and its arguments are all present and of the types it expects. If
+        not, the result says why and no exception is thrown or message formatted. Exceptions
+        thrown by the function itself are not caught, nor are those thrown over the arguments by
+        a function registered with register_unnamed or register_named, which takes its argument
+        set as it is.
+    */
+    try_invoke_result_t try_invoke(name_t function, const array_t& argument_set) const
+    {
+        return try_invoke(function, argument_set, prepared_unnamed_map_m, array_function_map_m);
+    }
+
+    try_invoke_result_t try_invoke(name_t function, const dictionary_t& named_argument_set) const
+    {
+        return try_invoke(function, named_argument_set, prepared_function_map_m,
+                          dictionary_function_map_m);
+    }
+
+    /// As try_invoke(name_t, const array_t&), with the name of the function at the 0th index
+    try_invoke_result_t try_invoke(const array_t& argument_set) const
+    {
+        adobe::name_t function;
+
+        if (!argument_set.empty())
+            argument_set[0].cast<adobe::name_t>(function);
+
+        return try_invoke(function, argument_set);
+    }
+
+    /// As try_invoke(name_t, const dictionary_t&), with the name of the function under <code>command</code>
+    try_invoke_result_t try_invoke(const dictionary_t& named_argument_set) const
+    {
+        adobe::name_t function;
+
+        get_value(named_argument_set, "command"_name, function);
+
+        return try_invoke(function, named_argument_set);
+    }
+
+    /*!
+        Returns the function registered under the name passed with named arguments (by one of the
+        register_function overloads taking argument names, or register_named0_function) with its
+        argument names resolved to slots, or an empty prepared_function_t if there is none.
+        Functions registered with register_named cannot be prepared.
+    */
+    prepared_function_t prepare(name_t function) const
+    {
+        prepared_function_map_t::const_iterator found(prepared_function_map_m.find(function));
+
+        return found == prepared_function_map_m.end() ? prepared_function_t() : found->second;
+    }
+
     void register_unnamed(name_t name, const array_function_t& f)
     {
         array_function_map_m.insert(array_function_map_t::value_type(name, f));
+
+        ++generation_m;
     }
 
     void register_named(name_t name, const dictionary_function_t& f)
     {
         dictionary_function_map_m.insert(dictionary_function_map_t::value_type(name, f));
+
+        ++generation_m;
     }
 
 	void clear()
 	{
 		dictionary_function_map_m.clear();
 		array_function_map_m.clear();
+		prepared_function_map_m.clear();
+		prepared_unnamed_map_m.clear();
+
+		++generation_m;
 	}
 
+    /*!
+        The registration generation of the pack: it changes each time a function is registered
+        into the pack or the pack is cleared. Whoever keeps hold of a function found in the pack
+        (as cached_lookup_t does) must look it up again once the generation has changed.
+    */
+    std::size_t generation() const
+    { return generation_m; }
+
+    /*!
+        \brief The array- and dictionary-based function lookup attach() installs into a
+        virtual_machine_t.
+
+        An expression a sheet re-evaluates calls the same few functions every time. The lookup
+        keeps the functions it has found in a small cache, direct-mapped on the function name, so
+        that a repeated call goes straight to the function (whose argument names were resolved
+        when it was registered) without searching the pack. Every entry is tagged with the pack's
+        generation() at the time it was found and is looked up again once that changes.
+
+        \note
+        The virtual machine does not pass the position of the call in the expression to its
+        function lookup, so calls to the same function from different places in an expression
+        share one cache entry.
+    */
+    class cached_lookup_t
+    {
+    public:
+        enum { cache_size_k = 16 };
+
+        explicit cached_lookup_t(const function_pack_t& pack) :
+            pack_m(&pack)
+        { }
+
+        any_regular_t operator()(name_t function, const array_t& argument_set) const
+        {
+            entry_t<array_function_t>& entry(find_entry(array_cache_m, function));
+
+            if (!current(entry, function))
+                store(entry, function, pack_m->find_unnamed(function));
+
+            return (*entry.function_m)(argument_set);
+        }
+
+        any_regular_t operator()(name_t function, const dictionary_t& named_argument_set) const
+        {
+            entry_t<dictionary_function_t>& entry(find_entry(dictionary_cache_m, function));
+
+            if (!current(entry, function))
+                store(entry, function, pack_m->find_named(function));
+
+            return (*entry.function_m)(named_argument_set);
+        }
+
+    private:
+        template <typename F>
+        struct entry_t
+        {
+            entry_t() :
+                function_m(0),
+                generation_m(0)
+            { }
+
+            name_t      name_m;
+            const F*    function_m;
+            std::size_t generation_m;
+        };
+
+        template <typename F>
+        static entry_t<F>& find_entry(entry_t<F>* cache, name_t function)
+        { return cache[boost::hash<name_t>()(function) % cache_size_k]; }
+
+        template <typename F>
+        bool current(const entry_t<F>& entry, name_t function) const
+        {
+            return entry.function_m != 0 &&
+                   entry.name_m == function &&
+                   entry.generation_m == pack_m->generation();
+        }
+
+        template <typename F>
+        void store(entry_t<F>& entry, name_t function, const F& f) const
+        {
+            entry.name_m = function;
+            entry.function_m = &f;
+            entry.generation_m = pack_m->generation();
+        }
+
+        const function_pack_t*                 pack_m;
+        mutable entry_t<array_function_t>      array_cache_m[cache_size_k];
+        mutable entry_t<dictionary_function_t> dictionary_cache_m[cache_size_k];
+    };
+
 #ifndef ADOBE_NO_DOCUMENTATION
 private:
     typedef closed_hash_map<name_t, dictionary_function_t>       dictionary_function_map_t;
     typedef closed_hash_map<name_t, array_function_t>            array_function_map_t;
+    typedef closed_hash_map<name_t, prepared_function_t>         prepared_function_map_t;
 
-    dictionary_function_map_t::const_iterator find_named(name_t function) const
+    /*
+        Non-throwing lookup: the function registered under the name passed, or null with the
+        reason recorded in result.
+    */
+    template <typename M>
+    static const typename M::mapped_type* try_find(const M&             function_map,
+                                                   name_t               function,
+                                                   try_invoke_result_t& result)
     {
+        result.function_m = function;
+
         if (function == name_t())
-            throw std::runtime_error("find_named: no function name specified");
+        {
+            result.status_m = function_pack_no_function_name;
+
+            return 0;
+        }
 
-        dictionary_function_map_t::const_iterator found(dictionary_function_map_m.find(function));
+        typename M::const_iterator found(function_map.find(function));
 
-        if (found == dictionary_function_map_m.end())
-            throw std::runtime_error(make_string("find_named: function '",
-                                                 function.c_str(),
-                                                 "' not found"));
+        if (found == function_map.end())
+        {
+            result.status_m = function_pack_function_not_found;
 
-        return found;
+            return 0;
+        }
+
+        result.status_m = function_pack_success;
+
+        return &found->second;
     }
 
-    array_function_map_t::const_iterator find_unnamed(name_t function) const
+    const dictionary_function_t& find_named(name_t function) const
     {
-        if (function == name_t())
-            throw std::runtime_error("find_named: no function name specified");
+        try_invoke_result_t          error;
+        const dictionary_function_t* result(try_find(dictionary_function_map_m, function, error));
 
-        array_function_map_t::const_iterator found(array_function_map_m.find(function));
+        if (!result)
+        {
+            error.named_m = true;
 
-        if (found == array_function_map_m.end())
-            throw std::runtime_error(make_string("find_unnamed: function '",
-                                                 function.c_str(),
-                                                 "' not found"));
+            throw std::runtime_error(error.message());
+        }
 
-        return found;
+        return *result;
     }
 
-    template <typename T>
-    void attach_unnamed(name_t name, T helper)
+    const array_function_t& find_unnamed(name_t function) const
     {
-        typename T::result_type (T::*proc)(const array_t&) const = &T::operator();
+        try_invoke_result_t     error;
+        const array_function_t* result(try_find(array_function_map_m, function, error));
 
-        array_function_map_m.insert(
-            array_function_map_t::value_type(name,
-                boost::bind(&implementation::wrap_regular<typename T::result_type>,
-                            boost::bind(proc, helper, _1))));
+        if (!result)
+            throw std::runtime_error(error.message());
+
+        return *result;
     }
 
-    template <typename T>
-    void attach_named(name_t name, T helper)
+    template <typename T, typename M>
+    try_invoke_result_t try_invoke(name_t                         function,
+                                   const T&                       argument_set,
+                                   const prepared_function_map_t& prepared_function_map,
+                                   const M&                       function_map) const
     {
-        typename T::result_type (T::*proc)(const dictionary_t&) const = &T::operator();
+        try_invoke_result_t result;
+
+        result.named_m = boost::is_same<T, dictionary_t>::value;
+
+        if (const prepared_function_t* prepared = try_find(prepared_function_map, function, result))
+        {
+            std::size_t mismatch(prepared->invoke(argument_set, result.value_m));
 
-        dictionary_function_map_m.insert(
-            dictionary_function_map_t::value_type(name,
-                boost::bind(&implementation::wrap_regular<typename T::result_type>,
-                            boost::bind(proc, helper, _1))));
+            if (mismatch != prepared->arity())
+                argument_error(*prepared, argument_set, mismatch, result);
+        }
+        else if (result.status_m == function_pack_function_not_found)
+        {
+            // registered with register_unnamed or register_named, if at all
+
+            if (const typename M::mapped_type* f = try_find(function_map, function, result))
+                result.value_m = (*f)(argument_set);
+        }
+
+        return result;
+    }
+
+    static void argument_error(const prepared_function_t&,
+                               const array_t&             argument_set,
+                               std::size_t                mismatch,
+                               try_invoke_result_t&       result)
+    {
+        result.argument_index_m = mismatch;
+        result.status_m = mismatch < argument_set.size() ? function_pack_argument_mistyped :
+                                                           function_pack_argument_missing;
+    }
+
+    static void argument_error(const prepared_function_t& prepared,
+                               const dictionary_t&        named_argument_set,
+                               std::size_t                mismatch,
+                               try_invoke_result_t&       result)
+    {
+        result.argument_index_m = mismatch;
+        result.argument_name_m = prepared.name_set()[mismatch];
+        result.status_m = named_argument_set.count(result.argument_name_m) ?
+                              function_pack_argument_mistyped :
+                              function_pack_argument_missing;
+    }
+
+    /*
+        The functions already found during one invoke_batch() call. A batch usually holds a
+        handful of distinct functions, so they are kept in order of lookup and searched from the
+        most recent.
+    */
+    struct batch_lookup_t
+    {
+        std::vector<std::pair<name_t, const array_function_t*> >      array_function_set_m;
+        std::vector<std::pair<name_t, const dictionary_function_t*> > dictionary_function_set_m;
+    };
+
+    template <typename F>
+    static const F* find_cached(const std::vector<std::pair<name_t, const F*> >& function_set,
+                                name_t                                         function)
+    {
+        for (std::size_t i(function_set.size()); i != 0; --i)
+            if (function_set[i - 1].first == function)
+                return function_set[i - 1].second;
+
+        return 0;
+    }
+
+    const array_function_t& find_unnamed(name_t function, batch_lookup_t& lookup) const
+    {
+        const array_function_t* result(find_cached(lookup.array_function_set_m, function));
+
+        if (!result)
+        {
+            result = &find_unnamed(function);
+
+            lookup.array_function_set_m.push_back(std::make_pair(function, result));
+        }
+
+        return *result;
+    }
+
+    const dictionary_function_t& find_named(name_t function, batch_lookup_t& lookup) const
+    {
+        const dictionary_function_t* result(find_cached(lookup.dictionary_function_set_m, function));
+
+        if (!result)
+        {
+            result = &find_named(function);
+
+            lookup.dictionary_function_set_m.push_back(std::make_pair(function, result));
+        }
+
+        return *result;
+    }
+
+    function_result_t invoke_command(const array_t& argument_set, batch_lookup_t& lookup) const
+    {
+        function_result_t result;
+
+        try
+        {
+            adobe::name_t function;
+
+            if (!argument_set.empty())
+                argument_set[0].cast<adobe::name_t>(function);
+
+            result.value_m = find_unnamed(function, lookup)(argument_set);
+        }
+        catch (...)
+        {
+            result.error_m = std::current_exception();
+        }
+
+        return result;
+    }
+
+    function_result_t invoke_command(const dictionary_t& named_argument_set,
+                                     batch_lookup_t&     lookup) const
+    {
+        function_result_t result;
+
+        try
+        {
+            adobe::name_t function;
+
+            get_value(named_argument_set, "command"_name, function);
+
+            result.value_m = find_named(function, lookup)(named_argument_set);
+        }
+        catch (...)
+        {
+            result.error_m = std::current_exception();
+        }
+
+        return result;
+    }
+
+    function_result_t invoke_command(const any_regular_t& command, batch_lookup_t& lookup) const
+    {
+        if (command.type_info() == type_info<dictionary_t>())
+            return invoke_command(command.cast<dictionary_t>(), lookup);
+
+        if (command.type_info() == type_info<array_t>())
+            return invoke_command(command.cast<array_t>(), lookup);
+
+        function_result_t result;
+
+        result.error_m = std::make_exception_ptr(
+            std::runtime_error("invoke_batch: command is neither an array_t nor a dictionary_t"));
+
+        return result;
+    }
+
+    template <typename F>
+    void attach_unnamed(name_t name, const implementation::function_pack_helper<F>& helper)
+    {
+        // the prepared form only goes with the function actually registered under the name
+
+        if (array_function_map_m.insert(array_function_map_t::value_type(name, helper)).second)
+            prepared_unnamed_map_m.insert(
+                prepared_function_map_t::value_type(name,
+                    prepared_function_t(static_cast<std::size_t>(helper.arity), helper)));
+
+        ++generation_m;
+    }
+
+    template <typename F>
+    void attach_named(name_t name, const implementation::function_pack_helper<F>& helper)
+    {
+        if (dictionary_function_map_m.insert(dictionary_function_map_t::value_type(name, helper)).second)
+            prepared_function_map_m.insert(
+                prepared_function_map_t::value_type(name,
+                    prepared_function_t(helper.name_set(), helper)));
+
+        ++generation_m;
     }
 
     dictionary_function_map_t dictionary_function_map_m;
     array_function_map_t      array_function_map_m;
+    prepared_function_map_t   prepared_function_map_m;
+    prepared_function_map_t   prepared_unnamed_map_m;
+    std::size_t               generation_m;
 // ADOBE_NO_DOCUMENTATION
 #endif
 };
@@ -906,15 +1241,17 @@ private:
     \relates function_pack_t
 
     Binds a function pack to an virtual_machine_t as the array- and dictionary-based function
-    lookup mechanism.
+    lookup mechanism, through a function_pack_t::cached_lookup_t.
 
     \note
     The function pack must have a lifetime that is at least equal to that of the VM
 */
 inline void attach(virtual_machine_t& vm, const function_pack_t& pack)
 {
-    vm.set_array_function_lookup(boost::cref(pack));
-    vm.set_dictionary_function_lookup(boost::cref(pack));
+    function_pack_t::cached_lookup_t lookup(pack);
+
+    vm.set_array_function_lookup(lookup);
+    vm.set_dictionary_function_lookup(lookup);
 }
 
 /******************************************************************************/
@@ -55,7 +55,12 @@ public:
         return *this;
     }
     
-    // Executes the behavior
+    // Executes the behavior. A single execution behavior is emptied as
+    // it runs: verbs and behaviors inserted while it runs are left for
+    // the next execution. If one of them throws, the exception is passed
+    // on, the one that threw is dropped and those that had yet to run
+    // are kept, ahead of any inserted during the run, for the next
+    // execution.
     void operator () ();
 
     behavior_token_t insert_behavior(bool single_execution);
@@ -81,6 +86,8 @@ private:
 
     void erase_from_order(order_t type, std::size_t index);
 
+    static void run(verb_set_t& verb_set, behavior_set_t& behavior_set, const order_set_t& order_set);
+
     bool                            single_execution_m;
     verb_set_t                      verb_set_m;
     behavior_set_t*                 behavior_set_m;
@@ -66,10 +66,73 @@ void behavior_t::operator () ()
     if (order_set_m.empty())
         return;
 
-    verb_set_t::iterator     vfirst(verb_set_m.begin());
-    behavior_set_t::iterator bfirst(behavior_set_m->begin());
-    order_set_t::iterator    first(order_set_m.begin());
-    order_set_t::iterator    last(order_set_m.end());
+    if (!single_execution_m)
+    {
+        run(verb_set_m, *behavior_set_m, order_set_m);
+
+        return;
+    }
+
+    // A single execution behavior is emptied before it runs, so a verb
+    // that inserts another (a deferred proc scheduling more deferred
+    // work) adds it to the next execution rather than to the sets being
+    // iterated. Each verb or behavior is spliced out of the pending sets
+    // before it is called, so if it throws the pending sets hold exactly
+    // what has yet to run.
+
+    verb_set_t     verb_set;
+    behavior_set_t behavior_set;
+    order_set_t    order_set;
+
+    verb_set.swap(verb_set_m);
+    behavior_set.swap(*behavior_set_m);
+    order_set.swap(order_set_m);
+
+    verb_set_t     ran_verb_set;
+    behavior_set_t ran_behavior_set;
+
+    order_set_t::const_iterator first(order_set.begin());
+    order_set_t::const_iterator last(order_set.end());
+
+    try
+    {
+        for (; first != last; ++first)
+        {
+            if (*first == behavior_t::order_verb_k)
+            {
+                ran_verb_set.splice(ran_verb_set.end(), verb_set, verb_set.begin());
+
+                ran_verb_set.back()();
+            }
+            else if (*first == behavior_t::order_behavior_k)
+            {
+                ran_behavior_set.splice(ran_behavior_set.end(), behavior_set, behavior_set.begin());
+
+                ran_behavior_set.back()();
+            }
+        }
+    }
+    catch (...)
+    {
+        // What had yet to run goes back ahead of anything inserted
+        // during this execution; the one that threw is dropped.
+
+        verb_set_m.splice(verb_set_m.begin(), verb_set);
+        behavior_set_m->splice(behavior_set_m->begin(), behavior_set);
+        order_set_m.insert(order_set_m.begin(), first + 1, last);
+
+        throw;
+    }
+}
+
+/**************************************************************************************************/
+
+void behavior_t::run(verb_set_t& verb_set, behavior_set_t& behavior_set, const order_set_t& order_set)
+{
+    verb_set_t::iterator        vfirst(verb_set.begin());
+    behavior_set_t::iterator    bfirst(behavior_set.begin());
+    order_set_t::const_iterator first(order_set.begin());
+    order_set_t::const_iterator last(order_set.end());
 
     for (; first != last; ++first)
     {
@@ -86,13 +149,6 @@ void behavior_t::operator () ()
             ++bfirst;
         }
     }
-
-    if (single_execution_m)
-    {
-        behavior_set_m->clear();
-        verb_set_m.clear();
-        order_set_m.clear();
-    }
 }
 
 /**************************************************************************************************/
@@ -0,0 +1,324 @@
+/*
+    Copyright 2013 Adobe
+    Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*/
+/******************************************************************************/
+
+#ifndef ADOBE_DERIVED_SEQUENCE_MODEL_HPP
+#define ADOBE_DERIVED_SEQUENCE_MODEL_HPP
+
+/******************************************************************************/
+
+#include <adobe/config.hpp>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <adobe/algorithm/find.hpp>
+#include <adobe/closed_hash.hpp>
+#include <adobe/implementation/rank_tree.hpp>
+#include <adobe/sequence_model.hpp>
+
+/******************************************************************************/
+
+namespace adobe {
+
+/******************************************************************************/
+
+namespace implementation {
+
+/******************************************************************************/
+/*
+    Common base of the models derived from a sequence_model
+    (filtered_sequence_model and sorted_sequence_model.) A derived model
+    is attached to its source as a SequenceView and keeps one node per
+    source element in a rank_tree, in the derived order; nodes of
+    weight zero are elements the derived model hides. Downstream views
+    attach to the derived model as they would to a sequence_model and
+    are told about the visible elements only, using the source's keys,
+    so a key received from a derived model can be handed straight to
+    the source (or to its controllers.)
+
+    The derived class implements refresh, extend, extend_set and move; erase
+    and clear are the same for every derived model and live here.
+*/
+template <typename T>
+class derived_sequence_model : boost::noncopyable
+{
+public:
+    typedef T                                    value_type;
+    typedef std::size_t                          size_type;
+    typedef copy_on_write<value_type>            cow_value_type;
+    typedef sequence_key<T>                      key_type;
+    typedef typename poly_sequence_view<T>::type poly_sequence_view_type;
+
+    static cow_value_type at(key_type key)
+    { return sequence_model<T>::at(key); }
+
+    /// number of elements visible through the derived model
+    size_type size() const { return tree_m.weight(); }
+    bool      empty() const { return size() == 0; }
+
+    /*!
+        Returns the position of the element referred to by key in the
+        derived order, or size() if the element is hidden or unknown.
+        O(log n).
+    */
+    size_type position_of(key_type key) const
+    {
+        node_t* node(node_for(key));
+
+        return node && node->weight_m != 0 ? tree_m.rank(node) : size();
+    }
+
+    /*!
+        Returns the key of the element at the position passed in the
+        derived order, or nkey if the position is not less than size().
+        O(log n).
+    */
+    key_type key_at(size_type position) const
+    {
+        node_t* node(tree_m.select(position));
+
+        return node ? node->value_m.key_m : key_type::nkey;
+    }
+
+    void attach_view(poly_sequence_view_type& view);
+    void detach_view(poly_sequence_view_type& view);
+
+    void erase(const std::vector<key_type>& key_set)
+    {
+        typedef typename std::vector<key_type>::const_iterator const_iterator;
+
+        std::vector<key_type> erased_key_set;
+
+        for (const_iterator iter(key_set.begin()), last(key_set.end()); iter != last; ++iter)
+        {
+            typename index_type::iterator found(index_m.find(*iter));
+
+            if (found == index_m.end())
+                continue;
+
+            if (found->second->weight_m != 0)
+                erased_key_set.push_back(*iter);
+
+            tree_m.erase(found->second);
+
+            index_m.erase(found);
+        }
+
+        if (!erased_key_set.empty())
+            notify_erase(erased_key_set);
+    }
+
+    void clear()
+    {
+        tree_m.clear();
+        index_m.clear();
+
+        for (typename view_set_t::iterator iter(view_set_m.begin()), last(view_set_m.end());
+             iter != last; ++iter)
+            (*iter)->clear();
+    }
+
+protected:
+    #ifndef ADOBE_NO_DOCUMENTATION
+
+    derived_sequence_model()
+    { }
+
+    struct entry_t
+    {
+        key_type       key_m;
+        cow_value_type value_m;
+    };
+
+    typedef rank_tree<entry_t>                   tree_type;
+    typedef typename tree_type::node_t           node_t;
+    typedef closed_hash_map<key_type, node_t*>   index_type;
+
+    node_t* node_for(key_type key) const
+    {
+        if (key == key_type::nkey)
+            return 0;
+
+        typename index_type::const_iterator found(index_m.find(key));
+
+        return found == index_m.end() ? 0 : found->second;
+    }
+
+    node_t* add(node_t* before, key_type key, const cow_value_type& value, size_type weight)
+    {
+        entry_t entry;
+
+        entry.key_m = key;
+        entry.value_m = value;
+
+        node_t* result(tree_m.insert(before, entry, weight));
+
+        index_m.insert(typename index_type::value_type(key, result));
+
+        return result;
+    }
+
+    void remove(node_t* node)
+    {
+        index_m.erase(node->value_m.key_m);
+
+        tree_m.erase(node);
+    }
+
+    /// key of the first visible element following node, or nkey
+    key_type visible_after(const node_t* node) const
+    { return key_at(tree_m.rank(node) + node->weight_m); }
+
+    /*
+        Tells the views about nodes that have just become visible, in as
+        few notifications as possible: the nodes are ordered by position
+        and each run of adjacent positions goes out as one extend_set
+        (or extend, for a run of one.) O(k log k) for k nodes.
+    */
+    void notify_shown(const std::vector<node_t*>& node_set)
+    {
+        typedef std::pair<size_type, node_t*>   ranked_t;
+        typedef typename std::vector<ranked_t>::const_iterator const_iterator;
+
+        if (node_set.empty() || view_set_m.empty())
+            return;
+
+        std::vector<ranked_t> ranked_set;
+
+        ranked_set.reserve(node_set.size());
+
+        for (typename std::vector<node_t*>::const_iterator iter(node_set.begin()),
+             last(node_set.end()); iter != last; ++iter)
+            ranked_set.push_back(ranked_t(tree_m.rank(*iter), *iter));
+
+        std::sort(ranked_set.begin(), ranked_set.end());
+
+        std::vector<key_type> run;
+
+        for (const_iterator iter(ranked_set.begin()), last(ranked_set.end()); iter != last; ++iter)
+        {
+            run.push_back(iter->second->value_m.key_m);
+
+            const_iterator next(iter + 1);
+
+            if (next != last && next->first == iter->first + 1)
+                continue;
+
+            key_type before(visible_after(iter->second));
+
+            if (run.size() == 1)
+                notify_extend(before, run.front(), iter->second->value_m.value_m);
+            else
+                notify_extend_set(before, run);
+
+            run.clear();
+        }
+    }
+
+    void notify_refresh(key_type key, const cow_value_type& value)
+    {
+        for (typename view_set_t::iterator iter(view_set_m.begin()), last(view_set_m.end());
+             iter != last; ++iter)
+            (*iter)->refresh(key, value);
+    }
+
+    void notify_extend(key_type before, key_type key, const cow_value_type& value)
+    {
+        for (typename view_set_t::iterator iter(view_set_m.begin()), last(view_set_m.end());
+             iter != last; ++iter)
+            (*iter)->extend(before, key, value);
+    }
+
+    void notify_extend_set(key_type before, const std::vector<key_type>& key_set)
+    {
+        for (typename view_set_t::iterator iter(view_set_m.begin()), last(view_set_m.end());
+             iter != last; ++iter)
+            (*iter)->extend_set(before, key_set);
+    }
+
+    void notify_erase(const std::vector<key_type>& key_set)
+    {
+        for (typename view_set_t::iterator iter(view_set_m.begin()), last(view_set_m.end());
+             iter != last; ++iter)
+            (*iter)->erase(key_set);
+    }
+
+    void notify_move(const std::vector<key_type>& key_set, key_type before)
+    {
+        for (typename view_set_t::iterator iter(view_set_m.begin()), last(view_set_m.end());
+             iter != last; ++iter)
+            (*iter)->move(key_set, before);
+    }
+
+    /// sends the whole visible sequence to a view that has just been cleared
+    void send_contents(poly_sequence_view_type& view) const
+    {
+        if (empty())
+            return;
+
+        std::vector<key_type> key_set;
+
+        key_set.reserve(size());
+
+        for (node_t* node(tree_m.front()); node; node = tree_type::next(node))
+            if (node->weight_m != 0)
+                key_set.push_back(node->value_m.key_m);
+
+        view.extend_set(key_type::nkey, key_set);
+    }
+
+    typedef std::vector<poly_sequence_view_type*> view_set_t;
+
+    tree_type  tree_m;
+    index_type index_m;
+    view_set_t view_set_m;
+
+    // ADOBE_NO_DOCUMENTATION
+    #endif
+};
+
+/******************************************************************************/
+
+template <typename T>
+void derived_sequence_model<T>::attach_view(poly_sequence_view_type& view)
+{
+    if (adobe::find(view_set_m, &view) != view_set_m.end())
+        return;
+
+    view_set_m.push_back(&view);
+
+    view.clear();
+
+    send_contents(view);
+}
+
+/******************************************************************************/
+
+template <typename T>
+void derived_sequence_model<T>::detach_view(poly_sequence_view_type& view)
+{
+    typename view_set_t::iterator found(adobe::find(view_set_m, &view));
+
+    if (found != view_set_m.end())
+        view_set_m.erase(found);
+}
+
+/******************************************************************************/
+
+} // namespace implementation
+
+/******************************************************************************/
+
+} // namespace adobe
+
+/******************************************************************************/
+// ADOBE_DERIVED_SEQUENCE_MODEL_HPP
+#endif
+/******************************************************************************/
@@ -0,0 +1,279 @@
+/*
+    Copyright 2013 Adobe
+    Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*/
+/******************************************************************************/
+
+#ifndef ADOBE_NODE_ARENA_HPP
+#define ADOBE_NODE_ARENA_HPP
+
+/******************************************************************************/
+
+#include <adobe/config.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/type_traits/alignment_of.hpp>
+
+/******************************************************************************/
+
+namespace adobe {
+
+/******************************************************************************/
+
+namespace implementation {
+
+/******************************************************************************/
+/*
+    node_arena_t hands out fixed size blocks for node based containers.
+    Each distinct block size gets its own pool. A pool carves blocks in
+    order out of chunks that double in size as the pool grows, so nodes
+    allocated one after the other sit next to each other in memory.
+    Freed blocks go on a per-pool free list and are reused before the
+    chunk is carved further.
+
+    The chunks are returned to the heap when the arena is destroyed, so
+    the containers drawing on an arena must be destroyed before it.
+    Clearing a container only puts its blocks back on the free lists; an
+    owner wanting the memory back at once swaps its containers onto a
+    fresh arena, calls discard() on the old one and destroys both.
+*/
+class node_arena_t : boost::noncopyable
+{
+public:
+    node_arena_t() :
+        discard_m(false)
+    { }
+
+    ~node_arena_t()
+    {
+        for (std::vector<pool_t>::iterator iter(pool_set_m.begin()),
+             last(pool_set_m.end()); iter != last; ++iter)
+        {
+            assert(discard_m || iter->live_m == 0);
+
+            for (std::vector<char*>::iterator chunk(iter->chunk_set_m.begin()),
+                 chunk_last(iter->chunk_set_m.end()); chunk != chunk_last; ++chunk)
+                ::operator delete(*chunk);
+        }
+    }
+
+    void* allocate(std::size_t size)
+    {
+        pool_t& pool(pool_for(size));
+
+        ++pool.live_m;
+
+        if (pool.free_m)
+        {
+            free_block_t* result(pool.free_m);
+
+            pool.free_m = result->next_m;
+
+            return result;
+        }
+
+        if (pool.first_m == pool.last_m)
+            grow(pool);
+
+        void* result(pool.first_m);
+
+        pool.first_m += pool.size_m;
+
+        return result;
+    }
+
+    void deallocate(void* p, std::size_t size)
+    {
+        if (discard_m)
+            return;
+
+        pool_t& pool(pool_for(size));
+
+        assert(pool.live_m != 0);
+
+        --pool.live_m;
+
+        free_block_t* block(static_cast<free_block_t*>(p));
+
+        block->next_m = pool.free_m;
+        pool.free_m = block;
+    }
+
+    /*!
+        From here on deallocate() does nothing, and the chunks go back to
+        the heap whole when the arena is destroyed. Only for an arena
+        whose containers are all about to be destroyed: it saves threading
+        every node back onto a free list that will never be used.
+    */
+    void discard()
+    { discard_m = true; }
+
+    /// number of chunks currently held, across every pool
+    std::size_t chunk_count() const
+    {
+        std::size_t result(0);
+
+        for (std::vector<pool_t>::const_iterator iter(pool_set_m.begin()),
+             last(pool_set_m.end()); iter != last; ++iter)
+            result += iter->chunk_set_m.size();
+
+        return result;
+    }
+
+private:
+    struct free_block_t
+    {
+        free_block_t* next_m;
+    };
+
+    struct pool_t
+    {
+        std::size_t        size_m;
+        std::size_t        live_m;
+        std::size_t        next_chunk_m;
+        free_block_t*      free_m;
+        char*              first_m;
+        char*              last_m;
+        std::vector<char*> chunk_set_m;
+    };
+
+    enum
+    {
+        block_alignment = boost::alignment_of<long double>::value > sizeof(void*) ?
+                              boost::alignment_of<long double>::value :
+                              sizeof(void*),
+        first_chunk_blocks = 64,
+        max_chunk_blocks = 64 * 1024
+    };
+
+    static std::size_t block_size(std::size_t size)
+    {
+        if (size < sizeof(free_block_t))
+            size = sizeof(free_block_t);
+
+        return (size + block_alignment - 1) / block_alignment * block_alignment;
+    }
+
+    pool_t& pool_for(std::size_t size)
+    {
+        size = block_size(size);
+
+        // There is one pool per node type using the arena, so a handful
+        // at most; a linear search beats anything cleverer.
+
+        for (std::vector<pool_t>::iterator iter(pool_set_m.begin()),
+             last(pool_set_m.end()); iter != last; ++iter)
+            if (iter->size_m == size)
+                return *iter;
+
+        pool_t pool = { size, 0, first_chunk_blocks, 0, 0, 0, std::vector<char*>() };
+
+        pool_set_m.push_back(pool);
+
+        return pool_set_m.back();
+    }
+
+    static void grow(pool_t& pool)
+    {
+        std::size_t bytes(pool.size_m * pool.next_chunk_m);
+        char*       chunk(static_cast<char*>(::operator new(bytes)));
+
+        pool.chunk_set_m.push_back(chunk);
+
+        pool.first_m = chunk;
+        pool.last_m = chunk + bytes;
+
+        if (pool.next_chunk_m < max_chunk_blocks)
+            pool.next_chunk_m *= 2;
+    }
+
+    std::vector<pool_t> pool_set_m;
+    bool                discard_m;
+};
+
+/******************************************************************************/
+/*
+    Allocator drawing single nodes from a node_arena_t. Requests for more
+    than one object, or any request made through an allocator without an
+    arena, go to the heap, so containers that allocate arrays (or models
+    that did not ask for pooling) behave as with std::allocator.
+*/
+template <typename T>
+class node_arena_allocator
+{
+public:
+    typedef T                 value_type;
+    typedef T*                pointer;
+    typedef const T*          const_pointer;
+    typedef T&                reference;
+    typedef const T&          const_reference;
+    typedef std::size_t       size_type;
+    typedef std::ptrdiff_t    difference_type;
+
+    // the nodes belong to the arena, so they follow it when containers swap
+    typedef std::true_type    propagate_on_container_swap;
+    typedef std::true_type    propagate_on_container_move_assignment;
+
+    template <typename U>
+    struct rebind
+    {
+        typedef node_arena_allocator<U> other;
+    };
+
+    explicit node_arena_allocator(node_arena_t* arena = 0) :
+        arena_m(arena)
+    { }
+
+    template <typename U>
+    node_arena_allocator(const node_arena_allocator<U>& x) :
+        arena_m(x.arena())
+    { }
+
+    pointer allocate(size_type n)
+    {
+        if (arena_m && n == 1)
+            return static_cast<pointer>(arena_m->allocate(sizeof(T)));
+
+        return static_cast<pointer>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(pointer p, size_type n)
+    {
+        if (arena_m && n == 1)
+            arena_m->deallocate(p, sizeof(T));
+        else
+            ::operator delete(p);
+    }
+
+    node_arena_t* arena() const
+    { return arena_m; }
+
+    friend bool operator==(const node_arena_allocator& x, const node_arena_allocator& y)
+    { return x.arena_m == y.arena_m; }
+
+    friend bool operator!=(const node_arena_allocator& x, const node_arena_allocator& y)
+    { return x.arena_m != y.arena_m; }
+
+private:
+    node_arena_t* arena_m;
+};
+
+/******************************************************************************/
+
+} // namespace implementation
+
+/******************************************************************************/
+
+} // namespace adobe
+
+/******************************************************************************/
+// ADOBE_NODE_ARENA_HPP
+#endif
+/******************************************************************************/
@@ -0,0 +1,440 @@
+/*
+    Copyright 2013 Adobe
+    Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*/
+/******************************************************************************/
+
+#ifndef ADOBE_RANK_TREE_HPP
+#define ADOBE_RANK_TREE_HPP
+
+/******************************************************************************/
+
+#include <adobe/config.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+
+/******************************************************************************/
+
+namespace adobe {
+
+/******************************************************************************/
+
+namespace implementation {
+
+/******************************************************************************/
+/*
+    rank_tree is a sequence stored in a randomized balanced binary tree
+    (a treap ordered by position rather than by value.) Every node
+    carries a weight, and every node knows the total weight of its
+    subtree, so the tree answers both "how much weight precedes this
+    node" (rank) and "which node sits at this accumulated weight"
+    (select) in O(log n) expected time. Insertion before a given node
+    and erasure of a node are O(log n) expected as well.
+
+    With every weight at 1 the rank of a node is its position in the
+    sequence; a weight of 0 hides a node from rank and select while
+    keeping its place in the sequence (used to represent filtering.)
+
+    Nodes never move in memory, so clients may hold on to node pointers
+    until the node is erased. Nodes are obtained from A rebound to the
+    node type.
+*/
+template <typename T, typename A = std::allocator<T> >
+class rank_tree : boost::noncopyable
+{
+public:
+    typedef T           value_type;
+    typedef std::size_t size_type;
+
+    struct node_t
+    {
+        value_type     value_m;
+        node_t*        parent_m;
+        node_t*        left_m;
+        node_t*        right_m;
+        size_type      weight_m;
+        size_type      total_m;
+        boost::uint32_t priority_m;
+    };
+
+    typedef A           allocator_type;
+
+    explicit rank_tree(const allocator_type& allocator = allocator_type()) :
+        allocator_m(allocator),
+        root_m(0),
+        node_count_m(0),
+        seed_m(2463534242UL)
+    { }
+
+    ~rank_tree()
+    { clear(); }
+
+    /// total weight of the tree
+    size_type weight() const
+    { return total(root_m); }
+
+    /// number of nodes in the tree, regardless of weight
+    size_type node_count() const
+    { return node_count_m; }
+
+    bool empty() const
+    { return root_m == 0; }
+
+    void clear()
+    {
+        destroy(root_m);
+
+        root_m = 0;
+        node_count_m = 0;
+    }
+
+    /// exchanges the nodes, and the allocator they came from, with x
+    void swap(rank_tree& x)
+    {
+        std::swap(allocator_m, x.allocator_m);
+        std::swap(root_m, x.root_m);
+        std::swap(node_count_m, x.node_count_m);
+        std::swap(seed_m, x.seed_m);
+    }
+
+    /*
+        Inserts a new node immediately before the node passed, or at the
+        end of the sequence if before is null.
+    */
+    node_t* insert(node_t* before, const value_type& value, size_type weight = 1)
+    {
+        node_t* node(allocator_m.allocate(1));
+
+        ::new (static_cast<void*>(node)) node_t();
+
+        node->value_m = value;
+        node->parent_m = 0;
+        node->left_m = 0;
+        node->right_m = 0;
+        node->weight_m = weight;
+        node->total_m = weight;
+        node->priority_m = next_priority();
+
+        ++node_count_m;
+
+        if (root_m == 0)
+        {
+            root_m = node;
+
+            return node;
+        }
+
+        node_t* parent(0);
+        bool    as_left(false);
+
+        if (before == 0)
+        {
+            parent = rightmost(root_m);
+        }
+        else if (before->left_m == 0)
+        {
+            parent = before;
+            as_left = true;
+        }
+        else
+        {
+            parent = rightmost(before->left_m);
+        }
+
+        node->parent_m = parent;
+
+        if (as_left)
+            parent->left_m = node;
+        else
+            parent->right_m = node;
+
+        for (node_t* iter(parent); iter; iter = iter->parent_m)
+            iter->total_m += weight;
+
+        while (node->parent_m && node->parent_m->priority_m < node->priority_m)
+            rotate_up(node);
+
+        return node;
+    }
+
+    void erase(node_t* node)
+    {
+        assert(node);
+
+        // rotate the node down until it is a leaf, then unlink it
+
+        while (node->left_m || node->right_m)
+        {
+            node_t* child(node->left_m == 0 ? node->right_m :
+                          node->right_m == 0 ? node->left_m :
+                          node->left_m->priority_m > node->right_m->priority_m ?
+                              node->left_m : node->right_m);
+
+            rotate_up(child);
+        }
+
+        node_t* parent(node->parent_m);
+
+        if (parent == 0)
+            root_m = 0;
+        else if (parent->left_m == node)
+            parent->left_m = 0;
+        else
+            parent->right_m = 0;
+
+        for (node_t* iter(parent); iter; iter = iter->parent_m)
+            iter->total_m -= node->weight_m;
+
+        destroy_node(node);
+
+        --node_count_m;
+    }
+
+    void set_weight(node_t* node, size_type weight)
+    {
+        assert(node);
+
+        size_type old_weight(node->weight_m);
+
+        node->weight_m = weight;
+
+        for (node_t* iter(node); iter; iter = iter->parent_m)
+            iter->total_m = iter->total_m - old_weight + weight;
+    }
+
+    /// total weight of the nodes preceding the node passed
+    size_type rank(const node_t* node) const
+    {
+        assert(node);
+
+        size_type result(total(node->left_m));
+
+        for (; node->parent_m; node = node->parent_m)
+            if (node->parent_m->right_m == node)
+                result += total(node->parent_m->left_m) + node->parent_m->weight_m;
+
+        return result;
+    }
+
+    /*
+        Returns the node of nonzero weight whose rank is at or below n
+        and whose rank plus weight is above n, or null if n is not less
+        than the weight of the tree.
+    */
+    node_t* select(size_type n) const
+    {
+        node_t* node(root_m);
+
+        while (node)
+        {
+            size_type left_total(total(node->left_m));
+
+            if (n < left_total)
+            {
+                node = node->left_m;
+
+                continue;
+            }
+
+            n -= left_total;
+
+            if (n < node->weight_m)
+                return node;
+
+            n -= node->weight_m;
+            node = node->right_m;
+        }
+
+        return 0;
+    }
+
+    /*
+        The sequence must be partitioned by pred: every value for which
+        pred is true precedes every value for which it is false. Returns
+        the first node for which pred is false, or null if there is none
+        (the analog of std::partition_point.) Weights play no part.
+    */
+    template <typename P> // P models UnaryPredicate on value_type
+    node_t* partition_point(P pred) const
+    {
+        node_t* result(0);
+
+        for (node_t* node(root_m); node;)
+        {
+            if (pred(node->value_m))
+            {
+                node = node->right_m;
+            }
+            else
+            {
+                result = node;
+                node = node->left_m;
+            }
+        }
+
+        return result;
+    }
+
+    node_t* front() const
+    { return root_m ? leftmost(root_m) : 0; }
+
+    node_t* back() const
+    { return root_m ? rightmost(root_m) : 0; }
+
+    /// in-order successor of the node passed, or null
+    static node_t* next(const node_t* node)
+    {
+        assert(node);
+
+        if (node->right_m)
+            return leftmost(node->right_m);
+
+        while (node->parent_m && node->parent_m->right_m == node)
+            node = node->parent_m;
+
+        return node->parent_m;
+    }
+
+    /// in-order predecessor of the node passed, or null
+    static node_t* prior(const node_t* node)
+    {
+        assert(node);
+
+        if (node->left_m)
+            return rightmost(node->left_m);
+
+        while (node->parent_m && node->parent_m->left_m == node)
+            node = node->parent_m;
+
+        return node->parent_m;
+    }
+
+private:
+    static size_type total(const node_t* node)
+    { return node ? node->total_m : 0; }
+
+    static node_t* leftmost(node_t* node)
+    {
+        while (node->left_m)
+            node = node->left_m;
+
+        return node;
+    }
+
+    static node_t* rightmost(node_t* node)
+    {
+        while (node->right_m)
+            node = node->right_m;
+
+        return node;
+    }
+
+    static node_t* leftmost(const node_t* node)
+    { return leftmost(const_cast<node_t*>(node)); }
+
+    static node_t* rightmost(const node_t* node)
+    { return rightmost(const_cast<node_t*>(node)); }
+
+    /*
+        Rotates node above its parent, keeping the in-order sequence and
+        the subtree totals intact.
+    */
+    void rotate_up(node_t* node)
+    {
+        node_t* parent(node->parent_m);
+        node_t* grandparent(parent->parent_m);
+
+        if (parent->left_m == node)
+        {
+            parent->left_m = node->right_m;
+
+            if (node->right_m)
+                node->right_m->parent_m = parent;
+
+            node->right_m = parent;
+        }
+        else
+        {
+            parent->right_m = node->left_m;
+
+            if (node->left_m)
+                node->left_m->parent_m = parent;
+
+            node->left_m = parent;
+        }
+
+        parent->parent_m = node;
+        node->parent_m = grandparent;
+
+        if (grandparent == 0)
+            root_m = node;
+        else if (grandparent->left_m == parent)
+            grandparent->left_m = node;
+        else
+            grandparent->right_m = node;
+
+        node->total_m = parent->total_m;
+        parent->total_m = total(parent->left_m) + total(parent->right_m) + parent->weight_m;
+    }
+
+    boost::uint32_t next_priority()
+    {
+        // xorshift32; the priorities only need to look random to the
+        // shape of the tree, not to an observer.
+
+        seed_m ^= seed_m << 13;
+        seed_m ^= seed_m >> 17;
+        seed_m ^= seed_m << 5;
+
+        return seed_m;
+    }
+
+    void destroy_node(node_t* node)
+    {
+        node->~node_t();
+
+        allocator_m.deallocate(node, 1);
+    }
+
+    void destroy(node_t* node)
+    {
+        while (node)
+        {
+            destroy(node->right_m);
+
+            node_t* left(node->left_m);
+
+            destroy_node(node);
+
+            node = left;
+        }
+    }
+
+    typedef typename std::allocator_traits<A>::template rebind_alloc<node_t> node_allocator_type;
+
+    node_allocator_type allocator_m;
+    node_t*             root_m;
+    size_type           node_count_m;
+    boost::uint32_t     seed_m;
+};
+
+/******************************************************************************/
+
+} // namespace implementation
+
+/******************************************************************************/
+
+} // namespace adobe
+
+/******************************************************************************/
+// ADOBE_RANK_TREE_HPP
+#endif
+/******************************************************************************/
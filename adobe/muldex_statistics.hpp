@@ -0,0 +1,201 @@
+/*
+    Copyright 2013 Adobe
+    Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*/
+/******************************************************************************/
+
+#ifndef ADOBE_MULDEX_STATISTICS_HPP
+#define ADOBE_MULDEX_STATISTICS_HPP
+
+/******************************************************************************/
+
+#include <adobe/config.hpp>
+
+#include <chrono>
+#include <cstddef>
+
+#ifdef ADOBE_STD_SERIALIZATION
+    #include <iostream>
+#endif
+
+#include <boost/cstdint.hpp>
+
+#include <adobe/closed_hash.hpp>
+#include <adobe/name.hpp>
+
+/******************************************************************************/
+
+namespace adobe {
+
+/******************************************************************************/
+/*!
+    \ingroup sequence_mvc
+
+    \brief Counts, payload sizes and dispatch latencies of the commands
+    received by one or more muldex demultiplexers.
+
+    A muldex_statistics_t is attached to a demultiplexer with
+    set_statistics(); any number of demultiplexers may share one. Each
+    command is recorded under its name ("refresh", "push_back", and so
+    on, as in the dictionary encoding) and a batch is recorded under
+    "batch" as well as under the name of each command in it.
+
+    The payload of a command is the number of elements it carries: the
+    size of its key_set or value_set, one for a command about a single
+    element and zero for clear. The payload of a batch is its number of
+    commands.
+
+    The latency of a command is the time taken to dispatch it to the
+    sequence view or model on the receiving end, which includes whatever
+    that view or model does in response. Latencies are kept in a
+    histogram with power-of-two buckets: bucket i counts the dispatches
+    that took less than 2^i nanoseconds and at least 2^(i-1) (bucket zero
+    those under a nanosecond); the last bucket holds everything longer.
+
+    A demultiplexer with no statistics attached records nothing and does
+    not read the clock.
+*/
+class muldex_statistics_t
+{
+public:
+    typedef std::chrono::steady_clock clock_type;
+    typedef clock_type::duration      duration_type;
+
+    enum { histogram_size_k = 40 };
+
+    struct record_t
+    {
+        record_t() :
+            count_m(0),
+            payload_total_m(0),
+            payload_max_m(0),
+            latency_total_m(duration_type::zero()),
+            latency_max_m(duration_type::zero())
+        {
+            for (std::size_t i(0); i != histogram_size_k; ++i)
+                histogram_m[i] = 0;
+        }
+
+        std::size_t   count_m;
+        std::size_t   payload_total_m;
+        std::size_t   payload_max_m;
+        duration_type latency_total_m;
+        duration_type latency_max_m;
+        std::size_t   histogram_m[histogram_size_k];
+    };
+
+    typedef closed_hash_map<name_t, record_t> record_set_t;
+    typedef record_set_t::const_iterator      const_iterator;
+
+    muldex_statistics_t() :
+        start_m(clock_type::now())
+    { }
+
+    void record(name_t command, std::size_t payload_size, duration_type latency)
+    {
+        record_t& entry(record_set_m[command]);
+
+        ++entry.count_m;
+
+        entry.payload_total_m += payload_size;
+        entry.latency_total_m += latency;
+
+        if (entry.payload_max_m < payload_size)
+            entry.payload_max_m = payload_size;
+
+        if (entry.latency_max_m < latency)
+            entry.latency_max_m = latency;
+
+        ++entry.histogram_m[bucket(latency)];
+    }
+
+    /// the record for the command named, or 0 if none was received
+    const record_t* find(name_t command) const
+    {
+        const_iterator found(record_set_m.find(command));
+
+        return found == record_set_m.end() ? 0 : &found->second;
+    }
+
+    /// number of commands of the name passed received so far
+    std::size_t count(name_t command) const
+    {
+        const record_t* found(find(command));
+
+        return found ? found->count_m : 0;
+    }
+
+    const_iterator begin() const { return record_set_m.begin(); }
+    const_iterator end() const   { return record_set_m.end(); }
+    bool           empty() const { return record_set_m.empty(); }
+
+    /// time since construction or the last reset
+    duration_type elapsed() const
+    { return clock_type::now() - start_m; }
+
+    /// commands of the name passed received per second since construction or the last reset
+    double rate(name_t command) const
+    {
+        double seconds(std::chrono::duration<double>(elapsed()).count());
+
+        return seconds == 0 ? 0 : count(command) / seconds;
+    }
+
+    void reset()
+    {
+        record_set_m.clear();
+
+        start_m = clock_type::now();
+    }
+
+    /// index of the histogram bucket counting latency
+    static std::size_t bucket(duration_type latency)
+    {
+        boost::uint64_t nanoseconds(std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count());
+        std::size_t     result(0);
+
+        while (nanoseconds != 0 && result != histogram_size_k - 1)
+        {
+            nanoseconds >>= 1;
+
+            ++result;
+        }
+
+        return result;
+    }
+
+#ifdef ADOBE_STD_SERIALIZATION
+    /// one line per command: count, mean and largest payload, mean and largest latency
+    inline friend std::ostream& operator<<(std::ostream& s, const muldex_statistics_t& x)
+    {
+        typedef std::chrono::duration<double, std::micro> microseconds;
+
+        for (const_iterator iter(x.begin()), last(x.end()); iter != last; ++iter)
+        {
+            const record_t& record(iter->second);
+
+            s << iter->first << ": " << record.count_m
+              << " payload " << static_cast<double>(record.payload_total_m) / record.count_m
+              << " (max " << record.payload_max_m << ")"
+              << " latency " << microseconds(record.latency_total_m).count() / record.count_m
+              << "us (max " << microseconds(record.latency_max_m).count() << "us)" << std::endl;
+        }
+
+        return s;
+    }
+#endif
+
+private:
+    record_set_t           record_set_m;
+    clock_type::time_point start_m;
+};
+
+/******************************************************************************/
+
+} // namespace adobe
+
+/******************************************************************************/
+// ADOBE_MULDEX_STATISTICS_HPP
+#endif
+/******************************************************************************/
@@ -12,6 +12,7 @@
 
 #include <boost/concept_check.hpp>
 
+#include <utility>
 #include <vector>
 
 #include <adobe/sequence_model_fwd.hpp>
@@ -65,6 +66,16 @@ inline void push_back(SM&                                                 v,
                       const typename sequence_model_value_type<SM>::type& x)
 { v.push_back(x); }
 
+/*!
+    \ingroup sequence_model_concept
+
+    \brief SequenceModel concept requirement.
+*/
+template <class SM> // SM models SequenceModel
+inline void push_back(SM&                                            v,
+                      typename sequence_model_value_type<SM>::type&& x)
+{ v.push_back(std::move(x)); }
+
 /*!
     \ingroup sequence_model_concept
 
@@ -76,6 +87,17 @@ inline void set(SM&                                                 v,
                 const typename sequence_model_value_type<SM>::type& x)
 { v.set(key, x); }
 
+/*!
+    \ingroup sequence_model_concept
+
+    \brief SequenceModel concept requirement.
+*/
+template <class SM> // SM models SequenceModel
+inline void set(SM&                                            v,
+                typename sequence_model_key_type<SM>::type     key,
+                typename sequence_model_value_type<SM>::type&& x)
+{ v.set(key, std::move(x)); }
+
 /*!
     \ingroup sequence_model_concept
 
@@ -87,6 +109,17 @@ inline void insert_set(SM&
                        const std::vector<typename sequence_model_value_type<SM>::type>& x)
 { v.insert_set(before, x); }
 
+/*!
+    \ingroup sequence_model_concept
+
+    \brief SequenceModel concept requirement.
+*/
+template <class SM> // SM models SequenceModel
+inline void insert_set(SM&                                                    v,
+                       typename sequence_model_key_type<SM>::type             before,
+                       std::vector<typename sequence_model_value_type<SM>::type>&& x)
+{ v.insert_set(before, std::move(x)); }
+
 /*!
     \ingroup sequence_model_concept
 
@@ -98,6 +131,17 @@ inline void insert(SM&                                                 v,
                    const typename sequence_model_value_type<SM>::type& x)
 { v.insert(before, x); }
 
+/*!
+    \ingroup sequence_model_concept
+
+    \brief SequenceModel concept requirement.
+*/
+template <class SM> // SM models SequenceModel
+inline void insert(SM&                                            v,
+                   typename sequence_model_key_type<SM>::type     before,
+                   typename sequence_model_value_type<SM>::type&& x)
+{ v.insert(before, std::move(x)); }
+
 /*!
     \ingroup sequence_model_concept
 
@@ -148,6 +192,13 @@ struct SequenceModelConcept
         push_back(model, x);
     }
 
+    static void push_back(SequenceModel& model, value_type&& x)
+    {
+        using adobe::push_back;
+
+        push_back(model, std::move(x));
+    }
+
     static void set(SequenceModel& model, key_type key, const value_type& x)
     {
         using adobe::set;
@@ -155,6 +206,13 @@ struct SequenceModelConcept
         set(model, key, x);
     }
 
+    static void set(SequenceModel& model, key_type key, value_type&& x)
+    {
+        using adobe::set;
+
+        set(model, key, std::move(x));
+    }
+
     static void insert_set(SequenceModel& model, key_type before, const std::vector<value_type>& x)
     {
         using adobe::insert_set;
@@ -162,6 +220,13 @@ struct SequenceModelConcept
         insert_set(model, before, x);
     }
 
+    static void insert_set(SequenceModel& model, key_type before, std::vector<value_type>&& x)
+    {
+        using adobe::insert_set;
+
+        insert_set(model, before, std::move(x));
+    }
+
     static void insert(SequenceModel& model, key_type before, const value_type& x)
     {
         using adobe::insert;
@@ -169,6 +234,13 @@ struct SequenceModelConcept
         insert(model, before, x);
     }
 
+    static void insert(SequenceModel& model, key_type before, value_type&& x)
+    {
+        using adobe::insert;
+
+        insert(model, before, std::move(x));
+    }
+
     static void erase(SequenceModel& model, const std::vector<key_type>& x)
     {
         using adobe::sequence_model_erase;
@@ -220,12 +292,16 @@ template <typename T>
 struct poly_sequence_model_interface : poly_copyable_interface
 {
     virtual void push_back(const T& x) = 0;
+    virtual void push_back(T&& x) = 0;
 
     virtual void set(sequence_key<T> key, const T& value) = 0;
+    virtual void set(sequence_key<T> key, T&& value) = 0;
 
     virtual void insert_set(sequence_key<T> before, const std::vector<T>& value_set) = 0;
+    virtual void insert_set(sequence_key<T> before, std::vector<T>&& value_set) = 0;
 
     virtual void insert(sequence_key<T> before, const T& value) = 0;
+    virtual void insert(sequence_key<T> before, T&& value) = 0;
 
     virtual void erase(const std::vector<sequence_key<T> >& key_set) = 0;
 
@@ -258,16 +334,28 @@ struct poly_sequence_model_instance
 
         void push_back(const T& x)
         { SequenceModelConcept<V>::push_back(this->get(), x); }
+
+        void push_back(T&& x)
+        { SequenceModelConcept<V>::push_back(this->get(), std::move(x)); }
     
         void set(sequence_key<T> key, const T& x)
         { SequenceModelConcept<V>::set(this->get(), key, x); }
 
+        void set(sequence_key<T> key, T&& x)
+        { SequenceModelConcept<V>::set(this->get(), key, std::move(x)); }
+
         void insert_set(sequence_key<T> before, const std::vector<T>& value_set)
         { SequenceModelConcept<V>::insert_set(this->get(), before, value_set); }
 
+        void insert_set(sequence_key<T> before, std::vector<T>&& value_set)
+        { SequenceModelConcept<V>::insert_set(this->get(), before, std::move(value_set)); }
+
         void insert(sequence_key<T> before, const T& x)
         { SequenceModelConcept<V>::insert(this->get(), before, x); }
 
+        void insert(sequence_key<T> before, T&& x)
+        { SequenceModelConcept<V>::insert(this->get(), before, std::move(x)); }
+
         void erase(const std::vector<sequence_key<T> >& key_set)
         { SequenceModelConcept<V>::erase(this->get(), key_set); }
 
@@ -301,15 +389,43 @@ struct sequence_model_base : poly_base<poly_sequence_model_interface<T>,
     void push_back(const T& x)
     { this->interface_ref().push_back(x); }
 
+    void push_back(T&& x)
+    { this->interface_ref().push_back(std::move(x)); }
+
+    /*!
+        Constructs a T from args and hands it to the model as an rvalue,
+        so a model that takes rvalues stores it without a copy.
+    */
+    template <typename... Args>
+    void emplace_back(Args&&... args)
+    { this->interface_ref().push_back(T(std::forward<Args>(args)...)); }
+
     void set(sequence_key<T> key, const T& x)
     { this->interface_ref().set(key, x); }
 
+    void set(sequence_key<T> key, T&& x)
+    { this->interface_ref().set(key, std::move(x)); }
+
     void insert_set(sequence_key<T> before, const std::vector<T>& value_set)
     { this->interface_ref().insert_set(before, value_set); }
 
+    void insert_set(sequence_key<T> before, std::vector<T>&& value_set)
+    { this->interface_ref().insert_set(before, std::move(value_set)); }
+
     void insert(sequence_key<T> before, const T& x)
     { this->interface_ref().insert(before, x); }
 
+    void insert(sequence_key<T> before, T&& x)
+    { this->interface_ref().insert(before, std::move(x)); }
+
+    /*!
+        Constructs a T from args and hands it to the model as an rvalue,
+        so a model that takes rvalues stores it without a copy.
+    */
+    template <typename... Args>
+    void emplace(sequence_key<T> before, Args&&... args)
+    { this->interface_ref().insert(before, T(std::forward<Args>(args)...)); }
+
     void erase(const std::vector<sequence_key<T> >& key_set)
     { this->interface_ref().erase(key_set); }
 
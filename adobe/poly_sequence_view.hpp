@@ -34,7 +34,8 @@ namespace adobe {
 template <typename T>
 struct poly_sequence_view_interface : poly_copyable_interface
 {
-    typedef copy_on_write<T> cow_value_type;
+    typedef copy_on_write<T>                              cow_value_type;
+    typedef boost::function<cow_value_type (sequence_key<T>)> value_proc_t;
 
     virtual void refresh(sequence_key<T> index, cow_value_type value) = 0;
 
@@ -45,6 +46,18 @@ struct poly_sequence_view_interface : poly_copyable_interface
     virtual void erase(const std::vector<sequence_key<T> >& key_set) = 0;
 
     virtual void clear() = 0;
+
+    virtual void move(const std::vector<sequence_key<T> >& key_set, sequence_key<T> before) = 0;
+
+    virtual void move_range(const std::vector<sequence_key<T> >& run, sequence_key<T> before) = 0;
+
+    virtual void refresh_set(const std::vector<sequence_key<T> >& key_set,
+                             const value_proc_t&                 value_of) = 0;
+
+    virtual void refresh_range(const std::vector<sequence_key<T> >& run,
+                               const value_proc_t&                 value_of) = 0;
+
+    virtual void erase_range(const std::vector<sequence_key<T> >& run) = 0;
 };
 
 /******************************************************************************/
@@ -57,6 +70,7 @@ template <typename T>
 struct poly_sequence_view_instance
 {
     typedef typename poly_sequence_view_interface<T>::cow_value_type cow_value_type;
+    typedef typename poly_sequence_view_interface<T>::value_proc_t   value_proc_t;
 
     template <typename V>
     struct type : optimized_storage_type<V, poly_sequence_view_interface<T> >::type
@@ -87,6 +101,21 @@ struct poly_sequence_view_instance
 
         void clear()
         { SequenceViewConcept<V>::clear(this->get()); }
+
+        void move(const std::vector<sequence_key<T> >& key_set, sequence_key<T> before)
+        { SequenceViewConcept<V>::move(this->get(), key_set, before); }
+
+        void move_range(const std::vector<sequence_key<T> >& run, sequence_key<T> before)
+        { SequenceViewConcept<V>::move_range(this->get(), run, before); }
+
+        void refresh_set(const std::vector<sequence_key<T> >& key_set, const value_proc_t& value_of)
+        { SequenceViewConcept<V>::refresh_set(this->get(), key_set, value_of); }
+
+        void refresh_range(const std::vector<sequence_key<T> >& run, const value_proc_t& value_of)
+        { SequenceViewConcept<V>::refresh_range(this->get(), run, value_of); }
+
+        void erase_range(const std::vector<sequence_key<T> >& run)
+        { SequenceViewConcept<V>::erase_range(this->get(), run); }
     };
 };
 
@@ -104,6 +133,7 @@ struct sequence_view : poly_base<poly_sequence_view_interface<T>,
                       poly_sequence_view_instance<T>::template type> base_t;
 
     typedef typename poly_sequence_view_instance<T>::cow_value_type cow_value_type;
+    typedef typename poly_sequence_view_instance<T>::value_proc_t   value_proc_t;
 
     template <typename V>
     explicit sequence_view(const V& s) :
@@ -128,6 +158,21 @@ struct sequence_view : poly_base<poly_sequence_view_interface<T>,
 
     void clear()
     { this->interface_ref().clear(); }
+
+    void move(const std::vector<sequence_key<T> >& key_set, sequence_key<T> before)
+    { this->interface_ref().move(key_set, before); }
+
+    void move_range(const std::vector<sequence_key<T> >& run, sequence_key<T> before)
+    { this->interface_ref().move_range(run, before); }
+
+    void refresh_set(const std::vector<sequence_key<T> >& key_set, const value_proc_t& value_of)
+    { this->interface_ref().refresh_set(key_set, value_of); }
+
+    void refresh_range(const std::vector<sequence_key<T> >& run, const value_proc_t& value_of)
+    { this->interface_ref().refresh_range(run, value_of); }
+
+    void erase_range(const std::vector<sequence_key<T> >& run)
+    { this->interface_ref().erase_range(run); }
 };
 
 /******************************************************************************/
@@ -39,6 +39,38 @@ void attach_sequence_view_to_sequence_model(adobe::assemblage_t& assemblage,
                                    boost::ref(*poly_view)));
 }
 
+/******************************************************************************/
+/*!
+    Hooks an object that models the SequenceView concept to a sequence_model
+    through a window of count elements starting at position offset (see
+    sequence_model::attach_view.) The returned poly view is the one to
+    pass to sequence_model::set_view_window to scroll the window.
+*/
+template <typename SequenceModel, typename SequenceView>
+typename SequenceModel::poly_sequence_view_type&
+attach_sequence_view_to_sequence_model(adobe::assemblage_t&                       assemblage,
+                                       SequenceModel&                             model,
+                                       SequenceView&                              view,
+                                       typename SequenceModel::size_type          offset,
+                                       typename SequenceModel::size_type          count,
+                                       const typename SequenceModel::size_proc_t& size_proc =
+                                           typename SequenceModel::size_proc_t())
+{
+    typedef typename SequenceModel::poly_sequence_view_type sequence_view_type;
+
+    sequence_view_type* poly_view(new sequence_view_type(boost::ref(view)));
+
+    assemblage_cleanup_ptr(assemblage, poly_view);
+
+    model.attach_view(*poly_view, offset, count, size_proc);
+
+    assemblage.cleanup(boost::bind(&SequenceModel::detach_view,
+                                   boost::ref(model), 
+                                   boost::ref(*poly_view)));
+
+    return *poly_view;
+}
+
 /******************************************************************************/
 /*!
     Hooks an object that models the SequenceView concept to a sequence_model
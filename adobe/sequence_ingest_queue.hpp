@@ -0,0 +1,319 @@
+/*
+    Copyright 2013 Adobe
+    Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*/
+/******************************************************************************/
+
+#ifndef ADOBE_SEQUENCE_INGEST_QUEUE_HPP
+#define ADOBE_SEQUENCE_INGEST_QUEUE_HPP
+
+/******************************************************************************/
+
+#include <adobe/config.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/optional.hpp>
+
+#include <adobe/sequence_model.hpp>
+
+/******************************************************************************/
+
+namespace adobe {
+
+/******************************************************************************/
+/*!
+    sequence_ingest_queue is a thread-safe front end for a
+    sequence_model. Any number of producer threads may push mutations
+    into it concurrently, without locking; the thread that owns the
+    model then applies them in batches by calling apply(), each batch
+    inside a single model transaction, so the views see one coalesced
+    round of notifications per batch on the owning thread.
+
+    Mutations from one producer are applied in the order that producer
+    pushed them. Mutations from different producers interleave in the
+    order their pushes completed.
+
+    The wakeup proc, if set, is called from a producer thread whenever
+    the queue goes from having nothing for the model to having something
+    (and from apply() when it leaves work behind), so the owning thread
+    can schedule an apply() through its own event loop. Alternatively
+    the owning thread can call apply() at whatever cadence it likes, for
+    instance from a periodical_t.
+
+    Keys passed to insert, set and erase are resolved when the mutation
+    is applied; a key whose element has been erased by then is treated
+    the way sequence_model treats any stale key.
+
+    T need not be default constructible; erase() queues no value.
+*/
+template <typename T>
+class sequence_ingest_queue : boost::noncopyable
+{
+public:
+    typedef T                                 value_type;
+    typedef sequence_model<T>                 model_type;
+    typedef typename model_type::key_type     key_type;
+    typedef typename model_type::size_type    size_type;
+    typedef boost::function<void ()>          wakeup_proc_t;
+
+    explicit sequence_ingest_queue(model_type&          model,
+                                   const wakeup_proc_t& wakeup = wakeup_proc_t()) :
+        model_m(model),
+        wakeup_m(wakeup),
+        head_m(&stub_m),
+        tail_m(&stub_m),
+        pending_m(0)
+    {
+        stub_m.next_m.store(0, std::memory_order_relaxed);
+    }
+
+    ~sequence_ingest_queue()
+    {
+        // mutations not applied by now are dropped
+
+        while (node_t* node = pop())
+            delete node;
+    }
+
+    /*
+        The following may be called from any thread.
+    */
+
+    void push_back(const value_type& value)
+    { push(new node_t(push_back_k, key_type::nkey, value)); }
+
+    void push_back(value_type&& value)
+    { push(new node_t(push_back_k, key_type::nkey, std::move(value))); }
+
+    void insert(key_type before, const value_type& value)
+    { push(new node_t(insert_k, before, value)); }
+
+    void insert(key_type before, value_type&& value)
+    { push(new node_t(insert_k, before, std::move(value))); }
+
+    void set(key_type key, const value_type& value)
+    { push(new node_t(set_k, key, value)); }
+
+    void set(key_type key, value_type&& value)
+    { push(new node_t(set_k, key, std::move(value))); }
+
+    void erase(key_type key)
+    { push(new node_t(erase_k, key)); }
+
+    /// number of mutations pushed but not yet applied
+    size_type pending() const
+    { return pending_m.load(std::memory_order_acquire); }
+
+    /*
+        The following may only be called from the thread owning the model.
+    */
+
+    /*!
+        Applies up to max_count of the queued mutations to the model
+        inside one transaction and returns how many were applied.
+
+        If the model throws, the exception is passed on once the
+        transaction has been closed; a view throwing while it is closed
+        is passed on too, unless the model had already thrown. The mutations already taken off the
+        queue but not yet applied (the one that threw, and any erases
+        gathered ahead of it) are dropped; the rest stay queued for the
+        next apply().
+    */
+    size_type apply(size_type max_count = size_type(-1))
+    {
+        size_type count(0);
+
+        {
+            pending_guard_t                    pending(pending_m, count);
+            typename model_type::transaction_t transaction(model_m);
+
+            // Consecutive erases are gathered so the model is handed them
+            // as one key set.
+
+            std::vector<key_type> erase_set;
+
+            while (count != max_count)
+            {
+                std::unique_ptr<node_t> node(pop());
+
+                if (!node)
+                    break;
+
+                ++count;
+
+                if (node->command_m != erase_k && !erase_set.empty())
+                {
+                    model_m.erase(erase_set);
+
+                    erase_set.clear();
+                }
+
+                switch (node->command_m)
+                {
+                    case push_back_k: model_m.push_back(std::move(*node->value_m));          break;
+                    case insert_k:    model_m.insert(node->key_m, std::move(*node->value_m)); break;
+                    case set_k:       model_m.set(node->key_m, std::move(*node->value_m));    break;
+                    case erase_k:     erase_set.push_back(node->key_m);                       break;
+                }
+            }
+
+            if (!erase_set.empty())
+                model_m.erase(erase_set);
+        }
+
+        size_type remaining(pending_m.load(std::memory_order_acquire));
+
+        // Work remains either because max_count was hit or because a
+        // push is in flight; its producer may not call wakeup itself.
+
+        if (remaining != 0 && wakeup_m)
+            wakeup_m();
+
+        return count;
+    }
+
+private:
+    enum command_t
+    {
+        push_back_k,
+        insert_k,
+        set_k,
+        erase_k
+    };
+
+    struct node_t
+    {
+        node_t() :
+            command_m(push_back_k)
+        { }
+
+        node_t(command_t command, key_type key) :
+            command_m(command),
+            key_m(key)
+        { }
+
+        template <typename U>
+        node_t(command_t command, key_type key, U&& value) :
+            command_m(command),
+            key_m(key),
+            value_m(std::forward<U>(value))
+        { }
+
+        std::atomic<node_t*>        next_m;
+        command_t                   command_m;
+        key_type                    key_m;
+        boost::optional<value_type> value_m; // empty for erase_k and the stub
+    };
+
+    // takes the mutations popped by apply() off pending_m, even if the model throws
+
+    struct pending_guard_t : boost::noncopyable
+    {
+        pending_guard_t(std::atomic<size_type>& pending, const size_type& count) :
+            pending_m(pending),
+            count_m(count)
+        { }
+
+        ~pending_guard_t()
+        {
+            if (count_m != 0)
+                pending_m.fetch_sub(count_m, std::memory_order_acq_rel);
+        }
+
+        std::atomic<size_type>& pending_m;
+        const size_type&        count_m;
+    };
+
+    /*
+        An intrusive multiple producer, single consumer queue: producers
+        swing head_m to their node with one atomic exchange and then link
+        the previous head to it; the consumer follows the links from
+        tail_m. A producer preempted between the two steps delays the
+        consumer but never blocks other producers.
+    */
+    void push(node_t* node)
+    {
+        node->next_m.store(0, std::memory_order_relaxed);
+
+        // counted before it is linked so pending_m never undercounts
+        // what the consumer can see
+
+        bool was_idle(pending_m.fetch_add(1, std::memory_order_acq_rel) == 0);
+
+        node_t* prior(head_m.exchange(node, std::memory_order_acq_rel));
+
+        prior->next_m.store(node, std::memory_order_release);
+
+        if (was_idle && wakeup_m)
+            wakeup_m();
+    }
+
+    node_t* pop()
+    {
+        node_t* tail(tail_m);
+        node_t* next(tail->next_m.load(std::memory_order_acquire));
+
+        if (tail == &stub_m)
+        {
+            if (next == 0)
+                return 0;
+
+            tail_m = next;
+            tail = next;
+            next = next->next_m.load(std::memory_order_acquire);
+        }
+
+        if (next)
+        {
+            tail_m = next;
+
+            return tail;
+        }
+
+        // tail is the last linked node; it can only be handed out once
+        // something follows it, so the stub is put back behind it unless
+        // a producer is midway through a push.
+
+        if (tail != head_m.load(std::memory_order_acquire))
+            return 0;
+
+        stub_m.next_m.store(0, std::memory_order_relaxed);
+
+        node_t* prior(head_m.exchange(&stub_m, std::memory_order_acq_rel));
+
+        prior->next_m.store(&stub_m, std::memory_order_release);
+
+        next = tail->next_m.load(std::memory_order_acquire);
+
+        if (next == 0)
+            return 0;
+
+        tail_m = next;
+
+        return tail;
+    }
+
+    model_type&            model_m;
+    wakeup_proc_t          wakeup_m;
+    node_t                 stub_m;
+    std::atomic<node_t*>   head_m;
+    node_t*                tail_m;
+    std::atomic<size_type> pending_m;
+};
+
+/******************************************************************************/
+
+} // namespace adobe
+
+/******************************************************************************/
+// ADOBE_SEQUENCE_INGEST_QUEUE_HPP
+#endif
+/******************************************************************************/
@@ -10,7 +10,12 @@
 
 /******************************************************************************/
 
+#include <cassert>
+#include <exception>
+#include <iterator>
 #include <list>
+#include <memory>
+#include <utility>
 #include <vector>
 
 #ifdef ADOBE_STD_SERIALIZATION
@@ -18,6 +23,7 @@
 #endif
 
 #include <boost/bind.hpp>
+#include <boost/function.hpp>
 #include <boost/next_prior.hpp>
 #include <boost/operators.hpp>
 #include <boost/static_assert.hpp>
@@ -25,10 +31,15 @@
 #include <adobe/algorithm/copy.hpp>
 #include <adobe/algorithm/find.hpp>
 #include <adobe/algorithm/for_each.hpp>
+#include <adobe/closed_hash.hpp>
 #include <adobe/copy_on_write.hpp>
+#include <adobe/implementation/node_arena.hpp>
+#include <adobe/implementation/rank_tree.hpp>
 #include <adobe/poly_sequence_controller.hpp>
 #include <adobe/poly_sequence_view.hpp>
 #include <adobe/poly_sequence_model.hpp>
+#include <adobe/selection.hpp>
+#include <adobe/sequence_snapshot.hpp>
 #include <adobe/sequence_model_fwd.hpp>
 #include <adobe/typeinfo.hpp>
 
@@ -54,96 +65,420 @@ public:
     typedef typename poly_sequence_view<T>::type       poly_sequence_view_type;
     /// view_type for the sequence_model
     typedef typename poly_sequence_controller<T>::type poly_sequence_controller_type;
+    /// callback receiving the new size of the model for windowed views
+    typedef boost::function<void (size_type)>          size_proc_t;
+    /// read-only version of the model's contents, see snapshot()
+    typedef sequence_snapshot<cow_value_type>          snapshot_type;
 
-    BOOST_STATIC_ASSERT((sizeof(key_type) == sizeof(void*)));
+    /// how the sequence_model allocates the nodes holding its elements
+    enum allocation_t
+    {
+        /// each node is allocated from the heap on its own
+        heap_allocation,
+        /*!
+            nodes are carved in order out of chunks owned by the model,
+            which keeps elements inserted together close in memory. The
+            nodes freed by erase() are reused by later insertions; clear()
+            starts the model on fresh chunks and returns the old ones to
+            the heap whole.
+
+            Only the nodes are pooled. The values they hold are
+            copy_on_write instances whose payloads come from the heap as
+            with heap_allocation: a payload is shared with snapshots, views
+            and controllers, and may outlive the model that created it.
+        */
+        pooled_allocation
+    };
+
+    explicit sequence_model(allocation_t allocation = heap_allocation) :
+        arena_m(allocation == pooled_allocation ? new implementation::node_arena_t : 0),
+        storage_m(storage_allocator_type(arena_m.get())),
+        rank_m(storage_allocator_type(arena_m.get())),
+        snapshot_enabled_m(false),
+        generation_m(0),
+        transaction_depth_m(0),
+        transaction_cleared_m(false)
+    { }
 
     static cow_value_type at(key_type key)
     { return *key.value_m; }
 
     void push_back(const value_type& value)
-    {
-        storage_m.push_back(cow_value_type(value));
+    { push_back_cow(cow_value_type(value)); }
 
-        for_each(view_set_m, boost::bind(&poly_sequence_view_type::extend,
-                                         _1,
-                                         key_type::nkey,
-                                         key_type(*--storage_m.end()),
-                                         boost::cref(storage_m.back())));
-    }
+    void push_back(value_type&& value)
+    { push_back_cow(cow_value_type(std::move(value))); }
+
+    /*!
+        Constructs a value from args and appends it; the value is moved,
+        never copied, into storage.
+    */
+    template <typename... Args>
+    void emplace_back(Args&&... args)
+    { push_back_cow(cow_value_type(value_type(std::forward<Args>(args)...))); }
 
     void set(key_type key, const value_type& value)
+    { set_cow(key, cow_value_type(value)); }
+
+    void set(key_type key, value_type&& value)
+    { set_cow(key, cow_value_type(std::move(value))); }
+
+    void insert_set(key_type before, const std::vector<value_type>& value_set)
+    { insert_range(before, value_set.begin(), value_set.end()); }
+
+    void insert_set(key_type before, std::vector<value_type>&& value_set)
     {
-        if (!is_valid(key))
-            return;
+        insert_range(before,
+                     std::make_move_iterator(value_set.begin()),
+                     std::make_move_iterator(value_set.end()));
+    }
 
-        storage_iterator iter(iterator_for(key));
+    void insert(key_type before, const value_type& value)
+    { insert_cow(before, cow_value_type(value)); }
 
-        *iter = cow_value_type(value);
+    void insert(key_type before, value_type&& value)
+    { insert_cow(before, cow_value_type(std::move(value))); }
 
-        for_each(view_set_m, boost::bind(&poly_sequence_view_type::refresh,
-                                         _1,
-                                         key,
-                                         boost::cref(*iter)));
+    /*!
+        Constructs a value from args and inserts it before the element
+        referred to by before; the value is moved, never copied, into
+        storage.
+    */
+    template <typename... Args>
+    void emplace(key_type before, Args&&... args)
+    { insert_cow(before, cow_value_type(value_type(std::forward<Args>(args)...))); }
+
+    void erase(const std::vector<key_type>& key_set)
+    {
+        typedef typename std::vector<key_type>::const_iterator const_iterator;
+
+        std::vector<key_type> erased_key_set;
+
+        erased_key_set.reserve(key_set.size());
+
+        // Stale or foreign keys are not in the index; they are skipped
+        // and not forwarded to the views.
+
+        for (const_iterator iter(key_set.begin()), last(key_set.end());
+             iter != last; ++iter)
+        {
+            storage_iterator found(iterator_for(*iter));
+
+            if (found == storage_m.end())
+                continue;
+
+            unindex(*iter);
+
+            storage_m.erase(found);
+
+            erased_key_set.push_back(*iter);
+        }
+
+        if (erased_key_set.empty())
+            return;
+
+        notify_erase(erased_key_set);
     }
 
-    void insert_set(key_type before, const std::vector<value_type>& value_set)
+    void clear()
     {
-        storage_iterator before_iterator(iterator_for(before));
-        std::vector<key_type> extend_key_set;
+        /*
+            The containers are swapped out whole, onto a fresh arena if
+            the model pools its nodes. The old arena is told to discard
+            its blocks, so destroying the old containers at the end of
+            the scope does not put each node back on a free list, and its
+            chunks go back to the heap at once, after the containers.
+        */
+
+        std::unique_ptr<implementation::node_arena_t> arena(arena_m ?
+                                                            new implementation::node_arena_t :
+                                                            0);
+        storage_type storage(storage_allocator_type(arena.get()));
+        index_type   index;
+        rank_type    rank(storage_allocator_type(arena.get()));
+
+        arena_m.swap(arena);
+        storage_m.swap(storage);
+        index_m.swap(index);
+        rank_m.swap(rank);
+        persistent_m.clear();
+
+        if (arena)
+            arena->discard();
+
+        notify_clear();
+    }
 
-        for (typename std::vector<value_type>::const_iterator iter(value_set.begin()),
-             last(value_set.end()); iter != last; ++iter)
+    /*!
+        Erases every element whose position falls within the selection.
+        Each of the b boundaries of the selection is found through the
+        positional index, and only the k selected elements are visited,
+        so the erase takes O((b + k) log n).
+        The views receive a single erase notification (erase_range if the
+        selection is a single run.)
+    */
+    void erase_selection(const selection_t& selection)
+    {
+        run_set_t run_set;
+
+        selected_runs(selection, run_set);
+
+        std::vector<key_type> erased_key_set;
+
+        for (typename run_set_t::iterator iter(run_set.begin()), last(run_set.end());
+             iter != last; ++iter)
         {
-            storage_iterator result(storage_m.insert(before_iterator, cow_value_type(*iter)));
+            for (storage_iterator node(iter->first); node != iter->second; ++node)
+            {
+                erased_key_set.push_back(key_of(node));
+
+                unindex(erased_key_set.back());
+            }
 
-            extend_key_set.push_back(key_type(*result));
+            storage_m.erase(iter->first, iter->second);
         }
 
-        for_each(view_set_m, boost::bind(&poly_sequence_view_type::extend_set,
-                                         _1,
-                                         before,
-                                         extend_key_set));
+        if (erased_key_set.empty())
+            return;
+
+        notify_erase(erased_key_set, run_set.size() == 1);
     }
 
-    void insert(key_type before, const value_type& value)
+    /*!
+        Tells the views the current value of every element whose
+        position falls within the selection, with one refresh_range
+        notification per run of selected elements.
+    */
+    void refresh_selection(const selection_t& selection)
     {
-        storage_iterator result(storage_m.insert(iterator_for(before),
-                                                 cow_value_type(value)));
+        run_set_t run_set;
 
-        for_each(view_set_m, boost::bind(&poly_sequence_view_type::extend,
-                                         _1,
-                                         before,
-                                         key_type(*result),
-                                         boost::cref(*result)));
+        selected_runs(selection, run_set);
+
+        std::vector<key_type> run;
+
+        for (typename run_set_t::iterator iter(run_set.begin()), last(run_set.end());
+             iter != last; ++iter)
+        {
+            run.clear();
+
+            for (storage_iterator node(iter->first); node != iter->second; ++node)
+                run.push_back(key_of(node));
+
+            notify_refresh_set(run, true);
+        }
     }
 
-    void erase(const std::vector<key_type>& key_set)
+    /*!
+        Moves every element whose position falls within the selection
+        so they sit, in their current relative order, immediately
+        before the element referred to by before (or at the end of the
+        sequence if before is nkey.) If before is itself selected the
+        elements are moved before the first unselected element that
+        follows it. Keys remain valid across the move, and the views
+        receive a single move notification (move_range if the selection
+        is a single run.)
+    */
+    void move_selection(const selection_t& selection, key_type before)
     {
-        typedef typename std::vector<key_type>::const_iterator const_iterator;
+        run_set_t run_set;
 
-        for (const_iterator iter(key_set.begin()), last(key_set.end());
+        selected_runs(selection, run_set);
+
+        if (run_set.empty())
+            return;
+
+        storage_iterator target(iterator_for(before));
+
+        for (typename run_set_t::iterator iter(run_set.begin()), last(run_set.end());
              iter != last; ++iter)
-            storage_m.erase(iterator_for(*iter));
+            for (storage_iterator node(iter->first); node != iter->second; ++node)
+                if (node == target)
+                    target = iter->second;
 
-        for_each(view_set_m, boost::bind(&poly_sequence_view_type::erase,
-                                         _1,
-                                         boost::cref(key_set)));
+        before = target == storage_m.end() ? key_type::nkey : key_of(target);
+
+        std::vector<key_type> moved_key_set;
+
+        for (typename run_set_t::iterator iter(run_set.begin()), last(run_set.end());
+             iter != last; ++iter)
+            for (storage_iterator node(iter->first); node != iter->second; ++node)
+                moved_key_set.push_back(key_of(node));
+
+        // The runs are lifted out in order before any of them is put
+        // back; splicing them one by one could land a run inside the
+        // bounds of another whose end is the target.
+
+        storage_type moved(storage_m.get_allocator());
+
+        for (typename std::vector<key_type>::const_iterator iter(moved_key_set.begin()),
+             last(moved_key_set.end()); iter != last; ++iter)
+            unindex(*iter);
+
+        for (typename run_set_t::iterator iter(run_set.begin()), last(run_set.end());
+             iter != last; ++iter)
+            moved.splice(moved.end(), storage_m, iter->first, iter->second);
+
+        storage_iterator moved_first(moved.begin());
+
+        storage_m.splice(target, moved);
+
+        // reindexed back to front so each node's successor is indexed;
+        // the moved elements keep their generations, and so their keys
+
+        typename std::vector<key_type>::const_reverse_iterator moved_key(moved_key_set.rbegin());
+
+        for (storage_iterator node(target); node != moved_first; ++moved_key)
+            index(--node, moved_key->generation_m);
+
+        notify_move(moved_key_set, before, run_set.size() == 1);
     }
 
-    void clear()
+    size_type size() const { return storage_m.size(); }
+    bool      empty() const { return storage_m.empty(); }
+
+    /*!
+        Returns the zero-based position of the element referred to by
+        key, or size() if the key is nkey, stale or foreign. O(log n).
+    */
+    size_type position_of(key_type key) const
     {
-        storage_m.clear();
+        if (!is_valid(key))
+            return size();
 
-        for_each(view_set_m, boost::bind(&poly_sequence_view_type::clear,
-                                         _1));
+        typename index_type::const_iterator found(find_entry(key));
+
+        return found == index_m.end() ? size() : rank_m.rank(found->second.node_m);
+    }
+
+    /*!
+        Returns the key of the element at the zero-based position passed,
+        or nkey if the position is not less than size(). O(log n).
+    */
+    key_type key_at(size_type position) const
+    {
+        rank_node_t* node(rank_m.select(position));
+
+        return node ? key_of(node->value_m) : key_type::nkey;
+    }
+
+    /*!
+        Returns the current contents of the model as a snapshot_type, a
+        read-only sequence that later changes to the model leave as it
+        is. Snapshots share the element values with the model and may be
+        handed to, read on and destroyed on other threads while the
+        model keeps being mutated here.
+
+        The model maintains the structure snapshots are taken from only
+        once one has been asked for: the first call is O(n); after that
+        each call is O(1) and every insertion, erasure and set costs an
+        extra O(log n) expected.
+    */
+    snapshot_type snapshot() const
+    {
+        if (!snapshot_enabled_m)
+        {
+            persistent_m.assign(storage_m.begin(), storage_m.end());
+
+            snapshot_enabled_m = true;
+        }
+
+        return snapshot_type(persistent_m.root());
+    }
+
+    /*!
+        Opens a transaction. Until the matching commit_transaction the
+        model is mutated as usual but no view is notified; on commit the
+        views receive the smallest set of notifications that brings them
+        up to date: one erase for the surviving elements that were
+        removed, one extend_set per run of adjacent new elements (or an
+        extend if the run is a single element), and one refresh_set for
+        the surviving elements that were set (or a refresh if there is
+        only one.) A move is sent as the erase and extend_set it amounts
+        to. A clear during the transaction
+        is sent first. Transactions nest; only the outermost commit
+        notifies.
+    */
+    void begin_transaction()
+    { ++transaction_depth_m; }
+
+    /*!
+        Closes the transaction opened by the matching begin_transaction.
+    */
+    void commit_transaction()
+    {
+        assert(transaction_depth_m != 0);
+
+        if (--transaction_depth_m == 0)
+            flush_transaction();
     }
 
+    /*!
+        Scope guard that keeps a transaction open for its lifetime.
+
+        The commit on destruction notifies the views, and an exception
+        thrown by a view is passed on. If the guard is destroyed while an
+        exception is already propagating, the views are still brought up
+        to date, but anything they throw is dropped rather than ending
+        the program.
+    */
+    class transaction_t
+    {
+    public:
+        explicit transaction_t(sequence_model& model) :
+            model_m(model)
+        { model_m.begin_transaction(); }
+
+        ~transaction_t() noexcept(false)
+        {
+            if (!std::uncaught_exception())
+            {
+                model_m.commit_transaction();
+
+                return;
+            }
+
+            try
+            {
+                model_m.commit_transaction();
+            }
+            catch (...)
+            { }
+        }
+
+    private:
+        transaction_t(const transaction_t&);
+        transaction_t& operator=(const transaction_t&);
+
+        sequence_model& model_m;
+    };
+
     /*!
         Used to attach a poly_sequence_view_type to the sequence_model.
         Views into the model are notified of model changes through the
         concept requirements spelled out by the SequenceView concept.
     */
     void attach_view(poly_sequence_view_type& view);
+    /*!
+        Attaches a view that only sees the window of count elements
+        starting at position offset. On attach the view is sent the
+        contents of the window alone. From then on it is notified only
+        of the changes that alter what is inside the window: elements
+        scrolling in or out as the model changes arrive as extend and
+        erase notifications, and refreshes arrive only for elements in
+        the window. size_proc, if set, is called with the new size of
+        the model whenever it changes, so the view can size a
+        scrollbar.
+    */
+    void attach_view(poly_sequence_view_type& view,
+                     size_type                offset,
+                     size_type                count,
+                     const size_proc_t&       size_proc = size_proc_t());
+    /*!
+        Moves the window of a view attached with a window; the view is
+        sent the notifications that bring it to the new window.
+    */
+    void set_view_window(poly_sequence_view_type& view, size_type offset, size_type count);
     /*!
         Detaches the requested view from the sequence_model.
     */
@@ -164,14 +499,51 @@ public:
 private:
     #ifndef ADOBE_NO_DOCUMENTATION
 
-    typedef std::list<cow_value_type>       storage_type;
-    typedef typename storage_type::iterator storage_iterator;
+    typedef implementation::node_arena_allocator<cow_value_type> storage_allocator_type;
+    typedef std::list<cow_value_type, storage_allocator_type>    storage_type;
+    typedef typename storage_type::iterator                      storage_iterator;
+    typedef typename poly_sequence_view_interface<T>::value_proc_t value_proc_t;
+
+    /*
+        The positional index keeps one node per storage node, in storage
+        order, each of weight one; the rank of a node is the position of
+        its element.
+    */
+    typedef implementation::rank_tree<storage_iterator,
+                                      storage_allocator_type> rank_type;
+    typedef typename rank_type::node_t                        rank_node_t;
+
+    struct index_entry_t
+    {
+        rank_node_t* node_m;
+        std::size_t  generation_m;
+    };
+
+    /*
+        Maps the address a key refers to onto the positional index node
+        of the storage node that holds it, and the generation of the
+        element there. Every live node has an entry, so a key that is not
+        found, or whose generation differs, is either nkey, stale (its
+        element was erased, and the address perhaps reused) or foreign
+        (it came from another model).
+    */
+    typedef closed_hash_map<const cow_value_type*, index_entry_t> index_type;
 
     static bool is_valid(key_type k)
     { return k != key_type::nkey; }
 
-    size_type size() const { return storage_m.size(); }
-    bool      empty() const { return storage_m.empty(); }
+    typename index_type::const_iterator find_entry(key_type key) const
+    {
+        typename index_type::const_iterator found(index_m.find(key.value_m));
+
+        if (found != index_m.end() && found->second.generation_m != key.generation_m)
+            return index_m.end();
+
+        return found;
+    }
+
+    key_type key_of(storage_iterator iter) const
+    { return key_type(*iter, index_m.find(&*iter)->second.generation_m); }
 
     storage_iterator iterator_for(key_type key) const
     {
@@ -180,28 +552,602 @@ private:
         if (!is_valid(key))
             return storage.end();
 
-        // Ugh -- linear search through the list to find the key.
-        //
-        // REVISIT (fbrereto) : Is there any way to make this faster? Perhaps a
-        //                      cache of some kind to binary-search the key set,
-        //                      retrieving an iterator? Using table_index?
+        typename index_type::const_iterator found(find_entry(key));
 
-        for (storage_iterator iter(storage.begin()), last(storage.end());
-             iter != last; ++iter)
-            if (key_type(*iter) == key)
-                return iter;
+        return found == index_m.end() ? storage.end() : found->second.node_m->value_m;
+    }
+
+    storage_iterator iterator_at(size_type position) const
+    {
+        rank_node_t* node(rank_m.select(position));
+
+        return node ? node->value_m : const_cast<storage_type&>(storage_m).end();
+    }
+
+    typedef std::vector<std::pair<storage_iterator, storage_iterator> > run_set_t;
+
+    /*
+        Collects the maximal runs of storage selected by the selection.
+        Each boundary is located through the positional index, so the
+        cost depends on the number of boundaries and not on how far into
+        the sequence they lie.
+    */
+    void selected_runs(const selection_t& selection, run_set_t& run_set)
+    {
+        bool             inside(selection.start_selected());
+        storage_iterator last(storage_m.end());
+        storage_iterator run_first(storage_m.begin());
+
+        for (selection_t::const_iterator boundary(selection.begin()),
+             boundary_last(selection.end()); boundary != boundary_last; ++boundary)
+        {
+            storage_iterator iter(iterator_at(*boundary));
+
+            if (inside && run_first != iter)
+                run_set.push_back(std::make_pair(run_first, iter));
+
+            run_first = iter;
+            inside = !inside;
+        }
+
+        if (inside && run_first != last)
+            run_set.push_back(std::make_pair(run_first, last));
+    }
+
+    /*
+        Every view notification goes through one of the following. While
+        a transaction is open they only record enough to compute the
+        batched notifications sent by flush_transaction.
+    */
+
+    void notify_refresh(key_type key, const cow_value_type& value)
+    {
+        if (transaction_depth_m != 0)
+        {
+            if (transaction_inserted_m.count(key.value_m) == 0)
+                transaction_refreshed_m.push_back(key);
+
+            return;
+        }
+
+        for_each(view_set_m, boost::bind(&poly_sequence_view_type::refresh,
+                                         _1,
+                                         key,
+                                         boost::cref(value)));
+
+        if (window_set_m.empty())
+            return;
+
+        size_type position(position_of(key));
+
+        for (typename window_set_t::iterator iter(window_set_m.begin()),
+             last(window_set_m.end()); iter != last; ++iter)
+            if (iter->offset_m <= position && position - iter->offset_m < iter->count_m)
+                iter->view_m->refresh(key, value);
+    }
+
+    /*
+        range is true if key_set is a run of adjacent elements, in which
+        case the views are sent refresh_range rather than refresh_set.
+        Windows are sent the part of key_set that falls inside them.
+    */
+    void notify_refresh_set(const std::vector<key_type>& key_set, bool range)
+    {
+        typedef typename std::vector<key_type>::const_iterator const_iterator;
+
+        if (transaction_depth_m != 0)
+        {
+            for (const_iterator iter(key_set.begin()), last(key_set.end()); iter != last; ++iter)
+                if (transaction_inserted_m.count(iter->value_m) == 0)
+                    transaction_refreshed_m.push_back(*iter);
+
+            return;
+        }
+
+        if (key_set.empty())
+            return;
+
+        const value_proc_t value_of(&sequence_model::at);
+
+        for_each(view_set_m, boost::bind(range ?
+                                             &poly_sequence_view_type::refresh_range :
+                                             &poly_sequence_view_type::refresh_set,
+                                         _1,
+                                         boost::cref(key_set),
+                                         boost::cref(value_of)));
+
+        if (window_set_m.empty())
+            return;
+
+        std::vector<size_type> position_set;
+
+        position_set.reserve(key_set.size());
+
+        for (const_iterator iter(key_set.begin()), last(key_set.end()); iter != last; ++iter)
+            position_set.push_back(position_of(*iter));
+
+        std::vector<key_type> window_key_set;
+
+        for (typename window_set_t::iterator window(window_set_m.begin()),
+             window_last(window_set_m.end()); window != window_last; ++window)
+        {
+            window_key_set.clear();
+
+            for (std::size_t i(0); i != key_set.size(); ++i)
+                if (window->offset_m <= position_set[i] &&
+                    position_set[i] - window->offset_m < window->count_m)
+                    window_key_set.push_back(key_set[i]);
+
+            if (window_key_set.empty())
+                continue;
+
+            if (range)
+                window->view_m->refresh_range(window_key_set, value_of);
+            else
+                window->view_m->refresh_set(window_key_set, value_of);
+        }
+    }
 
-        return storage.end();
+    void notify_extend(key_type before, key_type key, const cow_value_type& value)
+    {
+        if (transaction_depth_m != 0)
+        {
+            transaction_inserted_m.insert(key.value_m);
+
+            return;
+        }
+
+        for_each(view_set_m, boost::bind(&poly_sequence_view_type::extend,
+                                         _1,
+                                         before,
+                                         key,
+                                         boost::cref(value)));
+
+        sync_windows();
+    }
+
+    void notify_extend_set(key_type before, const std::vector<key_type>& key_set)
+    {
+        if (transaction_depth_m != 0)
+        {
+            for (typename std::vector<key_type>::const_iterator iter(key_set.begin()),
+                 last(key_set.end()); iter != last; ++iter)
+                transaction_inserted_m.insert(iter->value_m);
+
+            return;
+        }
+
+        for_each(view_set_m, boost::bind(&poly_sequence_view_type::extend_set,
+                                         _1,
+                                         before,
+                                         boost::cref(key_set)));
+
+        sync_windows();
+    }
+
+    /// range is true if key_set was a run of adjacent elements
+    void notify_erase(const std::vector<key_type>& key_set, bool range = false)
+    {
+        if (transaction_depth_m != 0)
+        {
+            // Elements both added and removed within the transaction
+            // are never seen by the views.
+
+            for (typename std::vector<key_type>::const_iterator iter(key_set.begin()),
+                 last(key_set.end()); iter != last; ++iter)
+                if (transaction_inserted_m.erase(iter->value_m) == 0)
+                    transaction_erased_m.push_back(*iter);
+
+            return;
+        }
+
+        for_each(view_set_m, boost::bind(range ?
+                                             &poly_sequence_view_type::erase_range :
+                                             &poly_sequence_view_type::erase,
+                                         _1,
+                                         boost::cref(key_set)));
+
+        sync_windows();
+    }
+
+    /*
+        The elements of key_set now sit before before; range is true if
+        they were a run of adjacent elements. Within a transaction a move
+        is recorded as the erase and extend it amounts to.
+    */
+    void notify_move(const std::vector<key_type>& key_set, key_type before, bool range)
+    {
+        if (transaction_depth_m != 0)
+        {
+            notify_erase(key_set);
+            notify_extend_set(before, key_set);
+
+            return;
+        }
+
+        for_each(view_set_m, boost::bind(range ?
+                                             &poly_sequence_view_type::move_range :
+                                             &poly_sequence_view_type::move,
+                                         _1,
+                                         boost::cref(key_set),
+                                         before));
+
+        sync_windows();
+    }
+
+    void notify_clear()
+    {
+        if (transaction_depth_m != 0)
+        {
+            transaction_cleared_m = true;
+            transaction_inserted_m.clear();
+            transaction_erased_m.clear();
+            transaction_refreshed_m.clear();
+
+            return;
+        }
+
+        for_each(view_set_m, boost::bind(&poly_sequence_view_type::clear,
+                                         _1));
+
+        for (typename window_set_t::iterator iter(window_set_m.begin()),
+             last(window_set_m.end()); iter != last; ++iter)
+        {
+            iter->view_m->clear();
+            iter->key_set_m.clear();
+        }
+
+        sync_windows();
+    }
+
+    /*
+        A view attached with a window, along with the keys it was last
+        told about, in order. The structural notifications bring each
+        window up to date by comparing those keys with the keys now in
+        the window, which costs O(log n + count) no matter how large the
+        model is or where the change took place.
+    */
+    struct window_t
+    {
+        poly_sequence_view_type* view_m;
+        size_type                offset_m;
+        size_type                count_m;
+        size_type                size_m;
+        size_proc_t              size_proc_m;
+        std::vector<key_type>    key_set_m;
+    };
+
+    typedef std::vector<window_t> window_set_t;
+
+    typename window_set_t::iterator find_window(const poly_sequence_view_type& view)
+    {
+        typename window_set_t::iterator iter(window_set_m.begin());
+        typename window_set_t::iterator last(window_set_m.end());
+
+        for (; iter != last; ++iter)
+            if (iter->view_m == &view)
+                break;
+
+        return iter;
+    }
+
+    void sync_windows()
+    {
+        for (typename window_set_t::iterator iter(window_set_m.begin()),
+             last(window_set_m.end()); iter != last; ++iter)
+            sync_window(*iter);
+    }
+
+    void sync_window(window_t& window)
+    {
+        std::vector<key_type> current;
+
+        for (storage_iterator iter(iterator_at(window.offset_m)), last(storage_m.end());
+             iter != last && current.size() < window.count_m; ++iter)
+            current.push_back(key_of(iter));
+
+        if (current != window.key_set_m)
+        {
+            typedef typename std::vector<key_type>::const_iterator const_iterator;
+
+            key_set_t old_set;
+            key_set_t current_set;
+
+            for (const_iterator iter(window.key_set_m.begin()),
+                 last(window.key_set_m.end()); iter != last; ++iter)
+                old_set.insert(*iter);
+
+            for (const_iterator iter(current.begin()), last(current.end()); iter != last; ++iter)
+                current_set.insert(*iter);
+
+            std::vector<key_type> erased_key_set;
+            std::vector<key_type> kept_old;
+            std::vector<key_type> kept_current;
+
+            for (const_iterator iter(window.key_set_m.begin()),
+                 last(window.key_set_m.end()); iter != last; ++iter)
+            {
+                if (current_set.count(*iter))
+                    kept_old.push_back(*iter);
+                else
+                    erased_key_set.push_back(*iter);
+            }
+
+            for (const_iterator iter(current.begin()), last(current.end()); iter != last; ++iter)
+                if (old_set.count(*iter))
+                    kept_current.push_back(*iter);
+
+            // Elements that stayed in the window but changed order (only
+            // possible through move_selection) cannot be expressed by
+            // extends alone, so the window is sent again from scratch.
+
+            if (kept_old != kept_current)
+            {
+                erased_key_set = window.key_set_m;
+                old_set.clear();
+            }
+
+            if (!erased_key_set.empty())
+                window.view_m->erase(erased_key_set);
+
+            // Each run of new elements is inserted before the element
+            // that follows it in the window, if the view knows it.
+
+            std::vector<key_type> run;
+
+            for (const_iterator iter(current.begin()), last(current.end()); ; ++iter)
+            {
+                bool at_end(iter == last);
+
+                if (!at_end && old_set.count(*iter) == 0)
+                {
+                    run.push_back(*iter);
+
+                    continue;
+                }
+
+                if (!run.empty())
+                {
+                    key_type before(at_end ? key_type::nkey : *iter);
+
+                    if (run.size() == 1)
+                        window.view_m->extend(before, run.front(), at(run.front()));
+                    else
+                        window.view_m->extend_set(before, run);
+
+                    run.clear();
+                }
+
+                if (at_end)
+                    break;
+            }
+
+            window.key_set_m.swap(current);
+        }
+
+        if (window.size_m != size())
+        {
+            window.size_m = size();
+
+            if (window.size_proc_m)
+                window.size_proc_m(window.size_m);
+        }
+    }
+
+    /*
+        Clears the transaction record and restores the depth when
+        flush_transaction returns or a view throws out of it.
+    */
+    class flush_guard_t
+    {
+    public:
+        explicit flush_guard_t(sequence_model& model) :
+            model_m(model),
+            depth_m(model.transaction_depth_m)
+        { model_m.transaction_depth_m = 0; }
+
+        ~flush_guard_t()
+        {
+            model_m.transaction_cleared_m = false;
+            model_m.transaction_inserted_m.clear();
+            model_m.transaction_erased_m.clear();
+            model_m.transaction_refreshed_m.clear();
+
+            model_m.transaction_depth_m = depth_m;
+        }
+
+    private:
+        flush_guard_t(const flush_guard_t&);
+        flush_guard_t& operator=(const flush_guard_t&);
+
+        sequence_model& model_m;
+        size_type       depth_m;
+    };
+
+    /*
+        Sends the notifications recorded since the transaction began and
+        resets the record. The depth is left alone so this can also be
+        used to bring the views up to date in the middle of one. If a
+        view throws, the rest of the record is dropped.
+    */
+    void flush_transaction()
+    {
+        flush_guard_t guard(*this);
+
+        if (transaction_cleared_m)
+            notify_clear();
+
+        if (!transaction_erased_m.empty())
+            notify_erase(transaction_erased_m);
+
+        // Each new element that does not follow another new element
+        // starts a run; the element after the run is either nkey or
+        // one the views already know about.
+
+        std::vector<key_type> run;
+
+        for (typename inserted_set_t::const_iterator iter(transaction_inserted_m.begin()),
+             last(transaction_inserted_m.end()); iter != last; ++iter)
+        {
+            storage_iterator node(index_m.find(*iter)->second.node_m->value_m);
+
+            if (node != storage_m.begin() &&
+                transaction_inserted_m.count(&*boost::prior(node)) != 0)
+                continue;
+
+            run.clear();
+
+            for (; node != storage_m.end() && transaction_inserted_m.count(&*node) != 0; ++node)
+                run.push_back(key_of(node));
+
+            key_type before(node == storage_m.end() ? key_type::nkey : key_of(node));
+
+            if (run.size() == 1)
+                notify_extend(before, run.front(), at(run.front()));
+            else
+                notify_extend_set(before, run);
+        }
+
+        closed_hash_set<const cow_value_type*> refreshed;
+        std::vector<key_type>                  refresh_key_set;
+
+        for (typename std::vector<key_type>::const_iterator iter(transaction_refreshed_m.begin()),
+             last(transaction_refreshed_m.end()); iter != last; ++iter)
+        {
+            storage_iterator node(iterator_for(*iter));
+
+            if (node == storage_m.end() ||
+                transaction_inserted_m.count(iter->value_m) != 0 ||
+                !refreshed.insert(iter->value_m).second)
+                continue;
+
+            refresh_key_set.push_back(*iter);
+        }
+
+        if (refresh_key_set.size() == 1)
+            notify_refresh(refresh_key_set.front(), at(refresh_key_set.front()));
+        else
+            notify_refresh_set(refresh_key_set, false);
+    }
+
+    void push_back_cow(cow_value_type&& value)
+    {
+        storage_m.push_back(std::move(value));
+
+        index(--storage_m.end());
+
+        notify_extend(key_type::nkey, key_of(--storage_m.end()), storage_m.back());
+    }
+
+    void set_cow(key_type key, cow_value_type&& value)
+    {
+        storage_iterator iter(iterator_for(key));
+
+        if (iter == storage_m.end())
+            return;
+
+        *iter = std::move(value);
+
+        if (snapshot_enabled_m)
+            persistent_m.set(position_of(key), *iter);
+
+        notify_refresh(key, *iter);
+    }
+
+    void insert_cow(key_type before, cow_value_type&& value)
+    {
+        storage_iterator before_iterator(iterator_for(before));
+
+        if (before_iterator == storage_m.end())
+            before = key_type::nkey;
+
+        storage_iterator result(storage_m.insert(before_iterator, std::move(value)));
+
+        index(result);
+
+        notify_extend(before, key_of(result), *result);
+    }
+
+    template <typename I> // I models InputIterator; value_type(*first) is a T
+    void insert_range(key_type before, I first, I last)
+    {
+        storage_iterator      before_iterator(iterator_for(before));
+        std::vector<key_type> extend_key_set;
+
+        if (before_iterator == storage_m.end())
+            before = key_type::nkey;
+
+        for (; first != last; ++first)
+        {
+            storage_iterator result(storage_m.insert(before_iterator, cow_value_type(*first)));
+
+            index(result);
+
+            extend_key_set.push_back(key_of(result));
+        }
+
+        notify_extend_set(before, extend_key_set);
+    }
+
+    /*
+        Indexes a node already in storage, as a new element; the node
+        that follows it, if any, must already be indexed.
+    */
+    void index(storage_iterator iter)
+    { index(iter, ++generation_m); }
+
+    void index(storage_iterator iter, std::size_t generation)
+    {
+        storage_iterator next(boost::next(iter));
+        rank_node_t*     before(next == storage_m.end() ?
+                                    0 :
+                                    index_m.find(&*next)->second.node_m);
+
+        rank_node_t*     node(rank_m.insert(before, iter));
+        index_entry_t    entry = { node, generation };
+
+        index_m.insert(typename index_type::value_type(&*iter, entry));
+
+        if (snapshot_enabled_m)
+            persistent_m.insert(rank_m.rank(node), *iter);
+    }
+
+    void unindex(key_type key)
+    {
+        typename index_type::iterator found(index_m.find(key.value_m));
+
+        if (snapshot_enabled_m)
+            persistent_m.erase(rank_m.rank(found->second.node_m));
+
+        rank_m.erase(found->second.node_m);
+
+        index_m.erase(found);
     }
 
     typedef std::vector<poly_sequence_view_type*>       view_set_t;
     typedef std::vector<poly_sequence_controller_type*> controller_set_t;
+    typedef closed_hash_set<const cow_value_type*>      inserted_set_t;
+    typedef closed_hash_set<key_type>                   key_set_t;
+    typedef implementation::persistent_sequence<cow_value_type> persistent_type;
 
+    std::unique_ptr<implementation::node_arena_t> arena_m; // null unless pooled; outlives the containers
     storage_type                           storage_m;
+    index_type                             index_m;
+    rank_type                              rank_m;
+    mutable persistent_type                persistent_m; // shadows storage_m once snapshots are taken
+    mutable bool                           snapshot_enabled_m;
+    std::size_t                            generation_m; // of the element last inserted
     view_set_t                             view_set_m;
+    window_set_t                           window_set_m;
     controller_set_t                       controller_set_m;
     auto_ptr<typename poly_sequence_model<T>::type> poly_m;
 
+    size_type                              transaction_depth_m;
+    bool                                   transaction_cleared_m;
+    inserted_set_t                         transaction_inserted_m;
+    std::vector<key_type>                  transaction_erased_m;
+    std::vector<key_type>                  transaction_refreshed_m;
+
     // ADOBE_NO_DOCUMENTATION
     #endif
 };
@@ -213,9 +1159,15 @@ void sequence_model<T>::attach_view(poly_sequence_view_type& view)
 {
 	typename view_set_t::iterator found(adobe::find(view_set_m, &view));
 
-    if (found != view_set_m.end())
+    if (found != view_set_m.end() || find_window(view) != window_set_m.end())
         return;
 
+    // bring the views already attached up to date so the new view
+    // does not see the pending changes twice
+
+    if (transaction_depth_m != 0)
+        flush_transaction();
+
     view_set_m.push_back(&view);
 
     view.clear();
@@ -229,22 +1181,85 @@ void sequence_model<T>::attach_view(poly_sequence_view_type& view)
 
     for (storage_iterator iter(storage_m.begin()), last(storage_m.end());
          iter != last; ++iter)
-        extend_key_set.push_back(key_type(*iter));
+        extend_key_set.push_back(key_of(iter));
 
     view.extend_set(key_type::nkey, extend_key_set);
 }
 
 /******************************************************************************/
 
+template <typename T>
+void sequence_model<T>::attach_view(poly_sequence_view_type& view,
+                                    size_type                offset,
+                                    size_type                count,
+                                    const size_proc_t&       size_proc)
+{
+    if (adobe::find(view_set_m, &view) != view_set_m.end() ||
+        find_window(view) != window_set_m.end())
+        return;
+
+    if (transaction_depth_m != 0)
+        flush_transaction();
+
+    window_t window;
+
+    window.view_m = &view;
+    window.offset_m = offset;
+    window.count_m = count;
+    window.size_m = size();
+    window.size_proc_m = size_proc;
+
+    window_set_m.push_back(window);
+
+    view.clear();
+
+    // only the contents of the window are sent
+
+    sync_window(window_set_m.back());
+
+    if (size_proc)
+        size_proc(size());
+}
+
+/******************************************************************************/
+
+template <typename T>
+void sequence_model<T>::set_view_window(poly_sequence_view_type& view,
+                                        size_type                offset,
+                                        size_type                count)
+{
+    typename window_set_t::iterator found(find_window(view));
+
+    if (found == window_set_m.end())
+        return;
+
+    if (transaction_depth_m != 0)
+        flush_transaction();
+
+    found->offset_m = offset;
+    found->count_m = count;
+
+    sync_window(*found);
+}
+
+/******************************************************************************/
+
 template <typename T>
 void sequence_model<T>::detach_view(poly_sequence_view_type& view)
 {
 	typename view_set_t::iterator found(adobe::find(view_set_m, &view));
 
-    if (found == view_set_m.end())
+    if (found != view_set_m.end())
+    {
+        view_set_m.erase(found);
+
         return;
+    }
+
+    typename window_set_t::iterator window(find_window(view));
 
-    view_set_m.erase(found);
+    if (window != window_set_m.end())
+        window_set_m.erase(window);
 }
 
 /******************************************************************************/
@@ -14,6 +14,9 @@
     #include <iostream>
 #endif
 
+#include <cstddef>
+
+#include <boost/functional/hash.hpp>
 #include <boost/operators.hpp>
 
 #include <adobe/copy_on_write.hpp>
@@ -43,34 +46,53 @@ public:
     static const sequence_key nkey;
 
     sequence_key() :
-        value_m(0)
+        value_m(0),
+        generation_m(0)
     { }
 
     sequence_key(const sequence_key& rhs) :
-        value_m(rhs.value_m)
+        value_m(rhs.value_m),
+        generation_m(rhs.generation_m)
     { }
 
     sequence_key& operator=(const sequence_key& rhs)
-    { value_m = rhs.value_m; return *this; }
+    { value_m = rhs.value_m; generation_m = rhs.generation_m; return *this; }
 
     inline friend bool operator==(const sequence_key& x, const sequence_key& y)
-    { return x.value_m == y.value_m; }
+    { return x.value_m == y.value_m && x.generation_m == y.generation_m; }
+
+    /// keys may be used in hashed containers (for instance closed_hash_map)
+    inline friend std::size_t hash_value(const sequence_key& key)
+    {
+        std::size_t result(boost::hash<const cow_value_type*>()(key.value_m));
+
+        boost::hash_combine(result, key.generation_m);
+
+        return result;
+    }
 
 private:
     friend class sequence_model<T>;
 
-    explicit sequence_key(cow_value_type& value) :
-        value_m(&value)
+    sequence_key(cow_value_type& value, std::size_t generation) :
+        value_m(&value),
+        generation_m(generation)
     { }
 
+    /*
+        The address of an element can be reused once it is erased, so a
+        key also carries the generation the model gave the element when
+        it was inserted; a key whose generation no longer matches is stale.
+    */
     cow_value_type* value_m;
+    std::size_t     generation_m;
 
 #ifdef ADOBE_STD_SERIALIZATION
     inline friend std::ostream& operator<<(std::ostream& s, const sequence_key& key)
     {
         return key == nkey ?
                s << "nkey" :
-               s << reinterpret_cast<std::size_t>(key.value_m);
+               s << reinterpret_cast<std::size_t>(key.value_m) << '.' << key.generation_m;
     }
 #endif
 };
@@ -10,9 +10,20 @@
 
 /******************************************************************************/
 
+#ifdef ADOBE_STD_SERIALIZATION
+    #include <iostream>
+#endif
+
+#include <boost/noncopyable.hpp>
+#include <boost/operators.hpp>
+#include <boost/shared_ptr.hpp>
 #include <boost/static_assert.hpp>
+#include <boost/weak_ptr.hpp>
 
+#include <adobe/copy_on_write.hpp>
 #include <adobe/function_pack.hpp>
+#include <adobe/future/behavior.hpp>
+#include <adobe/muldex_statistics.hpp>
 #include <adobe/sheet_hooks.hpp>
 #include <adobe/selection.hpp>
 #include <adobe/sequence_model.hpp>
@@ -21,7 +32,7 @@
 /******************************************************************************/
 
 namespace adobe {
-f
+
 /******************************************************************************/
 /*!
     OVERVIEW:
@@ -194,13 +205,69 @@ f
     my_sequence_controller.insert(1, 42); // calls proc passed to monitor_insert
     </pre>
 
+    ENCODING:
+
+    By default each command travels down the line as a single typed
+    record (a sequence_view_command or a sequence_model_command) inside
+    the cell's any_regular_t: the command is a tag, the parameters are
+    fields, and the bulky ones (values, key and value sets) are held
+    copy-on-write so the copies the sheet makes along the way are
+    cheap. Nothing is hashed or boxed per parameter, and the demux
+    dispatches on the tag with a switch.
+
+    The original encoding, one dictionary_t per command with the
+    command name under the key "command" and one entry per parameter,
+    is kept for compatibility with code that reads or writes the line
+    cells itself. Pass dictionary_muldex_encoding to the multiplexer (or
+    to the attach routines below) to select it. The demultiplexers
+    accept either encoding, whatever the multiplexer on the other end
+    of the line uses.
+
+    DELIVERY:
+
+    Every value put in a line cell costs a full update of the sheet, and
+    by default each command is followed by a second value that clears
+    the line (so that two identical commands in a row are both seen as
+    changes.) A multiplexer constructed with buffered_muldex_delivery
+    instead holds its commands and sends them as one batch
+    (a sequence_command_batch) when it is flushed: explicitly with
+    flush(), or on the next pass of its flush queue, which defaults to
+    general_deferred_proc_queue() and so runs once per trip through the
+    event loop. Each batch is numbered, so the line never needs
+    clearing: n commands cost one sheet update instead of 2n. The
+    receiving end sees the commands in the order they were made, only
+    later.
+
+    With deferred_muldex_delivery the commands are held the same way, but
+    the line is never written while another muldex line is delivering:
+    a flush asked for during a delivery (explicitly or by the flush
+    queue) is put off to the next pass of the queue, by which time the
+    sheet update that delivery started has finished. set_batch_limit()
+    bounds the number of commands a scheduled flush sends, leaving the
+    rest for the passes that follow, so a burst of commands is spread
+    over several trips through the event loop; pending() tells the
+    sending side how far behind the line is.
+
+    INSTRUMENTATION:
+
+    The demultiplexers returned by attach_sequence_view_to_model and
+    attach_sequence_model_controller_to_model take a muldex_statistics_t
+    (see muldex_statistics.hpp) with set_statistics(), in which they
+    record the number, payload sizes and dispatch latencies of the
+    commands they receive. The probes are always compiled in; while no
+    statistics are attached each one costs a test of a null pointer, and
+    the clock is never read.
+
     CAVEAT(S):
 
     The property model library (Adam) sheet implementation is not
-    reentrant. This means that you will not be able to supply cells for
-    both muldex lines on a single sheet, as setting one will trigger a
-    model update, thus attempting to set the other before the first
-    update has completed, and the reentrancy assertion will fail.
+    reentrant. This means that with immediate or buffered delivery you
+    will not be able to supply cells for both muldex lines on a single
+    sheet, as setting one will trigger a model update, thus attempting
+    to set the other before the first update has completed, and the
+    reentrancy assertion will fail. Multiplexers with
+    deferred_muldex_delivery on both lines can share a sheet, provided
+    their flush queue is not run from within a sheet update.
     From a design perspective, it is better to
     have these muldex line cells in the basic sheet instead of the
     property model sheet. The reason is that if they were in the
@@ -213,6 +280,702 @@ f
     an MVC system per dialog instance, and sharing them in the property
     model does not make sense.
 */
+/******************************************************************************/
+#if 0
+#pragma mark -
+#endif
+/******************************************************************************/
+/*!
+    How a multiplexer puts its commands on the line. See the ENCODING
+    section of the overview above.
+*/
+enum muldex_encoding_t
+{
+    /// one sequence_view_command or sequence_model_command per command
+    typed_muldex_encoding,
+    /// one dictionary_t per command, naming the command and its parameters
+    dictionary_muldex_encoding
+};
+
+/******************************************************************************/
+/*!
+    When a multiplexer puts its commands on the line. See the DELIVERY
+    section of the overview above.
+*/
+enum muldex_delivery_t
+{
+    /// each command is sent when it is made, then the line is cleared
+    immediate_muldex_delivery,
+    /// commands are held and sent as one batch when the multiplexer is flushed
+    buffered_muldex_delivery,
+    /// as buffered, but never sent while another muldex line is delivering
+    deferred_muldex_delivery
+};
+
+/******************************************************************************/
+/*!
+    A command sent down the model-to-view line. Only the fields used by
+    the command are set; the others keep their default values. A
+    default-constructed command (none_k) is ignored by the demultiplexer.
+*/
+template <typename T>
+struct sequence_view_command : boost::equality_comparable<sequence_view_command<T> >
+{
+    typedef T                                value_type;
+    typedef sequence_key<T>                  key_type;
+    typedef copy_on_write<T>                 cow_value_type;
+    typedef copy_on_write<vector<key_type> > cow_key_set_type;
+
+    enum command_t
+    {
+        none_k,
+        refresh_k,
+        extend_k,
+        extend_set_k,
+        erase_k,
+        clear_k
+    };
+
+    explicit sequence_view_command(command_t command = none_k) :
+        command_m(command)
+    { }
+
+    command_t        command_m;
+    key_type         before_m;
+    key_type         key_m;
+    cow_value_type   value_m;
+    cow_key_set_type key_set_m;
+
+    inline friend bool operator==(const sequence_view_command& x, const sequence_view_command& y)
+    {
+        return x.command_m == y.command_m &&
+               x.before_m == y.before_m &&
+               x.key_m == y.key_m &&
+               x.value_m == y.value_m &&
+               x.key_set_m == y.key_set_m;
+    }
+
+#ifdef ADOBE_STD_SERIALIZATION
+    inline friend std::ostream& operator<<(std::ostream& s, const sequence_view_command& x)
+    {
+        static const char* name_s[] = { "none", "refresh", "extend", "extend_set", "erase", "clear" };
+
+        return s << "sequence_view_command(" << name_s[x.command_m] << ")";
+    }
+#endif
+};
+
+/******************************************************************************/
+/*!
+    A command sent down the controller-to-model line. As with
+    sequence_view_command, only the fields used by the command are set
+    and a default-constructed command is ignored.
+*/
+template <typename T>
+struct sequence_model_command : boost::equality_comparable<sequence_model_command<T> >
+{
+    typedef T                                  value_type;
+    typedef sequence_key<T>                    key_type;
+    typedef copy_on_write<T>                   cow_value_type;
+    typedef copy_on_write<vector<value_type> > cow_value_set_type;
+    typedef copy_on_write<vector<key_type> >   cow_key_set_type;
+
+    enum command_t
+    {
+        none_k,
+        push_back_k,
+        set_k,
+        insert_k,
+        insert_set_k,
+        erase_k,
+        clear_k
+    };
+
+    explicit sequence_model_command(command_t command = none_k) :
+        command_m(command)
+    { }
+
+    command_t          command_m;
+    key_type           before_m;
+    key_type           key_m;
+    cow_value_type     value_m;
+    cow_value_set_type value_set_m;
+    cow_key_set_type   key_set_m;
+
+    inline friend bool operator==(const sequence_model_command& x, const sequence_model_command& y)
+    {
+        return x.command_m == y.command_m &&
+               x.before_m == y.before_m &&
+               x.key_m == y.key_m &&
+               x.value_m == y.value_m &&
+               x.value_set_m == y.value_set_m &&
+               x.key_set_m == y.key_set_m;
+    }
+
+#ifdef ADOBE_STD_SERIALIZATION
+    inline friend std::ostream& operator<<(std::ostream& s, const sequence_model_command& x)
+    {
+        static const char* name_s[] = { "none", "push_back", "set", "insert", "insert_set",
+                                        "erase", "clear" };
+
+        return s << "sequence_model_command(" << name_s[x.command_m] << ")";
+    }
+#endif
+};
+
+/******************************************************************************/
+/*!
+    The commands sent by a multiplexer with buffered_muldex_delivery (or
+    deferred_muldex_delivery) between two flushes, in order. sequence_m
+    counts the batches sent by the multiplexer, so no two batches in a
+    row compare equal.
+*/
+template <typename Command>
+struct sequence_command_batch : boost::equality_comparable<sequence_command_batch<Command> >
+{
+    typedef Command                         command_type;
+    typedef copy_on_write<vector<Command> > cow_command_set_type;
+
+    sequence_command_batch() :
+        sequence_m(0)
+    { }
+
+    std::size_t          sequence_m;
+    cow_command_set_type command_set_m;
+
+    inline friend bool operator==(const sequence_command_batch& x, const sequence_command_batch& y)
+    { return x.sequence_m == y.sequence_m && x.command_set_m == y.command_set_m; }
+
+#ifdef ADOBE_STD_SERIALIZATION
+    inline friend std::ostream& operator<<(std::ostream& s, const sequence_command_batch& x)
+    {
+        return s << "sequence_command_batch(" << x.sequence_m << ", "
+                 << x.command_set_m->size() << " command(s))";
+    }
+#endif
+};
+
+/******************************************************************************/
+
+#ifndef ADOBE_NO_DOCUMENTATION
+
+namespace implementation {
+
+/******************************************************************************/
+/*
+    The dictionary_muldex_encoding forms of the commands. These are the
+    dictionaries the muldex has always sent; a batch is a dictionary
+    naming the command "batch" and holding the dictionaries of its
+    commands, in order, in an array under "command_set".
+*/
+template <typename T>
+dictionary_t make_muldex_dictionary(const sequence_view_command<T>& command)
+{
+    typedef sequence_view_command<T> command_type;
+
+    dictionary_t result;
+
+    switch (command.command_m)
+    {
+        case command_type::refresh_k:
+            result["command"_name] = any_regular_t("refresh"_name);
+            result["key"_name] = any_regular_t(command.key_m);
+            result["value"_name] = any_regular_t(command.value_m);
+            break;
+        case command_type::extend_k:
+            result["command"_name] = any_regular_t("extend"_name);
+            result["before"_name] = any_regular_t(command.before_m);
+            result["key"_name] = any_regular_t(command.key_m);
+            result["value"_name] = any_regular_t(command.value_m);
+            break;
+        case command_type::extend_set_k:
+            result["command"_name] = any_regular_t("extend_set"_name);
+            result["before"_name] = any_regular_t(command.before_m);
+            result["key_set"_name] = any_regular_t(*command.key_set_m);
+            break;
+        case command_type::erase_k:
+            result["command"_name] = any_regular_t("erase"_name);
+            result["key_set"_name] = any_regular_t(*command.key_set_m);
+            break;
+        case command_type::clear_k:
+            result["command"_name] = any_regular_t("clear"_name);
+            break;
+        case command_type::none_k:
+            break;
+    }
+
+    return result;
+}
+
+template <typename T>
+dictionary_t make_muldex_dictionary(const sequence_model_command<T>& command)
+{
+    typedef sequence_model_command<T> command_type;
+
+    dictionary_t result;
+
+    switch (command.command_m)
+    {
+        case command_type::push_back_k:
+            result["command"_name] = any_regular_t("push_back"_name);
+            result["value"_name] = any_regular_t(*command.value_m);
+            break;
+        case command_type::set_k:
+            result["command"_name] = any_regular_t("set"_name);
+            result["key"_name] = any_regular_t(command.key_m);
+            result["value"_name] = any_regular_t(*command.value_m);
+            break;
+        case command_type::insert_k:
+            result["command"_name] = any_regular_t("insert"_name);
+            result["before"_name] = any_regular_t(command.before_m);
+            result["value"_name] = any_regular_t(*command.value_m);
+            break;
+        case command_type::insert_set_k:
+            result["command"_name] = any_regular_t("insert_set"_name);
+            result["before"_name] = any_regular_t(command.before_m);
+            result["value_set"_name] = any_regular_t(*command.value_set_m);
+            break;
+        case command_type::erase_k:
+            result["command"_name] = any_regular_t("erase"_name);
+            result["key_set"_name] = any_regular_t(*command.key_set_m);
+            break;
+        case command_type::clear_k:
+            result["command"_name] = any_regular_t("clear"_name);
+            break;
+        case command_type::none_k:
+            break;
+    }
+
+    return result;
+}
+
+template <typename Command>
+dictionary_t make_muldex_dictionary(const sequence_command_batch<Command>& batch)
+{
+    typedef typename vector<Command>::const_iterator const_iterator;
+
+    array_t command_set;
+
+    command_set.reserve(batch.command_set_m->size());
+
+    for (const_iterator iter(batch.command_set_m->begin()), last(batch.command_set_m->end());
+         iter != last; ++iter)
+        command_set.push_back(any_regular_t(make_muldex_dictionary(*iter)));
+
+    dictionary_t result;
+
+    result["command"_name] = any_regular_t("batch"_name);
+    result["sequence"_name] = any_regular_t(static_cast<double>(batch.sequence_m));
+    result["command_set"_name] = any_regular_t(command_set);
+
+    return result;
+}
+
+/******************************************************************************/
+/*
+    The names and payload sizes under which the demultiplexers record the
+    commands they receive in a muldex_statistics_t.
+*/
+template <typename T>
+name_t muldex_command_name(const sequence_view_command<T>& command)
+{
+    typedef sequence_view_command<T> command_type;
+
+    switch (command.command_m)
+    {
+        case command_type::refresh_k:    return "refresh"_name;
+        case command_type::extend_k:     return "extend"_name;
+        case command_type::extend_set_k: return "extend_set"_name;
+        case command_type::erase_k:      return "erase"_name;
+        case command_type::clear_k:      return "clear"_name;
+        case command_type::none_k:       break;
+    }
+
+    return name_t();
+}
+
+template <typename T>
+name_t muldex_command_name(const sequence_model_command<T>& command)
+{
+    typedef sequence_model_command<T> command_type;
+
+    switch (command.command_m)
+    {
+        case command_type::push_back_k:  return "push_back"_name;
+        case command_type::set_k:        return "set"_name;
+        case command_type::insert_k:     return "insert"_name;
+        case command_type::insert_set_k: return "insert_set"_name;
+        case command_type::erase_k:      return "erase"_name;
+        case command_type::clear_k:      return "clear"_name;
+        case command_type::none_k:       break;
+    }
+
+    return name_t();
+}
+
+template <typename Command>
+name_t muldex_command_name(const sequence_command_batch<Command>&)
+{ return "batch"_name; }
+
+template <typename T>
+std::size_t muldex_payload_size(const sequence_view_command<T>& command)
+{
+    typedef sequence_view_command<T> command_type;
+
+    switch (command.command_m)
+    {
+        case command_type::extend_set_k:
+        case command_type::erase_k:      return command.key_set_m->size();
+        case command_type::clear_k:
+        case command_type::none_k:       return 0;
+        default:                         return 1;
+    }
+}
+
+template <typename T>
+std::size_t muldex_payload_size(const sequence_model_command<T>& command)
+{
+    typedef sequence_model_command<T> command_type;
+
+    switch (command.command_m)
+    {
+        case command_type::insert_set_k: return command.value_set_m->size();
+        case command_type::erase_k:      return command.key_set_m->size();
+        case command_type::clear_k:
+        case command_type::none_k:       return 0;
+        default:                         return 1;
+    }
+}
+
+template <typename Command>
+std::size_t muldex_payload_size(const sequence_command_batch<Command>& batch)
+{ return batch.command_set_m->size(); }
+
+/*
+    The key_set and value_set of a dictionary command are held as the
+    vectors of keys and values of the line, which the receiving end
+    names with KeyType and ValueType.
+*/
+template <typename KeyType, typename ValueType>
+std::size_t muldex_payload_size(const dictionary_t& command)
+{
+    dictionary_t::const_iterator found(command.find("key_set"_name));
+
+    if (found == command.end())
+        found = command.find("value_set"_name);
+
+    if (found == command.end())
+        return get_value(command, "command"_name).cast<name_t>() == "clear"_name ? 0 : 1;
+
+    if (found->second.type_info() == adobe::type_info<vector<KeyType> >())
+        return found->second.cast<vector<KeyType> >().size();
+
+    if (found->second.type_info() == adobe::type_info<vector<ValueType> >())
+        return found->second.cast<vector<ValueType> >().size();
+
+    if (found->second.type_info() == adobe::type_info<array_t>())
+        return found->second.cast<array_t>().size();
+
+    return 1;
+}
+
+/******************************************************************************/
+/*
+    Times the dispatch of one command (or batch) for as long as it is in
+    scope and records it in the statistics passed, if there are any. The
+    name and payload size are only worked out when there are.
+*/
+class muldex_probe_t : boost::noncopyable
+{
+public:
+    template <typename Command>
+    muldex_probe_t(muldex_statistics_t* statistics, const Command& command) :
+        statistics_m(statistics),
+        payload_size_m(0)
+    {
+        if (statistics_m == 0)
+            return;
+
+        command_m = muldex_command_name(command);
+        payload_size_m = muldex_payload_size(command);
+        start_m = muldex_statistics_t::clock_type::now();
+    }
+
+    muldex_probe_t(muldex_statistics_t* statistics, name_t command, std::size_t payload_size) :
+        statistics_m(statistics),
+        command_m(command),
+        payload_size_m(payload_size)
+    {
+        if (statistics_m)
+            start_m = muldex_statistics_t::clock_type::now();
+    }
+
+    ~muldex_probe_t()
+    {
+        if (statistics_m)
+            statistics_m->record(command_m, payload_size_m,
+                                 muldex_statistics_t::clock_type::now() - start_m);
+    }
+
+private:
+    muldex_statistics_t*                        statistics_m;
+    name_t                                      command_m;
+    std::size_t                                 payload_size_m;
+    muldex_statistics_t::clock_type::time_point start_m;
+};
+
+/******************************************************************************/
+/*
+    Hands a dictionary_muldex_encoding command (or batch of them) to the
+    function pack holding the receiving end's routines. The empty
+    dictionary used to clear the line is ignored. KeyType and ValueType
+    are the key and value types of the line, used to size the payloads
+    recorded in the statistics (if any.)
+*/
+template <typename KeyType, typename ValueType>
+void dispatch_muldex_dictionary(const function_pack_t& funnel,
+                                const dictionary_t&    command,
+                                muldex_statistics_t*   statistics)
+{
+    if (command.empty())
+        return;
+
+    name_t name;
+
+    get_value(command, "command"_name, name);
+
+    if (name != "batch"_name)
+    {
+        muldex_probe_t probe(statistics, name,
+                             statistics ? muldex_payload_size<KeyType, ValueType>(command) : 0);
+
+        funnel(command);
+
+        return;
+    }
+
+    const array_t& command_set(get_value(command, "command_set"_name).cast<array_t>());
+
+    muldex_probe_t probe(statistics, name, command_set.size());
+
+    for (array_t::const_iterator iter(command_set.begin()), last(command_set.end());
+         iter != last; ++iter)
+        dispatch_muldex_dictionary<KeyType, ValueType>(funnel, iter->cast<dictionary_t>(),
+                                                       statistics);
+}
+
+/******************************************************************************/
+/*
+    Number of muldex lines currently delivering a value, over all the
+    senders. A deferred sender writes its line only when this is zero,
+    that is when no sheet update started by a muldex line is under way.
+*/
+inline std::size_t& muldex_delivery_depth()
+{
+    static std::size_t depth_s(0);
+
+    return depth_s;
+}
+
+/******************************************************************************/
+
+struct muldex_delivery_guard_t : boost::noncopyable
+{
+    muldex_delivery_guard_t()
+    { ++muldex_delivery_depth(); }
+
+    ~muldex_delivery_guard_t()
+    { --muldex_delivery_depth(); }
+};
+
+/******************************************************************************/
+/*
+    The sending end shared by the two multiplexers. It encodes the
+    commands it is given and puts them on the line, either one at a time
+    or, with buffered_muldex_delivery and deferred_muldex_delivery, as a
+    batch when flushed.
+
+    The flush scheduled on the flush queue only holds a weak reference
+    to the sender, so a sender destroyed before the queue runs (by a
+    verb earlier in the same queue, for instance) is simply skipped.
+*/
+template <typename Command>
+class muldex_sender : boost::noncopyable
+{
+public:
+    typedef Command                                   command_type;
+    typedef sequence_command_batch<Command>           batch_type;
+    typedef any_regular_t                             model_type;
+    typedef boost::function<void (const model_type&)> proc_type;
+
+    muldex_sender(muldex_encoding_t encoding, muldex_delivery_t delivery) :
+        encoding_m(encoding),
+        delivery_m(delivery),
+        flush_queue_m(delivery == immediate_muldex_delivery ? 0 : &general_deferred_proc_queue()),
+        flush_scheduled_m(false),
+        batch_count_m(0),
+        batch_limit_m(0),
+        self_m(new muldex_sender*(this))
+    { }
+
+    void monitor(const proc_type& proc)
+    { proc_m = proc; }
+
+    void set_flush_queue(behavior_t* queue)
+    {
+        flush_queue_m = queue;
+        flush_scheduled_m = false;
+
+        if (!pending_m.empty())
+            schedule_flush();
+    }
+
+    void set_batch_limit(std::size_t limit)
+    { batch_limit_m = limit; }
+
+    std::size_t pending() const
+    { return pending_m.size(); }
+
+    void send(const command_type& command)
+    {
+        if (!proc_m)
+            return;
+
+        if (delivery_m != immediate_muldex_delivery)
+        {
+            pending_m.push_back(command);
+
+            schedule_flush();
+
+            return;
+        }
+
+        muldex_delivery_guard_t guard;
+
+        // first we send the command
+        proc_m(encode(command));
+
+        // then we clear the line, so the next command is seen as a change
+        // even if it is identical to this one
+        if (encoding_m == dictionary_muldex_encoding)
+            proc_m(any_regular_t(dictionary_t()));
+        else
+            proc_m(any_regular_t());
+    }
+
+    void flush()
+    {
+        if (delivery_m == deferred_muldex_delivery && muldex_delivery_depth() != 0)
+            schedule_flush();
+        else
+            deliver(pending_m.size());
+    }
+
+private:
+    /// sends the first count pending commands as one batch
+    void deliver(std::size_t count)
+    {
+        if (count == 0 || !proc_m)
+            return;
+
+        batch_type batch;
+
+        batch.sequence_m = ++batch_count_m;
+
+        if (count == pending_m.size())
+        {
+            batch.command_set_m = typename batch_type::cow_command_set_type(std::move(pending_m));
+
+            pending_m.clear();
+        }
+        else
+        {
+            batch.command_set_m = typename batch_type::cow_command_set_type(
+                vector<command_type>(pending_m.begin(), pending_m.begin() + count));
+
+            pending_m.erase(pending_m.begin(), pending_m.begin() + count);
+        }
+
+        muldex_delivery_guard_t guard;
+
+        // the sequence number makes every batch a change; there is no need
+        // to clear the line after it
+
+        proc_m(encode(batch));
+    }
+
+    template <typename U>
+    model_type encode(const U& x) const
+    {
+        return encoding_m == dictionary_muldex_encoding ?
+                   any_regular_t(make_muldex_dictionary(x)) :
+                   any_regular_t(x);
+    }
+
+    void schedule_flush()
+    {
+        if (flush_scheduled_m || flush_queue_m == 0)
+            return;
+
+        flush_queue_m->insert(boost::bind(&muldex_sender::scheduled_flush,
+                                          boost::weak_ptr<muldex_sender*>(self_m)));
+
+        flush_scheduled_m = true;
+    }
+
+    static void scheduled_flush(const boost::weak_ptr<muldex_sender*>& self)
+    {
+        boost::shared_ptr<muldex_sender*> sender(self.lock());
+
+        if (!sender)
+            return;
+
+        muldex_sender& target(**sender);
+
+        target.flush_scheduled_m = false;
+
+        if (target.delivery_m == deferred_muldex_delivery && muldex_delivery_depth() != 0)
+        {
+            target.schedule_flush();
+
+            return;
+        }
+
+        std::size_t count(target.pending_m.size());
+
+        if (target.batch_limit_m != 0 && target.batch_limit_m < count)
+            count = target.batch_limit_m;
+
+        target.deliver(count);
+
+        // the delivery may have destroyed the sender, leaving this the
+        // only reference
+        if (sender.unique())
+            return;
+
+        // what is left over the limit goes on the next pass
+        if (!target.pending_m.empty())
+            target.schedule_flush();
+    }
+
+    proc_type                         proc_m;
+    muldex_encoding_t                 encoding_m;
+    muldex_delivery_t                 delivery_m;
+    behavior_t*                       flush_queue_m;
+    bool                              flush_scheduled_m;
+    std::size_t                       batch_count_m;
+    std::size_t                       batch_limit_m;
+    vector<command_type>              pending_m;
+    boost::shared_ptr<muldex_sender*> self_m;
+};
+
+/******************************************************************************/
+
+} // namespace implementation
+
+// ADOBE_NO_DOCUMENTATION
+#endif
+
 /******************************************************************************/
 #if 0
 #pragma mark -
@@ -224,108 +987,112 @@ f
     This structure is the glue between the sequence model and the
     property model. It models a sequence view and will receive view
     updates as such, at which point it bundles up (multiplexes, hence
-    the name) all the parameters it gets into a dictionary. The
-    dictionary is then piped out to the attached property model, of
-    which this structure is a controller to a particular cell. The
-    monitor callback routine will (under the hood) invoke an update of
-    the property model, causing the recently-pushed dictionary to be
-    propagated 'down the line' to the view waiting for it on the other
-    side (see the sequence_view_demultiplexer_t below.)
+    the name) all the parameters it gets into a single command, encoded
+    and delivered as selected at construction. The command is then
+    piped out to the attached property model, of which this structure is
+    a controller to a particular cell. The monitor callback routine will
+    (under the hood) invoke an update of the property model, causing the
+    recently-pushed command to be propagated 'down the line' to the view
+    waiting for it on the other side (see the
+    sequence_view_demultiplexer_t below.)
 */
 template <typename T>
-struct sequence_view_multiplexer
+struct sequence_view_multiplexer : boost::noncopyable
 {
     typedef T                                            value_type;
     typedef sequence_model<T>                            sequence_model_type;
     typedef typename sequence_model_type::key_type       key_type;
     typedef typename sequence_model_type::cow_value_type cow_value_type;
-    typedef dictionary_t                                 model_type;
+    typedef sequence_view_command<T>                     command_type;
+    typedef any_regular_t                                model_type;
     typedef boost::function<void (const model_type&)>    proc_type;
 
+    explicit sequence_view_multiplexer(muldex_encoding_t encoding = typed_muldex_encoding,
+                                       muldex_delivery_t delivery = immediate_muldex_delivery) :
+        sender_m(encoding, delivery)
+    { }
+
     void refresh(key_type key, cow_value_type value)
     {
-        if (proc_m == false)
-            return;
-
-        dictionary_t command;
+        command_type command(command_type::refresh_k);
 
-        command["command"_name] = any_regular_t("refresh"_name);
-        command["key"_name] = any_regular_t(key);
-        command["value"_name] = any_regular_t(value);
+        command.key_m = key;
+        command.value_m = value;
 
-        send(command);
+        sender_m.send(command);
     }
 
     void extend(key_type before, key_type key, cow_value_type value)
     {
-        if (proc_m == false)
-            return;
-
-        dictionary_t command;
+        command_type command(command_type::extend_k);
 
-        command["command"_name] = any_regular_t("extend"_name);
-        command["before"_name] = any_regular_t(before);
-        command["key"_name] = any_regular_t(key);
-        command["value"_name] = any_regular_t(value);
+        command.before_m = before;
+        command.key_m = key;
+        command.value_m = value;
 
-        send(command);
+        sender_m.send(command);
     }
 
     void extend_set(key_type before, const vector<key_type>& key_set)
     {
-        if (proc_m == false)
-            return;
+        command_type command(command_type::extend_set_k);
 
-        dictionary_t command;
+        command.before_m = before;
+        command.key_set_m = typename command_type::cow_key_set_type(key_set);
 
-        command["command"_name] = any_regular_t("extend_set"_name);
-        command["before"_name] = any_regular_t(before);
-        command["key_set"_name] = any_regular_t(key_set);
-
-        send(command);
+        sender_m.send(command);
     }
 
     void erase(const vector<key_type>& key_set)
     {
-        if (proc_m == false)
-            return;
-
-        dictionary_t command;
+        command_type command(command_type::erase_k);
 
-        command["command"_name] = any_regular_t("erase"_name);
-        command["key_set"_name] = any_regular_t(key_set);
+        command.key_set_m = typename command_type::cow_key_set_type(key_set);
 
-        send(command);
+        sender_m.send(command);
     }
 
     void clear()
-    {
-        if (proc_m == false)
-            return;
-
-        dictionary_t command;
-
-        command["command"_name] = any_regular_t("clear"_name);
-
-        send(command);
-    }
+    { sender_m.send(command_type(command_type::clear_k)); }
 
     void monitor(const proc_type& proc)
-    { proc_m = proc; }
+    { sender_m.monitor(proc); }
 
     void enable(bool) { }
 
-private:
-    void send(const adobe::dictionary_t& command)
-    {
-        // first we send the command
-        proc_m(command);
+    /*!
+        With buffered_muldex_delivery, sends the commands held so far as
+        one batch. With deferred_muldex_delivery the same, unless a
+        muldex line is delivering, in which case the flush is scheduled
+        on the flush queue instead. Otherwise there is nothing to flush.
+    */
+    void flush()
+    { sender_m.flush(); }
 
-        // then we send an empty dictionary to clear the line
-        proc_m(dictionary_t());
-    }
+    /*!
+        Sets the behavior on which a buffered or deferred multiplexer
+        schedules its next flush (general_deferred_proc_queue() by
+        default.) With a null queue the multiplexer is only flushed
+        explicitly.
+    */
+    void set_flush_queue(behavior_t* queue)
+    { sender_m.set_flush_queue(queue); }
+
+    /*!
+        Limits the number of commands sent by a scheduled flush; the
+        remainder is sent on the following passes of the flush queue.
+        Zero (the default) means no limit. Explicit flushes are not
+        limited.
+    */
+    void set_batch_limit(std::size_t limit)
+    { sender_m.set_batch_limit(limit); }
 
-    proc_type proc_m;
+    /// number of commands held for the next flush
+    std::size_t pending() const
+    { return sender_m.pending(); }
+
+private:
+    implementation::muldex_sender<command_type> sender_m;
 };
 
 /******************************************************************************/
@@ -334,17 +1101,17 @@ private:
 
     This structure is the glue between the property model and the
     client's sequence view. It will receive commands from the sequence
-    model through the property model cell in the form of dictionaries,
-    sent one at a time. The dictionaries are then farmed out
-    (demultiplexed, hence the name) to the various sequence view APIs as
-    provided by the client's implementation. The client actually using
+    model through the property model cell, sent one at a time in either
+    encoding. The commands are then farmed out (demultiplexed, hence the
+    name) to the various sequence view APIs as provided by the client's
+    implementation. The client actually using
     this piece of code really shouldn't know (or care) that this is
     under the hood - it is created by the helper routines below and
     bound to the assemblage, and then it should silently do its job.
 */
-struct sequence_view_demultiplexer_t
+struct sequence_view_demultiplexer_t : boost::noncopyable
 {
-    typedef dictionary_t model_type;
+    typedef any_regular_t model_type;
 
     /*!
         This constructor will take in anything that models the
@@ -355,7 +1122,10 @@ struct sequence_view_demultiplexer_t
         APIs.
     */
     template <typename T>
-    explicit sequence_view_demultiplexer_t(T& sequence_view)
+    explicit sequence_view_demultiplexer_t(T& sequence_view) :
+        dispatch_m(boost::bind(&sequence_view_demultiplexer_t::dispatch<T>,
+                               boost::ref(sequence_view), boost::cref(funnel_m), _1, _2)),
+        statistics_m(0)
     {
         typedef typename T::key_type key_type;
 
@@ -391,23 +1161,100 @@ struct sequence_view_demultiplexer_t
 
     /*!
         display here models the requirements of the property model View
-        concept, takes in an adobe::dictionary which is a wrapped set of
-        command parameters (one of which is the name of the command
-        itself). The command is immediately sent off to the function
-        pack, which will tease out the necessary bits, align parameters
-        to their specified locations, and fire off the underlying APIs
-        to the attached sequence view.
+        concept. A typed command is dispatched straight to the attached
+        sequence view. A dictionary (the compatibility encoding) is a
+        wrapped set of command parameters, one of which is the name of
+        the command itself; it is sent off to the function pack, which
+        will tease out the necessary bits, align parameters to their
+        specified locations, and fire off the underlying APIs to the
+        attached sequence view. Anything else, such as the value used to
+        clear the line, is ignored.
     */
     void display(const model_type& value)
+    { dispatch_m(value, statistics_m); }
+
+    /*!
+        Sets the statistics in which the commands received are recorded,
+        or stops the recording if statistics is null.
+    */
+    void set_statistics(muldex_statistics_t* statistics)
+    { statistics_m = statistics; }
+
+    muldex_statistics_t* statistics() const
+    { return statistics_m; }
+
+private:
+    template <typename T>
+    static void dispatch(T&                     sequence_view,
+                         const function_pack_t& funnel,
+                         const model_type&      value,
+                         muldex_statistics_t*   statistics)
     {
-        if (value == model_type())
-            return;
+        typedef sequence_view_command<typename T::value_type> command_type;
+        typedef sequence_command_batch<command_type>          batch_type;
+        typedef typename vector<command_type>::const_iterator const_iterator;
+
+        if (value.type_info() == adobe::type_info<command_type>())
+        {
+            const command_type& command(value.cast<command_type>());
+
+            implementation::muldex_probe_t probe(statistics, command);
+
+            dispatch_command(sequence_view, command);
+        }
+        else if (value.type_info() == adobe::type_info<batch_type>())
+        {
+            const batch_type& batch(value.cast<batch_type>());
+
+            implementation::muldex_probe_t probe(statistics, batch);
+
+            for (const_iterator iter(batch.command_set_m->begin()),
+                 last(batch.command_set_m->end()); iter != last; ++iter)
+            {
+                implementation::muldex_probe_t command_probe(statistics, *iter);
+
+                dispatch_command(sequence_view, *iter);
+            }
+        }
+        else if (value.type_info() == adobe::type_info<dictionary_t>())
+        {
+            implementation::dispatch_muldex_dictionary<typename T::key_type,
+                                                       typename T::value_type>(
+                funnel, value.cast<dictionary_t>(), statistics);
+        }
+    }
 
-        funnel_m(value);
+    template <typename T>
+    static void dispatch_command(T&                                                    sequence_view,
+                                 const sequence_view_command<typename T::value_type>& command)
+    {
+        typedef sequence_view_command<typename T::value_type> command_type;
+
+        switch (command.command_m)
+        {
+            case command_type::refresh_k:
+                sequence_view.refresh(command.key_m, command.value_m);
+                break;
+            case command_type::extend_k:
+                sequence_view.extend(command.before_m, command.key_m, command.value_m);
+                break;
+            case command_type::extend_set_k:
+                sequence_view.extend_set(command.before_m, *command.key_set_m);
+                break;
+            case command_type::erase_k:
+                sequence_view.erase(*command.key_set_m);
+                break;
+            case command_type::clear_k:
+                sequence_view.clear();
+                break;
+            case command_type::none_k:
+                break;
+        }
     }
 
-private:
-    function_pack_t funnel_m;
+    function_pack_t                                                  funnel_m;
+    boost::function<void (const model_type&, muldex_statistics_t*)> dispatch_m;
+    muldex_statistics_t*                                             statistics_m;
 };
 
 /******************************************************************************/
@@ -418,13 +1265,14 @@ private:
     the property model. Once this routine is complete your object will
     behave as a view of the specified cell of the property model passed,
     and thus by proxy a view of the sequence attached to the other side
-    of the cell specified.
+    of the cell specified. The demultiplexer is returned so statistics
+    can be attached to it.
 */
 template <typename SequenceView, typename Sheet>
-void attach_sequence_view_to_model(assemblage_t& assemblage,
-                                   Sheet&        model,
-                                   name_t        cell,
-                                   SequenceView& sequence_view)
+sequence_view_demultiplexer_t& attach_sequence_view_to_model(assemblage_t& assemblage,
+                                                             Sheet&        model,
+                                                             name_t        cell,
+                                                             SequenceView& sequence_view)
 {
     // This line asserts that sequence_view does in fact model a SequenceView concept.
     boost::function_requires<SequenceViewConcept<SequenceView> >();
@@ -434,6 +1282,8 @@ void attach_sequence_view_to_model(assemblage_t& assemblage,
     assemblage_cleanup_ptr(assemblage, demux);
 
     attach_view_to_model(assemblage, model, cell, *demux);
+
+    return *demux;
 }
 
 /******************************************************************************/
@@ -444,18 +1294,23 @@ void attach_sequence_view_to_model(assemblage_t& assemblage,
     Once this routine is complete the sequence model will behave as a
     controller of the specified cell of the property model passed, and
     thus by proxy a model to the sequence view attached to the other
-    side of the cell specified.
+    side of the cell specified. The commands are put on the line with
+    the encoding and delivery passed; the multiplexer is returned so a
+    buffered one can be flushed.
 */
 template <typename SequenceModel, typename Sheet>
-void attach_sequence_model_view_to_model(assemblage_t&  assemblage,
-                                         Sheet&         model,
-                                         name_t         cell,
-                                         SequenceModel& sequence_model)
+sequence_view_multiplexer<typename SequenceModel::value_type>&
+attach_sequence_model_view_to_model(assemblage_t&     assemblage,
+                                    Sheet&            model,
+                                    name_t            cell,
+                                    SequenceModel&    sequence_model,
+                                    muldex_encoding_t encoding = typed_muldex_encoding,
+                                    muldex_delivery_t delivery = immediate_muldex_delivery)
 {
     typedef typename SequenceModel::value_type                   value_type;
     typedef typename poly_sequence_view<value_type>::type poly_sequence_view_type;
 
-    sequence_view_multiplexer<value_type>* mux(new sequence_view_multiplexer<value_type>());
+    sequence_view_multiplexer<value_type>* mux(new sequence_view_multiplexer<value_type>(encoding, delivery));
 
     assemblage_cleanup_ptr(assemblage, mux);
 
@@ -470,6 +1325,8 @@ void attach_sequence_model_view_to_model(assemblage_t&  assemblage,
     assemblage.cleanup(boost::bind(&SequenceModel::detach_view,
                                    boost::ref(sequence_model),
                                    boost::ref(*poly_sequence_view)));
+
+    return *mux;
 }
 
 /******************************************************************************/
@@ -485,21 +1342,26 @@ void attach_sequence_model_view_to_model(assemblage_t&  assemblage,
     all the glue necessary.
 */
 template <typename SequenceModel, typename SequenceView, typename Sheet>
-void attach_sequence_view_muldex(SequenceModel&       sequence_model,
-                                 SequenceView&        sequence_view,
-                                 Sheet&               model,
-                                 name_t        cell,
-                                 assemblage_t& assemblage)
+sequence_view_multiplexer<typename SequenceModel::value_type>&
+attach_sequence_view_muldex(SequenceModel&    sequence_model,
+                            SequenceView&     sequence_view,
+                            Sheet&            model,
+                            name_t            cell,
+                            assemblage_t&     assemblage,
+                            muldex_encoding_t encoding = typed_muldex_encoding,
+                            muldex_delivery_t delivery = immediate_muldex_delivery)
 {
     attach_sequence_view_to_model(assemblage,
                                   model,
                                   cell,
                                   sequence_view);
 
-    attach_sequence_model_view_to_model(assemblage,
-                                        model,
-                                        cell,
-                                        sequence_model);
+    return attach_sequence_model_view_to_model(assemblage,
+                                               model,
+                                               cell,
+                                               sequence_model,
+                                               encoding,
+                                               delivery);
 }
 
 /******************************************************************************/
@@ -513,24 +1375,29 @@ void attach_sequence_view_muldex(SequenceModel&       sequence_model,
     This structure is the glue between the client's sequence controller
     and the property model. It models a sequence controller and will
     receive command as such, at which point it bundles up (multiplexes,
-    hence the name) all the parameters it gets into a dictionary. The
-    dictionary is then piped out to the attached property model, of
-    which this structure is a controller to a particular cell. The
-    monitor callback routine will (under the hood) invoke an update of
-    the property model, causing the recently-pushed dictionary to be
-    propagated 'down the line' to the acutal sequence model waiting for
-    it on the other side (see the sequence_model_demultiplexer below.)
+    hence the name) all the parameters it gets into a single command,
+    encoded and delivered as selected at construction. The command is
+    then piped out to the attached property model, of which this
+    structure is a controller to a particular cell. The monitor callback
+    routine will (under the hood) invoke an update of the property
+    model, causing the recently-pushed command to be propagated 'down
+    the line' to the acutal sequence model waiting for it on the other
+    side (see the sequence_model_demultiplexer below.)
 */
 template <typename T>
-struct sequence_model_multiplexer
+struct sequence_model_multiplexer : boost::noncopyable
 {
     typedef T                                         value_type;
     typedef adobe::sequence_key<T>                    key_type;
-    typedef dictionary_t                              model_type;
+    typedef sequence_model_command<T>                 command_type;
+    typedef any_regular_t                             model_type;
     typedef boost::function<void (const model_type&)> proc_type;
 
     template <typename SequenceController>
-    sequence_model_multiplexer(SequenceController& controller)
+    sequence_model_multiplexer(SequenceController& controller,
+                               muldex_encoding_t   encoding = typed_muldex_encoding,
+                               muldex_delivery_t   delivery = immediate_muldex_delivery) :
+        sender_m(encoding, delivery)
     {
         BOOST_STATIC_ASSERT((boost::is_same<T, typename sequence_controller_value_type<SequenceController>::type>::value));
 
@@ -545,104 +1412,97 @@ struct sequence_model_multiplexer
     
     void push_back(const value_type& value)
     {
-        if (proc_m == false)
-            return;
-
-        dictionary_t command;
+        command_type command(command_type::push_back_k);
 
-        command["command"_name] = any_regular_t("push_back"_name);
-        command["value"_name] = any_regular_t(value);
+        command.value_m = typename command_type::cow_value_type(value);
 
-        send(command);
+        sender_m.send(command);
     }
 
     void set(key_type key, const value_type& value)
     {
-        if (proc_m == false)
-            return;
+        command_type command(command_type::set_k);
 
-        dictionary_t command;
+        command.key_m = key;
+        command.value_m = typename command_type::cow_value_type(value);
 
-        command["command"_name] = any_regular_t("set"_name);
-        command["key"_name] = any_regular_t(key);
-        command["value"_name] = any_regular_t(value);
-
-        send(command);
+        sender_m.send(command);
     }
 
     void insert(key_type before, const value_type& value)
     {
-        if (proc_m == false)
-            return;
+        command_type command(command_type::insert_k);
 
-        dictionary_t command;
+        command.before_m = before;
+        command.value_m = typename command_type::cow_value_type(value);
 
-        command["command"_name] = any_regular_t("insert"_name);
-        command["before"_name] = any_regular_t(before);
-        command["value"_name] = any_regular_t(value);
-
-        send(command);
+        sender_m.send(command);
     }
 
     void insert_set(key_type before, const vector<value_type>& value_set)
     {
-        if (proc_m == false)
-            return;
-
-        dictionary_t command;
+        command_type command(command_type::insert_set_k);
 
-        command["command"_name] = any_regular_t("insert_set"_name);
-        command["before"_name] = any_regular_t(before);
-        command["value_set"_name] = any_regular_t(value_set);
+        command.before_m = before;
+        command.value_set_m = typename command_type::cow_value_set_type(value_set);
 
-        send(command);
+        sender_m.send(command);
     }
 
     void erase(const vector<key_type>& key_set)
     {
-        if (proc_m == false)
-            return;
-
-        dictionary_t command;
+        command_type command(command_type::erase_k);
 
-        command["command"_name] = any_regular_t("erase"_name);
-        command["key_set"_name] = any_regular_t(key_set);
+        command.key_set_m = typename command_type::cow_key_set_type(key_set);
 
-        send(command);
+        sender_m.send(command);
     }
 
     void clear()
-    {
-        if (proc_m == false)
-            return;
-
-        dictionary_t command;
-
-        command["command"_name] = any_regular_t("clear"_name);
-
-        send(command);
-    }
+    { sender_m.send(command_type(command_type::clear_k)); }
 
     /*
         The following are property_model_controller routines.
     */
     
     void monitor(const proc_type& proc)
-    { proc_m = proc; }
+    { sender_m.monitor(proc); }
 
     void enable(bool) { }
 
-private:
-    void send(const adobe::dictionary_t& command)
-    {
-        // first we send the command
-        proc_m(command);
+    /*!
+        With buffered_muldex_delivery, sends the commands held so far as
+        one batch. With deferred_muldex_delivery the same, unless a
+        muldex line is delivering, in which case the flush is scheduled
+        on the flush queue instead. Otherwise there is nothing to flush.
+    */
+    void flush()
+    { sender_m.flush(); }
 
-        // then we send an empty dictionary to clear the line
-        proc_m(dictionary_t());
-    }
+    /*!
+        Sets the behavior on which a buffered or deferred multiplexer
+        schedules its next flush (general_deferred_proc_queue() by
+        default.) With a null queue the multiplexer is only flushed
+        explicitly.
+    */
+    void set_flush_queue(behavior_t* queue)
+    { sender_m.set_flush_queue(queue); }
+
+    /*!
+        Limits the number of commands sent by a scheduled flush; the
+        remainder is sent on the following passes of the flush queue.
+        Zero (the default) means no limit. Explicit flushes are not
+        limited.
+    */
+    void set_batch_limit(std::size_t limit)
+    { sender_m.set_batch_limit(limit); }
 
-    proc_type                                       proc_m;
+    /// number of commands held for the next flush
+    std::size_t pending() const
+    { return sender_m.pending(); }
+
+private:
+    implementation::muldex_sender<command_type>     sender_m;
     auto_ptr<typename poly_sequence_model<T>::type> poly_m;
 };
 
@@ -652,10 +1512,9 @@ private:
 
     This structure is the glue between the property model and the
     sequence model. It will receive commands from the sequence
-    controller through the property model cell in the form of
-    dictionaries, sent one at a time. The dictionaries are then farmed
-    out (demultiplexed, hence the name) to the various sequence view
-    APIs as provided by the client's implementation. The client actually
+    controller through the property model cell, sent one at a time in
+    either encoding. The commands are then farmed out (demultiplexed,
+    hence the name) to the various sequence model APIs. The client actually
     using this piece of code really shouldn't know (or care) that this
     is under the hood - it is created by the helper routines below and
     bound to the assemblage, and then it should silently do its job.
@@ -663,50 +1522,93 @@ private:
 template <typename T>
 struct sequence_model_demultiplexer
 {
-    typedef T                      value_type;
-    typedef adobe::sequence_key<T> key_type;
-    typedef dictionary_t           model_type;
+    typedef T                         value_type;
+    typedef adobe::sequence_key<T>    key_type;
+    typedef sequence_model_command<T>            command_type;
+    typedef sequence_command_batch<command_type> batch_type;
+    typedef any_regular_t                        model_type;
 
     sequence_model_demultiplexer() :
-        sequence_m(0)
+        sequence_m(0),
+        statistics_m(0)
     { }
 
     /*!
-        display here models the requirements of the property model View concept,
-        takes in an adobe::dictionary which is a wrapped set of command
-        parameters (one of which is the name of the command itself). The command
-        is immediately sent off to the function pack, which will tease out the
-        necessary bits, align parameters to their specified locations, and fire
-        off the underlying APIs to the attached sequence view.
+        display here models the requirements of the property model View
+        concept. A typed command is dispatched straight to the attached
+        sequence model. A dictionary (the compatibility encoding) is a
+        wrapped set of command parameters, one of which is the name of
+        the command itself; it is sent off to the function pack, which
+        will tease out the necessary bits, align parameters to their
+        specified locations, and fire off the underlying APIs to the
+        attached sequence model. Anything else, such as the value used to
+        clear the line, is ignored.
     */
     void display(const model_type& value)
     {
-        if (value == model_type())
-            return;
-
-        funnel_m(value);
+        typedef typename vector<command_type>::const_iterator const_iterator;
+
+        if (value.type_info() == adobe::type_info<command_type>())
+        {
+            dispatch(value.cast<command_type>());
+        }
+        else if (value.type_info() == adobe::type_info<batch_type>())
+        {
+            const batch_type& batch(value.cast<batch_type>());
+
+            implementation::muldex_probe_t probe(statistics_m, batch);
+
+            for (const_iterator iter(batch.command_set_m->begin()),
+                 last(batch.command_set_m->end()); iter != last; ++iter)
+                dispatch(*iter);
+        }
+        else if (value.type_info() == adobe::type_info<dictionary_t>())
+        {
+            implementation::dispatch_muldex_dictionary<key_type, value_type>(
+                funnel_m, value.cast<dictionary_t>(), statistics_m);
+        }
     }
 
+    /*!
+        Sets the statistics in which the commands received are recorded,
+        or stops the recording if statistics is null.
+    */
+    void set_statistics(muldex_statistics_t* statistics)
+    { statistics_m = statistics; }
+
+    muldex_statistics_t* statistics() const
+    { return statistics_m; }
+
     void monitor_sequence(typename poly_sequence_model<T>::type& sequence)
     {
         sequence_m = &sequence;
 
+        // The model routines are overloaded on rvalues; the values come
+        // out of the command dictionary by const reference.
+
+        typedef sequence_model_base<T> base_type;
+
+        typedef void (base_type::*push_back_type)(const value_type&);
+        typedef void (base_type::*set_type)(key_type, const value_type&);
+        typedef void (base_type::*insert_type)(key_type, const value_type&);
+        typedef void (base_type::*insert_set_type)(key_type, const vector<value_type>&);
+
         funnel_m.register_function("push_back"_name,
-                                   boost::function<void (const value_type&)>(boost::bind(&poly_sequence_model<T>::type::push_back, boost::ref(*sequence_m), _1)),
+                                   boost::function<void (const value_type&)>(boost::bind(static_cast<push_back_type>(&poly_sequence_model<T>::type::push_back), boost::ref(*sequence_m), _1)),
                                    "value"_name);
 
         funnel_m.register_function("set"_name,
-                                   boost::function<void (key_type pos, const value_type&)>(boost::bind(&poly_sequence_model<T>::type::set, boost::ref(*sequence_m), _1, _2)),
+                                   boost::function<void (key_type pos, const value_type&)>(boost::bind(static_cast<set_type>(&poly_sequence_model<T>::type::set), boost::ref(*sequence_m), _1, _2)),
                                    "key"_name,
                                    "value"_name);
 
         funnel_m.register_function("insert"_name,
-                                   boost::function<void (key_type pos, const value_type&)>(boost::bind(&poly_sequence_model<T>::type::insert, boost::ref(*sequence_m), _1, _2)),
+                                   boost::function<void (key_type pos, const value_type&)>(boost::bind(static_cast<insert_type>(&poly_sequence_model<T>::type::insert), boost::ref(*sequence_m), _1, _2)),
                                    "before"_name,
                                    "value"_name);
 
         funnel_m.register_function("insert_set"_name,
-                                   boost::function<void (key_type pos, const vector<value_type>&)>(boost::bind(&poly_sequence_model<T>::type::insert_set, boost::ref(*sequence_m), _1, _2)),
+                                   boost::function<void (key_type pos, const vector<value_type>&)>(boost::bind(static_cast<insert_set_type>(&poly_sequence_model<T>::type::insert_set), boost::ref(*sequence_m), _1, _2)),
                                    "before"_name,
                                    "value_set"_name);
 
@@ -719,8 +1621,41 @@ struct sequence_model_demultiplexer
     }
 
 private:
+    void dispatch(const command_type& command)
+    {
+        if (sequence_m == 0)
+            return;
+
+        implementation::muldex_probe_t probe(statistics_m, command);
+
+        switch (command.command_m)
+        {
+            case command_type::push_back_k:
+                sequence_m->push_back(*command.value_m);
+                break;
+            case command_type::set_k:
+                sequence_m->set(command.key_m, *command.value_m);
+                break;
+            case command_type::insert_k:
+                sequence_m->insert(command.before_m, *command.value_m);
+                break;
+            case command_type::insert_set_k:
+                sequence_m->insert_set(command.before_m, *command.value_set_m);
+                break;
+            case command_type::erase_k:
+                sequence_m->erase(*command.key_set_m);
+                break;
+            case command_type::clear_k:
+                sequence_m->clear();
+                break;
+            case command_type::none_k:
+                break;
+        }
+    }
+
     typename poly_sequence_model<T>::type* sequence_m;
     function_pack_t                        funnel_m;
+    muldex_statistics_t*                   statistics_m;
 };
 
 /******************************************************************************/
@@ -731,13 +1666,18 @@ private:
     object and the property model. Once this routine is complete your
     object will behave as a controller of the specified cell of the
     property model passed, and thus by proxy a controller of the
-    sequence attached to the other side of the cell specified.
+    sequence attached to the other side of the cell specified. The
+    commands are put on the line with the encoding and delivery passed;
+    the multiplexer is returned so a buffered one can be flushed.
 */
 template <typename SequenceController, typename Sheet>
-void attach_sequence_controller_to_model(assemblage_t&       assemblage,
-                                         Sheet&              model,
-                                         name_t              cell,
-                                         SequenceController& sequence_controller)
+sequence_model_multiplexer<typename sequence_controller_value_type<SequenceController>::type>&
+attach_sequence_controller_to_model(assemblage_t&       assemblage,
+                                    Sheet&              model,
+                                    name_t              cell,
+                                    SequenceController& sequence_controller,
+                                    muldex_encoding_t   encoding = typed_muldex_encoding,
+                                    muldex_delivery_t   delivery = immediate_muldex_delivery)
 {
     // This line asserts that sequence_controller does in fact model a SequenceController concept.
     boost::function_requires<SequenceControllerConcept<SequenceController> >();
@@ -745,11 +1685,13 @@ void attach_sequence_controller_to_model(assemblage_t&       assemblage,
     typedef typename sequence_controller_value_type<SequenceController>::type value_type;
     typedef typename poly_sequence_controller<value_type>::type               poly_sequence_controller_type;
 
-    sequence_model_multiplexer<value_type>* mux(new sequence_model_multiplexer<value_type>(sequence_controller));
+    sequence_model_multiplexer<value_type>* mux(new sequence_model_multiplexer<value_type>(sequence_controller, encoding, delivery));
 
     assemblage_cleanup_ptr(assemblage, mux);
 
     attach_controller_to_model(assemblage, model, cell, *mux);
+
+    return *mux;
 }
 
 /******************************************************************************/
@@ -760,13 +1702,15 @@ void attach_sequence_controller_to_model(assemblage_t&       assemblage,
     Once this routine is complete the sequence model will behave as a
     view of the specified cell of the property model passed, and thus by
     proxy a model of the sequence controller attached to the other side
-    of the cell specified.
+    of the cell specified. The demultiplexer is returned so statistics
+    can be attached to it.
 */
 template <typename SequenceModel, typename Sheet>
-void attach_sequence_model_controller_to_model(assemblage_t&  assemblage,
-                                               Sheet&         model,
-                                               name_t         cell,
-                                               SequenceModel& sequence_model)
+sequence_model_demultiplexer<typename SequenceModel::value_type>&
+attach_sequence_model_controller_to_model(assemblage_t&  assemblage,
+                                          Sheet&         model,
+                                          name_t         cell,
+                                          SequenceModel& sequence_model)
 {
     typedef typename SequenceModel::value_type                  value_type;
     typedef typename poly_sequence_controller<value_type>::type poly_sequence_controller_type;
@@ -786,6 +1730,8 @@ void attach_sequence_model_controller_to_model(assemblage_t&  assemblage,
                                    boost::ref(*poly_sequence_controller)));
 
     attach_view_to_model(assemblage, model, cell, *demux);
+
+    return *demux;
 }
 
 /******************************************************************************/
@@ -802,21 +1748,29 @@ void attach_sequence_model_controller_to_model(assemblage_t&  assemblage,
     glue necessary.
 */
 template <typename SequenceModel, typename SequenceController, typename Sheet>
-void attach_sequence_controller_muldex(SequenceModel&      sequence_model,
-                                       SequenceController& sequence_controller,
-                                       Sheet&              model,
-                                       name_t              cell,
-                                       assemblage_t&       assemblage)
+sequence_model_multiplexer<typename SequenceModel::value_type>&
+attach_sequence_controller_muldex(SequenceModel&      sequence_model,
+                                  SequenceController& sequence_controller,
+                                  Sheet&              model,
+                                  name_t              cell,
+                                  assemblage_t&       assemblage,
+                                  muldex_encoding_t   encoding = typed_muldex_encoding,
+                                  muldex_delivery_t   delivery = immediate_muldex_delivery)
 {
-    attach_sequence_controller_to_model(assemblage,
-                                        model,
-                                        cell,
-                                        sequence_controller);
+    sequence_model_multiplexer<typename SequenceModel::value_type>&
+        mux(attach_sequence_controller_to_model(assemblage,
+                                                model,
+                                                cell,
+                                                sequence_controller,
+                                                encoding,
+                                                delivery));
 
     attach_sequence_model_controller_to_model(assemblage,
                                               model,
                                               cell,
                                               sequence_model);
+
+    return mux;
 }
 
 /******************************************************************************/
@@ -827,11 +1781,13 @@ void attach_sequence_controller_muldex(SequenceModel&      sequence_model,
     routine does that.
 */
 template <typename SequenceModel, typename Sheet>
-void attach_sequence_model_to_property_model(SequenceModel& sequence_model,
-                                             Sheet&         model,
-                                             name_t         view_line_cell,
-                                             name_t         controller_line_cell,
-                                             assemblage_t&  assemblage)
+void attach_sequence_model_to_property_model(SequenceModel&    sequence_model,
+                                             Sheet&            model,
+                                             name_t            view_line_cell,
+                                             name_t            controller_line_cell,
+                                             assemblage_t&     assemblage,
+                                             muldex_encoding_t encoding = typed_muldex_encoding,
+                                             muldex_delivery_t delivery = immediate_muldex_delivery)
 {
     attach_sequence_model_controller_to_model(assemblage,
                                               model,
@@ -841,7 +1797,9 @@ void attach_sequence_model_to_property_model(SequenceModel& sequence_model,
     attach_sequence_model_view_to_model(assemblage,
                                         model,
                                         view_line_cell,
-                                        sequence_model);
+                                        sequence_model,
+                                        encoding,
+                                        delivery);
 }
 
 /******************************************************************************/
@@ -852,16 +1810,20 @@ void attach_sequence_model_to_property_model(SequenceModel& sequence_model,
     routine does that.
 */
 template <typename SequenceWidget, typename Sheet>
-void attach_sequence_widget_to_property_model(SequenceWidget& sequence_widget,
-                                              Sheet&          model,
-                                              name_t          view_line_cell,
-                                              name_t          controller_line_cell,
-                                              assemblage_t&   assemblage)
+void attach_sequence_widget_to_property_model(SequenceWidget&   sequence_widget,
+                                              Sheet&            model,
+                                              name_t            view_line_cell,
+                                              name_t            controller_line_cell,
+                                              assemblage_t&     assemblage,
+                                              muldex_encoding_t encoding = typed_muldex_encoding,
+                                              muldex_delivery_t delivery = immediate_muldex_delivery)
 {
     attach_sequence_controller_to_model(assemblage,
                                         model,
                                         controller_line_cell,
-                                        sequence_widget);
+                                        sequence_widget,
+                                        encoding,
+                                        delivery);
 
     attach_sequence_view_to_model(assemblage,
                                   model,
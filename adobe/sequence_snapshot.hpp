@@ -0,0 +1,385 @@
+/*
+    Copyright 2013 Adobe
+    Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*/
+/******************************************************************************/
+
+#ifndef ADOBE_SEQUENCE_SNAPSHOT_HPP
+#define ADOBE_SEQUENCE_SNAPSHOT_HPP
+
+/******************************************************************************/
+
+#include <adobe/config.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/iterator/iterator_facade.hpp>
+#include <boost/shared_ptr.hpp>
+
+/******************************************************************************/
+
+namespace adobe {
+
+/******************************************************************************/
+
+namespace implementation {
+
+/******************************************************************************/
+/*
+    persistent_sequence is a sequence held in a randomized binary search
+    tree ordered by position, whose nodes are never modified once built.
+    Every update copies the O(log n) expected nodes on the path it
+    touches and shares the rest, so a copy of the root taken earlier
+    keeps seeing the sequence as it was. The root is the whole state of
+    a version, which makes taking one O(1).
+
+    Balance comes from randomized insertion and joining (Martinez and
+    Roura) rather than stored priorities, so the tree can be built
+    perfectly balanced from an existing sequence and kept balanced from
+    there.
+*/
+template <typename T>
+class persistent_sequence
+{
+public:
+    typedef T           value_type;
+    typedef std::size_t size_type;
+
+    struct node_t;
+
+    typedef boost::shared_ptr<const node_t> node_ptr;
+
+    struct node_t
+    {
+        node_t(const value_type& value, const node_ptr& left, const node_ptr& right) :
+            value_m(value),
+            left_m(left),
+            right_m(right),
+            size_m(1 + size(left) + size(right))
+        { }
+
+        value_type value_m;
+        node_ptr   left_m;
+        node_ptr   right_m;
+        size_type  size_m;
+    };
+
+    persistent_sequence() :
+        seed_m(2463534242UL)
+    { }
+
+    static size_type size(const node_ptr& node)
+    { return node ? node->size_m : 0; }
+
+    size_type size() const
+    { return size(root_m); }
+
+    const node_ptr& root() const
+    { return root_m; }
+
+    void clear()
+    { root_m.reset(); }
+
+    template <typename I> // I models ForwardIterator
+    void assign(I first, I last)
+    {
+        root_m = build(first, std::distance(first, last));
+    }
+
+    void insert(size_type position, const value_type& value)
+    {
+        assert(position <= size());
+
+        root_m = insert(root_m, position, value);
+    }
+
+    void erase(size_type position)
+    {
+        assert(position < size());
+
+        root_m = erase(root_m, position);
+    }
+
+    void set(size_type position, const value_type& value)
+    {
+        assert(position < size());
+
+        root_m = set(root_m, position, value);
+    }
+
+private:
+    static node_ptr make(const value_type& value, const node_ptr& left, const node_ptr& right)
+    { return node_ptr(new node_t(value, left, right)); }
+
+    template <typename I>
+    static node_ptr build(I& first, size_type count)
+    {
+        if (count == 0)
+            return node_ptr();
+
+        node_ptr left(build(first, count / 2));
+
+        const value_type& value(*first);
+
+        ++first;
+
+        node_ptr right(build(first, count - count / 2 - 1));
+
+        return make(value, left, right);
+    }
+
+    // true with probability n / d
+
+    bool chance(size_type n, size_type d)
+    {
+        seed_m ^= seed_m << 13;
+        seed_m ^= seed_m >> 17;
+        seed_m ^= seed_m << 5;
+
+        return seed_m % d < n;
+    }
+
+    static void split(const node_ptr& node, size_type position, node_ptr& left, node_ptr& right)
+    {
+        if (!node)
+        {
+            left.reset();
+            right.reset();
+
+            return;
+        }
+
+        size_type left_size(size(node->left_m));
+
+        if (position <= left_size)
+        {
+            node_ptr inner;
+
+            split(node->left_m, position, left, inner);
+
+            right = make(node->value_m, inner, node->right_m);
+        }
+        else
+        {
+            node_ptr inner;
+
+            split(node->right_m, position - left_size - 1, inner, right);
+
+            left = make(node->value_m, node->left_m, inner);
+        }
+    }
+
+    node_ptr join(const node_ptr& left, const node_ptr& right)
+    {
+        if (!left)
+            return right;
+
+        if (!right)
+            return left;
+
+        size_type left_size(left->size_m);
+
+        if (chance(left_size, left_size + right->size_m))
+            return make(left->value_m, left->left_m, join(left->right_m, right));
+
+        return make(right->value_m, join(left, right->left_m), right->right_m);
+    }
+
+    node_ptr insert(const node_ptr& node, size_type position, const value_type& value)
+    {
+        // the new node is the root of this subtree with probability 1/(n+1)
+
+        if (chance(1, size(node) + 1))
+        {
+            node_ptr left;
+            node_ptr right;
+
+            split(node, position, left, right);
+
+            return make(value, left, right);
+        }
+
+        size_type left_size(size(node->left_m));
+
+        if (position <= left_size)
+            return make(node->value_m, insert(node->left_m, position, value), node->right_m);
+
+        return make(node->value_m,
+                    node->left_m,
+                    insert(node->right_m, position - left_size - 1, value));
+    }
+
+    node_ptr erase(const node_ptr& node, size_type position)
+    {
+        size_type left_size(size(node->left_m));
+
+        if (position == left_size)
+            return join(node->left_m, node->right_m);
+
+        if (position < left_size)
+            return make(node->value_m, erase(node->left_m, position), node->right_m);
+
+        return make(node->value_m, node->left_m, erase(node->right_m, position - left_size - 1));
+    }
+
+    static node_ptr set(const node_ptr& node, size_type position, const value_type& value)
+    {
+        size_type left_size(size(node->left_m));
+
+        if (position == left_size)
+            return make(value, node->left_m, node->right_m);
+
+        if (position < left_size)
+            return make(node->value_m, set(node->left_m, position, value), node->right_m);
+
+        return make(node->value_m, node->left_m, set(node->right_m, position - left_size - 1, value));
+    }
+
+    node_ptr        root_m;
+    boost::uint32_t seed_m;
+};
+
+/******************************************************************************/
+
+} // namespace implementation
+
+/******************************************************************************/
+/*!
+    \ingroup sequence_mvc
+
+    \brief Read-only version of the contents of a sequence_model.
+
+    A sequence_snapshot is obtained in O(1) from
+    sequence_model::snapshot() and is unaffected by any later change to
+    the model. It shares its structure, and the copy_on_write values
+    themselves, with the model and with other snapshots. Snapshots may
+    be copied, read and destroyed on any thread, concurrently with the
+    owning thread mutating the model.
+*/
+template <typename CowValue> // CowValue is the model's cow_value_type
+class sequence_snapshot
+{
+    typedef implementation::persistent_sequence<CowValue> sequence_type;
+    typedef typename sequence_type::node_t                node_t;
+    typedef typename sequence_type::node_ptr              node_ptr;
+
+public:
+    typedef typename CowValue::value_type value_type;
+    typedef std::size_t                   size_type;
+
+    class const_iterator : public boost::iterator_facade<const_iterator,
+                                                         const value_type,
+                                                         std::forward_iterator_tag>
+    {
+    public:
+        const_iterator()
+        { }
+
+    private:
+        friend class sequence_snapshot;
+        friend class boost::iterator_core_access;
+
+        /*
+            The path from the root to the current node, holding only the
+            nodes still to be visited after it (those reached through a
+            left child).
+        */
+        explicit const_iterator(const node_t* root)
+        { descend(root); }
+
+        void descend(const node_t* node)
+        {
+            for (; node; node = node->left_m.get())
+                stack_m.push_back(node);
+        }
+
+        const value_type& dereference() const
+        { return *stack_m.back()->value_m; }
+
+        void increment()
+        {
+            const node_t* node(stack_m.back());
+
+            stack_m.pop_back();
+
+            descend(node->right_m.get());
+        }
+
+        bool equal(const const_iterator& x) const
+        {
+            return stack_m.empty() ?
+                       x.stack_m.empty() :
+                       !x.stack_m.empty() && stack_m.back() == x.stack_m.back();
+        }
+
+        std::vector<const node_t*> stack_m;
+    };
+
+    typedef const_iterator iterator;
+
+    sequence_snapshot()
+    { }
+
+    explicit sequence_snapshot(const node_ptr& root) :
+        root_m(root)
+    { }
+
+    size_type size() const
+    { return sequence_type::size(root_m); }
+
+    bool empty() const
+    { return !root_m; }
+
+    const_iterator begin() const
+    { return const_iterator(root_m.get()); }
+
+    const_iterator end() const
+    { return const_iterator(); }
+
+    /// the element at position n, in O(log n)
+    const value_type& operator[](size_type n) const
+    { return *at(n); }
+
+    /// the copy_on_write value at position n, in O(log n)
+    const CowValue& at(size_type n) const
+    {
+        assert(n < size());
+
+        const node_t* node(root_m.get());
+
+        while (true)
+        {
+            size_type left_size(sequence_type::size(node->left_m));
+
+            if (n == left_size)
+                return node->value_m;
+
+            if (n < left_size)
+            {
+                node = node->left_m.get();
+            }
+            else
+            {
+                n -= left_size + 1;
+                node = node->right_m.get();
+            }
+        }
+    }
+
+private:
+    node_ptr root_m; // keeps every node of this version alive
+};
+
+/******************************************************************************/
+
+} // namespace adobe
+
+/******************************************************************************/
+// ADOBE_SEQUENCE_SNAPSHOT_HPP
+#endif
+/******************************************************************************/
@@ -10,13 +10,16 @@
 
 /******************************************************************************/
 
+#include <utility>
 #include <vector>
 
 #include <boost/concept_check.hpp>
 #include <boost/function.hpp>
+#include <boost/type_traits/integral_constant.hpp>
 
 #include <adobe/copy_on_write.hpp>
 #include <adobe/selection.hpp>
+#include <adobe/sequence_model_fwd.hpp>
 
 /******************************************************************************/
 
@@ -111,6 +114,211 @@ template <class SV> // SV models SequenceView
 inline void clear(SV& v)
 { v.clear(); }
 
+/******************************************************************************/
+
+#ifndef ADOBE_NO_DOCUMENTATION
+
+namespace implementation {
+
+/******************************************************************************/
+/*
+    Detects which of the optional notifications a SequenceView
+    implements as member functions.
+*/
+template <class SV>
+struct sequence_view_members
+{
+    typedef typename sequence_view_key_type<SV>::type key_type;
+    typedef std::vector<key_type>                     key_set_t;
+
+    template <class U>
+    static char move_test(decltype(std::declval<U&>().move(std::declval<const key_set_t&>(),
+                                                             std::declval<key_type>()))*);
+    template <class U>
+    static long move_test(...);
+
+    template <class U>
+    static char move_range_test(decltype(std::declval<U&>().move_range(
+                                    std::declval<const key_set_t&>(),
+                                    std::declval<key_type>()))*);
+    template <class U>
+    static long move_range_test(...);
+
+    template <class U>
+    static char refresh_set_test(decltype(std::declval<U&>().refresh_set(
+                                     std::declval<const key_set_t&>()))*);
+    template <class U>
+    static long refresh_set_test(...);
+
+    template <class U>
+    static char refresh_range_test(decltype(std::declval<U&>().refresh_range(
+                                       std::declval<const key_set_t&>()))*);
+    template <class U>
+    static long refresh_range_test(...);
+
+    template <class U>
+    static char erase_range_test(decltype(std::declval<U&>().erase_range(
+                                     std::declval<const key_set_t&>()))*);
+    template <class U>
+    static long erase_range_test(...);
+
+    typedef boost::integral_constant<bool, sizeof(move_test<SV>(0)) == 1>          has_move;
+    typedef boost::integral_constant<bool, sizeof(move_range_test<SV>(0)) == 1>    has_move_range;
+    typedef boost::integral_constant<bool, sizeof(refresh_set_test<SV>(0)) == 1>   has_refresh_set;
+    typedef boost::integral_constant<bool, sizeof(refresh_range_test<SV>(0)) == 1> has_refresh_range;
+    typedef boost::integral_constant<bool, sizeof(erase_range_test<SV>(0)) == 1>   has_erase_range;
+};
+
+/******************************************************************************/
+/*
+    Each optional notification is sent to the member if there is one and
+    otherwise rewritten in terms of the notifications every SequenceView
+    has. The range forms fall back on their key set forms. A refresh is
+    sent with the value value_of returns for its key, so the fallback
+    needs nothing from the model sending it.
+*/
+
+template <class SV, class KeySet, class Key>
+inline void move_elements(SV& v, const KeySet& key_set, Key before, boost::true_type)
+{ v.move(key_set, before); }
+
+template <class SV, class KeySet, class Key>
+inline void move_elements(SV& v, const KeySet& key_set, Key before, boost::false_type)
+{
+    v.erase(key_set);
+    v.extend_set(before, key_set);
+}
+
+template <class SV, class KeySet, class Key>
+inline void move_range(SV& v, const KeySet& run, Key before, boost::true_type)
+{ v.move_range(run, before); }
+
+template <class SV, class KeySet, class Key>
+inline void move_range(SV& v, const KeySet& run, Key before, boost::false_type)
+{ move_elements(v, run, before, typename sequence_view_members<SV>::has_move()); }
+
+template <class SV, class KeySet, class F>
+inline void refresh_set(SV& v, const KeySet& key_set, const F&, boost::true_type)
+{ v.refresh_set(key_set); }
+
+template <class SV, class KeySet, class F>
+inline void refresh_set(SV& v, const KeySet& key_set, const F& value_of, boost::false_type)
+{
+    for (typename KeySet::const_iterator iter(key_set.begin()), last(key_set.end());
+         iter != last; ++iter)
+        v.refresh(*iter, value_of(*iter));
+}
+
+template <class SV, class KeySet, class F>
+inline void refresh_range(SV& v, const KeySet& run, const F&, boost::true_type)
+{ v.refresh_range(run); }
+
+template <class SV, class KeySet, class F>
+inline void refresh_range(SV& v, const KeySet& run, const F& value_of, boost::false_type)
+{ refresh_set(v, run, value_of, typename sequence_view_members<SV>::has_refresh_set()); }
+
+template <class SV, class KeySet>
+inline void erase_range(SV& v, const KeySet& run, boost::true_type)
+{ v.erase_range(run); }
+
+template <class SV, class KeySet>
+inline void erase_range(SV& v, const KeySet& run, boost::false_type)
+{ v.erase(run); }
+
+/******************************************************************************/
+
+} // namespace implementation
+
+// ADOBE_NO_DOCUMENTATION
+#endif
+
+/******************************************************************************/
+/*!
+    \ingroup sequence_view
+
+    \brief SequenceView concept optional notification: the elements of
+    key_set now sit, in that order, immediately before the element
+    referred to by before (or at the end of the sequence if before is
+    nkey.) Sent to the view's move member if it has one, and otherwise
+    as an erase followed by an extend_set.
+
+    Not named move, which would overload (and for some arguments be
+    preferred to) the adobe::move(first, last, out) algorithm.
+*/
+template <class SV> // SV models SequenceView
+inline void move_elements(SV&                                                           v,
+                          const std::vector<typename sequence_view_key_type<SV>::type>& key_set,
+                          typename sequence_view_key_type<SV>::type                     before)
+{
+    implementation::move_elements(v, key_set, before,
+                                  typename implementation::sequence_view_members<SV>::has_move());
+}
+
+/*!
+    \ingroup sequence_view
+
+    \brief SequenceView concept optional notification: as move_elements,
+    for a run of elements that were adjacent, in that order. Sent to
+    views without it as move_elements.
+*/
+template <class SV> // SV models SequenceView
+inline void move_range(SV&                                                           v,
+                       const std::vector<typename sequence_view_key_type<SV>::type>& run,
+                       typename sequence_view_key_type<SV>::type                     before)
+{
+    implementation::move_range(v, run, before,
+                               typename implementation::sequence_view_members<SV>::has_move_range());
+}
+
+/*!
+    \ingroup sequence_view
+
+    \brief SequenceView concept optional notification: the values of the
+    elements of key_set have changed. Sent to views without it as one
+    refresh per element, with the value value_of(key) returns.
+*/
+template <class SV, // SV models SequenceView
+          class F>  // F models UnaryFunction from key to cow value
+inline void refresh_set(SV&                                                           v,
+                        const std::vector<typename sequence_view_key_type<SV>::type>& key_set,
+                        const F&                                                      value_of)
+{
+    implementation::refresh_set(v, key_set, value_of,
+                                typename implementation::sequence_view_members<SV>::has_refresh_set());
+}
+
+/*!
+    \ingroup sequence_view
+
+    \brief SequenceView concept optional notification: as refresh_set,
+    for a run of adjacent elements in order. Sent to views without it
+    as a refresh_set.
+*/
+template <class SV, // SV models SequenceView
+          class F>  // F models UnaryFunction from key to cow value
+inline void refresh_range(SV&                                                           v,
+                          const std::vector<typename sequence_view_key_type<SV>::type>& run,
+                          const F&                                                      value_of)
+{
+    implementation::refresh_range(v, run, value_of,
+                                  typename implementation::sequence_view_members<SV>::has_refresh_range());
+}
+
+/*!
+    \ingroup sequence_view
+
+    \brief SequenceView concept optional notification: as erase, for a
+    run of adjacent elements in order. Sent to views without it as an
+    erase.
+*/
+template <class SV> // SV models SequenceView
+inline void erase_range(SV&                                                           v,
+                        const std::vector<typename sequence_view_key_type<SV>::type>& run)
+{
+    implementation::erase_range(v, run,
+                                typename implementation::sequence_view_members<SV>::has_erase_range());
+}
+
 /******************************************************************************/
 /*!
     \ingroup sequence_view
@@ -123,6 +331,8 @@ struct SequenceViewConcept
     /// key_type requirement for the SequenceViewConcept
     typedef typename sequence_view_key_type<SequenceView>::type       key_type; 
     typedef typename sequence_view_cow_value_type<SequenceView>::type cow_value_type; 
+    /// returns the current value of the element a key refers to
+    typedef boost::function<cow_value_type (key_type)>                value_proc_t;
 
     /// functional constraints for a model of the SequenceViewConcept
     void constraints()
@@ -181,6 +391,54 @@ struct SequenceViewConcept
         clear(view);
     }
 
+    /// notifes the SequenceView of elements having moved within the sequence
+    static void move(SequenceView&                view,
+                     const std::vector<key_type>& key_set,
+                     key_type                     before)
+    {
+        using adobe::move_elements;
+
+        move_elements(view, key_set, before);
+    }
+
+    /// notifes the SequenceView of a run of adjacent elements having moved
+    static void move_range(SequenceView&                view,
+                           const std::vector<key_type>& run,
+                           key_type                     before)
+    {
+        using adobe::move_range;
+
+        move_range(view, run, before);
+    }
+
+    /// notifes the SequenceView of changes to the values of elements
+    static void refresh_set(SequenceView&                view,
+                            const std::vector<key_type>& key_set,
+                            const value_proc_t&          value_of)
+    {
+        using adobe::refresh_set;
+
+        refresh_set(view, key_set, value_of);
+    }
+
+    /// notifes the SequenceView of changes to the values of a run of adjacent elements
+    static void refresh_range(SequenceView&                view,
+                              const std::vector<key_type>& run,
+                              const value_proc_t&          value_of)
+    {
+        using adobe::refresh_range;
+
+        refresh_range(view, run, value_of);
+    }
+
+    /// notifes the SequenceView of the elimination of a run of adjacent elements
+    static void erase_range(SequenceView& view, const std::vector<key_type>& run)
+    {
+        using adobe::erase_range;
+
+        erase_range(view, run);
+    }
+
 #ifndef ADOBE_NO_DOCUMENTATION
     SequenceView*    view;
     key_type         index;
@@ -0,0 +1,211 @@
+/*
+    Copyright 2013 Adobe
+    Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*/
+/******************************************************************************/
+
+#ifndef ADOBE_SORTED_SEQUENCE_MODEL_HPP
+#define ADOBE_SORTED_SEQUENCE_MODEL_HPP
+
+/******************************************************************************/
+
+#include <adobe/config.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include <boost/function.hpp>
+
+#include <adobe/implementation/derived_sequence_model.hpp>
+
+/******************************************************************************/
+
+namespace adobe {
+
+/******************************************************************************/
+/*!
+    \ingroup sequence_mvc
+
+    \brief The elements of a sequence_model ordered by a comparison.
+
+    A sorted_sequence_model is attached to its source as a SequenceView
+    (for instance with attach_sequence_view_to_sequence_model) and
+    serves as the model for any number of downstream views, which attach
+    to it the same way. Inserting, erasing or setting one element of the
+    source costs O(log n) comparisons; a set that leaves the element in
+    place is passed on as a refresh, one that moves it as an erase
+    followed by an extend.
+
+    Elements that compare equivalent stay in the order they reached the
+    sorted model, which for the contents of the source at attach time
+    (or when the comparison is changed) is the order of the source.
+
+    The keys the downstream views see are the keys of the source model.
+*/
+template <typename T>
+class sorted_sequence_model : public implementation::derived_sequence_model<T>
+{
+    typedef implementation::derived_sequence_model<T> base_type;
+    typedef typename base_type::node_t                node_t;
+    typedef typename base_type::tree_type             tree_type;
+    typedef typename base_type::entry_t               entry_t;
+
+public:
+    typedef typename base_type::value_type     value_type;
+    typedef typename base_type::size_type      size_type;
+    typedef typename base_type::cow_value_type cow_value_type;
+    typedef typename base_type::key_type       key_type;
+
+    typedef boost::function<bool (const value_type&, const value_type&)> compare_t;
+
+    explicit sorted_sequence_model(const compare_t& compare = std::less<value_type>()) :
+        compare_m(compare)
+    { }
+
+    const compare_t& compare() const
+    { return compare_m; }
+
+    void set_compare(const compare_t& compare);
+
+    /*
+        SequenceView requirements, called by the source model.
+    */
+
+    void refresh(key_type key, const cow_value_type& value)
+    {
+        node_t* node(this->node_for(key));
+
+        if (node == 0)
+            return;
+
+        node_t* prior(tree_type::prior(node));
+        node_t* next(tree_type::next(node));
+
+        if ((prior == 0 || !compare_m(*value, *prior->value_m.value_m)) &&
+            (next == 0 || !compare_m(*next->value_m.value_m, *value)))
+        {
+            node->value_m.value_m = value;
+
+            this->notify_refresh(key, value);
+
+            return;
+        }
+
+        this->remove(node);
+
+        this->notify_erase(std::vector<key_type>(1, key));
+
+        node = place(key, value);
+
+        this->notify_extend(this->visible_after(node), key, value);
+    }
+
+    void extend(key_type, key_type key, const cow_value_type& value)
+    {
+        node_t* node(place(key, value));
+
+        this->notify_extend(this->visible_after(node), key, value);
+    }
+
+    void extend_set(key_type, const std::vector<key_type>& key_set)
+    {
+        typedef typename std::vector<key_type>::const_iterator const_iterator;
+
+        std::vector<node_t*> shown;
+
+        shown.reserve(key_set.size());
+
+        for (const_iterator iter(key_set.begin()), last(key_set.end()); iter != last; ++iter)
+            shown.push_back(place(*iter, base_type::at(*iter)));
+
+        this->notify_shown(shown);
+    }
+
+    /// the source order plays no part in the sorted order
+    void move(const std::vector<key_type>&, key_type)
+    { }
+
+private:
+    /// true while an entry sorts at or before value
+    struct not_after_t
+    {
+        not_after_t(const compare_t& compare, const value_type& value) :
+            compare_m(compare),
+            value_m(value)
+        { }
+
+        bool operator()(const entry_t& entry) const
+        { return !compare_m(value_m, *entry.value_m); }
+
+        const compare_t&  compare_m;
+        const value_type& value_m;
+    };
+
+    struct entry_compare_t
+    {
+        explicit entry_compare_t(const compare_t& compare) :
+            compare_m(compare)
+        { }
+
+        bool operator()(const entry_t& x, const entry_t& y) const
+        { return compare_m(*x.value_m, *y.value_m); }
+
+        const compare_t& compare_m;
+    };
+
+    /// inserts after every element not sorting after value
+    node_t* place(key_type key, const cow_value_type& value)
+    {
+        node_t* before(this->tree_m.partition_point(not_after_t(compare_m, *value)));
+
+        return this->add(before, key, value, 1);
+    }
+
+    compare_t compare_m;
+};
+
+/******************************************************************************/
+
+template <typename T>
+void sorted_sequence_model<T>::set_compare(const compare_t& compare)
+{
+    compare_m = compare;
+
+    // Every position may change, so the views are sent the new order
+    // whole. Equivalent elements keep their relative order.
+
+    std::vector<entry_t> entry_set;
+
+    entry_set.reserve(this->tree_m.node_count());
+
+    for (node_t* node(this->tree_m.front()); node; node = tree_type::next(node))
+        entry_set.push_back(node->value_m);
+
+    std::stable_sort(entry_set.begin(), entry_set.end(), entry_compare_t(compare_m));
+
+    this->tree_m.clear();
+    this->index_m.clear();
+
+    for (typename std::vector<entry_t>::const_iterator iter(entry_set.begin()),
+         last(entry_set.end()); iter != last; ++iter)
+        this->add(0, iter->key_m, iter->value_m, 1);
+
+    for (typename base_type::view_set_t::iterator iter(this->view_set_m.begin()),
+         last(this->view_set_m.end()); iter != last; ++iter)
+    {
+        (*iter)->clear();
+
+        this->send_contents(**iter);
+    }
+}
+
+/******************************************************************************/
+
+} // namespace adobe
+
+/******************************************************************************/
+// ADOBE_SORTED_SEQUENCE_MODEL_HPP
+#endif
+/******************************************************************************/
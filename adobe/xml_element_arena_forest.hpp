@@ -0,0 +1,358 @@
+/*
+    Copyright 2013 Adobe
+    Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*/
+/**************************************************************************************************/
+
+#ifndef ADOBE_XML_ELEMENT_ARENA_FOREST_HPP
+#define ADOBE_XML_ELEMENT_ARENA_FOREST_HPP
+
+/**************************************************************************************************/
+
+#include <adobe/config.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <adobe/xml_element_forest.hpp>
+
+/**************************************************************************************************/
+
+namespace adobe {
+
+/**************************************************************************************************/
+#if !defined(ADOBE_NO_DOCUMENTATION)
+namespace implementation {
+
+/**************************************************************************************************/
+/*!
+    A bump allocator for arrays of T: each allocation is carved out of the
+    current block, and a new block is started when it runs out. Nothing is
+    freed until the arena is.
+*/
+template <typename T>
+class arena_t : boost::noncopyable
+{
+public:
+    enum { block_size_k = 1024 };
+
+    arena_t() :
+        next_m(0),
+        last_m(0)
+    { }
+
+    ~arena_t()
+    {
+        for (typename std::vector<T*>::iterator iter(block_set_m.begin()), last(block_set_m.end());
+             iter != last; ++iter)
+            delete [] *iter;
+    }
+
+    T* allocate(std::size_t n)
+    {
+        if (static_cast<std::size_t>(last_m - next_m) < n)
+        {
+            std::size_t size((std::max)(n, static_cast<std::size_t>(block_size_k)));
+
+            block_set_m.reserve(block_set_m.size() + 1);
+            block_set_m.push_back(new T[size]);
+
+            next_m = block_set_m.back();
+            last_m = next_m + size;
+        }
+
+        T* result(next_m);
+
+        next_m += n;
+
+        return result;
+    }
+
+private:
+    std::vector<T*> block_set_m;
+    T*              next_m;
+    T*              last_m;
+};
+
+/**************************************************************************************************/
+
+inline bool token_equal(const token_range_t& token, const char* str)
+{
+    std::size_t size(std::strlen(str));
+
+    return static_cast<std::size_t>(token.second - token.first) == size &&
+           std::equal(token.first, token.second, str);
+}
+
+/**************************************************************************************************/
+
+} // namespace implementation
+#endif
+/**************************************************************************************************/
+/*!
+    \ingroup xml_element_forest
+
+    \brief A read-only forest of the elements and character data of an XML
+    document that refers to the document rather than copying out of it.
+
+    Every name, attribute value and run of character data in the forest is a
+    token range into the document parsed, which must outlive the forest.
+    Nodes and attribute arrays are allocated from arenas owned by the forest,
+    so a parse costs a handful of block allocations however large the
+    document is. Nothing is converted to a string, name_t or any_regular_t
+    until asked for: materialize() gives the dictionary element_forest_t
+    would hold for a node, and to_element_forest() the whole element_forest_t.
+
+    Character data is kept as written, whitespace included (chardata()
+    repairs the whitespace as element_forest_t does). A run of character
+    data interrupted by a comment or processing instruction is kept as one
+    node per uninterrupted run, where element_forest_t joins them.
+*/
+class element_arena_forest_t : boost::noncopyable
+{
+public:
+    struct attribute_t
+    {
+        token_range_t name_m;
+        token_range_t value_m;
+    };
+
+    struct node_t
+    {
+        node_t() :
+            element_m(false),
+            attribute_first_m(0),
+            attribute_last_m(0),
+            parent_m(0),
+            first_child_m(0),
+            last_child_m(0),
+            next_sibling_m(0)
+        { }
+
+        bool is_element() const  { return element_m; }
+        bool is_chardata() const { return !element_m; }
+
+        /// the element name, or the character data as written
+        const token_range_t& token() const { return token_m; }
+
+        const attribute_t* attribute_begin() const { return attribute_first_m; }
+        const attribute_t* attribute_end() const   { return attribute_last_m; }
+
+        /// the attribute of the name passed, or 0 if the element has none
+        const attribute_t* find_attribute(const char* name) const
+        {
+            for (const attribute_t* iter(attribute_first_m); iter != attribute_last_m; ++iter)
+                if (implementation::token_equal(iter->name_m, name))
+                    return iter;
+
+            return 0;
+        }
+
+        const node_t* parent() const       { return parent_m; }
+        const node_t* first_child() const  { return first_child_m; }
+        const node_t* next_sibling() const { return next_sibling_m; }
+
+        std::string name() const
+        { return element_m ? implementation::token_to_string(token_m) : std::string(); }
+
+        std::string chardata() const
+        {
+            return element_m ?
+                       std::string() :
+                       implementation::repair_whitespace(implementation::token_to_string(token_m));
+        }
+
+        /// the dictionary element_forest_t holds for this node
+        dictionary_t materialize() const
+        {
+            dictionary_t result;
+
+            if (element_m)
+            {
+                for (const attribute_t* iter(attribute_first_m); iter != attribute_last_m; ++iter)
+                    result[implementation::token_to_name(iter->name_m)] =
+                        any_regular_t(implementation::token_to_string(iter->value_m));
+
+                result[name_type()] = any_regular_t(std::string("element"));
+                result[name_element_name()] = any_regular_t(name());
+            }
+            else
+            {
+                result[name_type()] = any_regular_t(std::string("chardata"));
+                result[name_chardata()] = any_regular_t(chardata());
+            }
+
+            return result;
+        }
+
+    private:
+        friend class element_arena_forest_t;
+
+        bool               element_m;
+        token_range_t      token_m;
+        const attribute_t* attribute_first_m;
+        const attribute_t* attribute_last_m;
+        node_t*            parent_m;
+        node_t*            first_child_m;
+        node_t*            last_child_m;
+        node_t*            next_sibling_m;
+    };
+
+    /*!
+        Parses xml, which must remain valid and unchanged for the life of
+        the forest.
+    */
+    explicit element_arena_forest_t(const char* xml) :
+        first_m(0),
+        last_m(0),
+        size_m(0)
+    {
+        token_range_t xml_range(static_token_range(xml));
+
+        implementation::xml_scanner_t<element_arena_forest_t>(*this).scan(xml_range.first,
+                                                                          xml_range.second);
+    }
+
+    /// the first top-level node, or 0 if the forest is empty
+    const node_t* begin() const { return first_m; }
+
+    bool        empty() const { return size_m == 0; }
+    std::size_t size() const  { return size_m; }
+
+    element_forest_t to_element_forest() const
+    {
+        element_forest_t                        result;
+        std::vector<element_forest_t::iterator> parent_stack(1, result.end());
+        const node_t*                           node(first_m);
+
+        while (node)
+        {
+            element_forest_t::iterator inserted(result.insert(trailing_of(parent_stack.back()),
+                                                              node->materialize()));
+
+            if (node->first_child_m)
+            {
+                parent_stack.push_back(inserted);
+
+                node = node->first_child_m;
+
+                continue;
+            }
+
+            while (node && !node->next_sibling_m)
+            {
+                node = node->parent_m;
+
+                parent_stack.pop_back();
+            }
+
+            if (node)
+                node = node->next_sibling_m;
+        }
+
+        return result;
+    }
+
+#if !defined(ADOBE_NO_DOCUMENTATION)
+    // xml_scanner_t handler
+
+    void start_element(const token_range_t&                         name,
+                       const implementation::attribute_token_set_t& attribute_set)
+    {
+        push_chardata();
+
+        node_t* node(append());
+
+        node->element_m = true;
+        node->token_m = name;
+
+        if (!attribute_set.empty())
+        {
+            attribute_t* attribute(attribute_arena_m.allocate(attribute_set.size()));
+
+            node->attribute_first_m = attribute;
+            node->attribute_last_m = attribute + attribute_set.size();
+
+            for (implementation::attribute_token_set_t::const_iterator iter(attribute_set.begin()),
+                 last(attribute_set.end()); iter != last; ++iter, ++attribute)
+            {
+                attribute->name_m = iter->first;
+                attribute->value_m = iter->second;
+            }
+        }
+
+        open_element_stack_m.push_back(node);
+    }
+
+    void end_element()
+    {
+        push_chardata();
+
+        open_element_stack_m.pop_back();
+    }
+
+    void chardata(const token_range_t& range)
+    {
+        // runs that abut (text either side of a CDATA section) are one node
+
+        if (!chardata_set_m.empty() && chardata_set_m.back().second == range.first)
+            chardata_set_m.back().second = range.second;
+        else
+            chardata_set_m.push_back(range);
+    }
+#endif
+
+private:
+    node_t* append()
+    {
+        node_t* node(node_arena_m.allocate(1));
+        node_t* parent(open_element_stack_m.empty() ? 0 : open_element_stack_m.back());
+        node_t*& first(parent ? parent->first_child_m : first_m);
+        node_t*& last(parent ? parent->last_child_m : last_m);
+
+        node->parent_m = parent;
+
+        if (last)
+            last->next_sibling_m = node;
+        else
+            first = node;
+
+        last = node;
+
+        ++size_m;
+
+        return node;
+    }
+
+    void push_chardata()
+    {
+        for (std::vector<token_range_t>::const_iterator iter(chardata_set_m.begin()),
+             last(chardata_set_m.end()); iter != last; ++iter)
+            append()->token_m = *iter;
+
+        chardata_set_m.clear();
+    }
+
+    implementation::arena_t<node_t>      node_arena_m;
+    implementation::arena_t<attribute_t> attribute_arena_m;
+    node_t*                              first_m;
+    node_t*                              last_m;
+    std::size_t                          size_m;
+    std::vector<node_t*>                 open_element_stack_m;
+    std::vector<token_range_t>           chardata_set_m;
+};
+
+/**************************************************************************************************/
+
+} // namespace adobe
+
+/**************************************************************************************************/
+
+#endif
+
+/**************************************************************************************************/
@@ -13,8 +13,14 @@
 #include <adobe/config.hpp>
 
 #include <algorithm>
+#include <cstring>
+#include <exception>
 #include <iostream>
+#include <iterator>
+#include <streambuf>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <adobe/algorithm/find.hpp>
 #include <adobe/dictionary.hpp>
@@ -24,6 +30,7 @@
 #include <adobe/xml_parser.hpp>
 
 #include <boost/bind.hpp>
+#include <boost/noncopyable.hpp>
 
 /**************************************************************************************************/
 
@@ -57,7 +64,7 @@ typedef forest<dictionary_t> element_forest_t;
 /**************************************************************************************************/
 
 #define ADOBE_XML_NODE_METADATA_NAME(x) \
-inline name_t name_##x() { static const name_t name_s("> "#x_name); return name_s; }
+inline name_t name_##x() { static const name_t name_s("> "#x); return name_s; }
 
 // These names are prefixed with a '> ' to prevent collisions with XML 
 // attribute names (which are not allowed to have the '>' in them).
@@ -99,7 +106,304 @@ inline dictionary_t attribute_set_to_dictionary(const attribute_set_t& set)
 }
 
 /**************************************************************************************************/
+/*!
+    Collapses each run of whitespace in src to a single space.
+*/
+inline std::string repair_whitespace(const std::string& src)
+{
+    std::string                               result;
+    std::string::const_iterator               iter(src.begin());
+    std::string::const_iterator               last(src.end());
+    static const boost::function<bool (char)> isspace =
+        boost::bind(&std::isspace<char>, _1, std::locale());
+
+    while (true)
+    {
+        std::string::const_iterator ws_begin(std::find_if(iter, last, isspace));
+
+        if (iter != ws_begin)
+            result << std::string(iter, ws_begin);
+
+        if (ws_begin == last)
+            break;
+
+        std::string::const_iterator ws_end(adobe::find_if_not(ws_begin, last, isspace));
+
+        result += ' ';
+
+        iter = ws_end;
+    }
+
+    return result;
+}
+
+/**************************************************************************************************/
+
+typedef std::vector<std::pair<token_range_t, token_range_t> > attribute_token_set_t;
+
+/**************************************************************************************************/
+/*!
+    xml_scanner_t makes a single pass over an XML document, reporting what
+    it finds to a handler as it goes:
+
+        - handler.start_element(name, attribute_token_set) for a start or
+          empty element tag;
+        - handler.end_element() for an end tag, or straight after
+          start_element for an empty element tag;
+        - handler.chardata(range) for each run of character data.
+
+    Every range handed to the handler points into the document scanned.
+    Elements are matched to their end tags with a stack of open element
+    names, so no part of the document is looked at more than once.
+
+    Character data (entity and character references included) is reported
+    as written, and a CDATA section is reported whole, markup and all.
+    Comments, processing instructions and declarations are skipped; a
+    document type declaration is skipped with its internal subset.
+*/
+template <typename Handler>
+class xml_scanner_t
+{
+public:
+    explicit xml_scanner_t(Handler& handler) :
+        handler_m(handler)
+    { }
+
+    void scan(uchar_ptr_t first, uchar_ptr_t last)
+    {
+        first_m = first;
+
+        open_element_stack_m.clear();
+
+        while (true)
+        {
+            uchar_ptr_t tag(std::find(first, last, '<'));
+
+            if (first != tag)
+                handler_m.chardata(token_range_t(first, tag));
+
+            if (tag == last)
+                break;
+
+            if (starts_with(tag, last, "<!--"))
+            {
+                first = skip_past(tag + 4, last, "-->");
+            }
+            else if (starts_with(tag, last, "<![CDATA["))
+            {
+                first = skip_past(tag + 9, last, "]]>");
+
+                handler_m.chardata(token_range_t(tag, first));
+            }
+            else if (starts_with(tag, last, "<?"))
+            {
+                first = skip_past(tag + 2, last, "?>");
+            }
+            else if (starts_with(tag, last, "<!"))
+            {
+                first = skip_declaration(tag + 2, last);
+            }
+            else if (starts_with(tag, last, "</"))
+            {
+                token_range_t name(scan_name(tag + 2, last));
+
+                first = expect(skip_space(name.second, last), last, '>');
+
+                if (open_element_stack_m.empty() || !token_equal(name, open_element_stack_m.back()))
+                    throw_exception(tag, "Mismatched end tag");
+
+                open_element_stack_m.pop_back();
+
+                handler_m.end_element();
+            }
+            else
+            {
+                token_range_t name(scan_name(tag + 1, last));
+
+                attribute_set_m.clear();
+
+                first = skip_space(name.second, last);
+
+                while (first != last && *first != '/' && *first != '>')
+                    first = scan_attribute(first, last);
+
+                bool empty_element(first != last && *first == '/');
+
+                if (empty_element)
+                    ++first;
+
+                first = expect(first, last, '>');
+
+                handler_m.start_element(name, attribute_set_m);
+
+                if (empty_element)
+                    handler_m.end_element();
+                else
+                    open_element_stack_m.push_back(name);
+            }
+        }
+
+        if (!open_element_stack_m.empty())
+            throw_exception(last, "Unterminated element");
+    }
+
+private:
+    uchar_ptr_t scan_attribute(uchar_ptr_t first, uchar_ptr_t last)
+    {
+        token_range_t name(scan_name(first, last));
+
+        first = expect(skip_space(name.second, last), last, '=');
+        first = skip_space(first, last);
+
+        if (first == last || (*first != '\'' && *first != '"'))
+            throw_exception(first, "Expected a quoted attribute value");
+
+        uchar_ptr_t value_last(std::find(first + 1, last, *first));
+
+        if (value_last == last)
+            throw_exception(first, "Unterminated attribute value");
+
+        attribute_set_m.push_back(std::make_pair(name, token_range_t(first + 1, value_last)));
+
+        return skip_space(value_last + 1, last);
+    }
+
+    token_range_t scan_name(uchar_ptr_t first, uchar_ptr_t last)
+    {
+        uchar_ptr_t name_last(first);
+
+        while (name_last != last && !is_space(*name_last) &&
+               *name_last != '/' && *name_last != '>' && *name_last != '=' && *name_last != '<')
+            ++name_last;
+
+        if (name_last == first)
+            throw_exception(first, "Expected a name");
+
+        return token_range_t(first, name_last);
+    }
+
+    uchar_ptr_t expect(uchar_ptr_t first, uchar_ptr_t last, char c)
+    {
+        if (first == last || *first != c)
+            throw_exception(first, make_string("Expected '", std::string(1, c).c_str(), "'").c_str());
+
+        return first + 1;
+    }
 
+    uchar_ptr_t skip_past(uchar_ptr_t first, uchar_ptr_t last, const char* terminator)
+    {
+        uchar_ptr_t result(std::search(first, last, terminator, terminator + std::strlen(terminator)));
+
+        if (result == last)
+            throw_exception(first, make_string("Expected '", terminator, "'").c_str());
+
+        return result + std::strlen(terminator);
+    }
+
+    /*
+        Skips the rest of a declaration such as <!DOCTYPE ...>. Quoted
+        literals are passed over whole, and so is an internal subset in
+        brackets along with the declarations, comments and processing
+        instructions within it, so a '>' in any of them does not end the
+        declaration.
+    */
+    uchar_ptr_t skip_declaration(uchar_ptr_t first, uchar_ptr_t last)
+    {
+        uchar_ptr_t declaration(first);
+        std::size_t depth(0);
+
+        while (first != last)
+        {
+            if (*first == '\'' || *first == '"')
+            {
+                uchar_ptr_t literal_last(std::find(first + 1, last, *first));
+
+                if (literal_last == last)
+                    throw_exception(first, "Unterminated literal");
+
+                first = literal_last + 1;
+            }
+            else if (depth != 0 && starts_with(first, last, "<!--"))
+            {
+                first = skip_past(first + 4, last, "-->");
+            }
+            else if (depth != 0 && starts_with(first, last, "<?"))
+            {
+                first = skip_past(first + 2, last, "?>");
+            }
+            else if (*first == '[')
+            {
+                ++depth;
+                ++first;
+            }
+            else if (*first == ']' && depth != 0)
+            {
+                --depth;
+                ++first;
+            }
+            else if (*first == '>' && depth == 0)
+            {
+                return first + 1;
+            }
+            else
+            {
+                ++first;
+            }
+        }
+
+        throw_exception(declaration, depth != 0 ? "Expected ']'" : "Expected '>'");
+
+        return last;
+    }
+
+    void throw_exception(uchar_ptr_t position, const char* error_string)
+    {
+        line_position_t line_position("top level xml");
+
+        line_position.line_number_m += static_cast<int>(std::count(first_m, position, '\n'));
+
+        throw_parser_exception(error_string, line_position);
+    }
+
+    static bool starts_with(uchar_ptr_t first, uchar_ptr_t last, const char* prefix)
+    {
+        std::size_t size(std::strlen(prefix));
+
+        return static_cast<std::size_t>(last - first) >= size && std::equal(prefix, prefix + size, first);
+    }
+
+    static bool token_equal(const token_range_t& x, const token_range_t& y)
+    {
+        return x.second - x.first == y.second - y.first && std::equal(x.first, x.second, y.first);
+    }
+
+    static bool is_space(uchar_t c)
+    { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+    static uchar_ptr_t skip_space(uchar_ptr_t first, uchar_ptr_t last)
+    {
+        while (first != last && is_space(*first))
+            ++first;
+
+        return first;
+    }
+
+    Handler&                   handler_m;
+    uchar_ptr_t                first_m;
+    std::vector<token_range_t> open_element_stack_m;
+    attribute_token_set_t      attribute_set_m;
+};
+
+/**************************************************************************************************/
+/*!
+    converter_t builds an element_forest_t from the events of an
+    xml_scanner_t, keeping the elements open at the current point of the
+    scan on a stack: a start tag adds a child to the element on top of the
+    stack and pushes it, the matching end tag pops it.
+
+    Character data is gathered until the next tag, then inserted as a single
+    chardata node with its whitespace repaired.
+*/
 struct converter_t
 {
     element_forest_t parse(const char* xml)
@@ -107,58 +411,53 @@ struct converter_t
         element_forest_t root;
 
         token_range_t xml_range(static_token_range(xml));
-    
-        make_xml_parser(xml_range.first, xml_range.second,
-                               line_position_t("top level xml"),
-                               always_true<token_range_t>(),
-                               boost::bind(&converter_t::xml_element_node,
-                                           boost::ref(*this),
-                                           _1, _2, _3, _4,
-                                           boost::ref(root),
-                                           root.begin()),
-                               std::back_inserter(chardata_m))
-            .parse_content();
-    
+
+        forest_m = &root;
+
+        open_element_stack_m.clear();
+
+        xml_scanner_t<converter_t>(*this).scan(xml_range.first, xml_range.second);
+
         return root;
     }
 
-    token_range_t xml_element_node(const token_range_t&       /*entire_element_range*/,
-                                   const token_range_t&       name,
-                                   const attribute_set_t&     attribute_set,
-                                   const token_range_t&       value,
-                                   element_forest_t&          forest,
-                                   element_forest_t::iterator parent_node)
+    void start_element(const token_range_t& name, const attribute_token_set_t& attribute_set)
     {
-        push_chardata(forest, parent_node);    
+        element_forest_t::iterator parent(current_element());
 
-        element_forest_t::iterator new_parent =
-            forest.insert(trailing_of(parent_node), dictionary_t());
+        push_chardata(parent);
 
-        (*new_parent) = implementation::attribute_set_to_dictionary(attribute_set);
-    
-        (*new_parent)[name_type()] = any_regular_t(std::string("element"));
-        (*new_parent)[name_element_name()] = any_regular_t(implementation::token_to_string(name));
-    
-        make_xml_parser(value.first, value.second,
-                               line_position_t("xml_node"),
-                               always_true<token_range_t>(),
-                               boost::bind(&converter_t::xml_element_node,
-                                           boost::ref(*this),
-                                           _1, _2, _3, _4,
-                                           boost::ref(forest),
-                                           new_parent),
-                               std::back_inserter(chardata_m))
-            .parse_content();
+        dictionary_t node;
 
-        push_chardata(forest, new_parent);
+        for (attribute_token_set_t::const_iterator iter(attribute_set.begin()),
+             last(attribute_set.end()); iter != last; ++iter)
+            node[token_to_name(iter->first)] = any_regular_t(token_to_string(iter->second));
+
+        node[name_type()] = any_regular_t(std::string("element"));
+        node[name_element_name()] = any_regular_t(token_to_string(name));
+
+        open_element_stack_m.push_back(forest_m->insert(trailing_of(parent), node));
+    }
+
+    void end_element()
+    {
+        push_chardata(current_element());
 
-        return token_range_t();
+        open_element_stack_m.pop_back();
+    }
+
+    void chardata(const token_range_t& range)
+    {
+        chardata_m.insert(chardata_m.end(), range.first, range.second);
     }
 
 private:
-    std::vector<char> chardata_m;
+    element_forest_t::iterator current_element()
+    {
+        return open_element_stack_m.empty() ? forest_m->end() : open_element_stack_m.back();
+    }
 
-    void push_chardata(element_forest_t& forest, element_forest_t::iterator parent)
+    void push_chardata(element_forest_t::iterator parent)
     {
         if (chardata_m.empty())
             return;
@@ -172,46 +471,290 @@ private:
             chardata[name_type()] = any_regular_t(std::string("chardata"));
             chardata[name_chardata()] = any_regular_t(chardata_str);
 
-            forest.insert(trailing_of(parent), chardata);
+            forest_m->insert(trailing_of(parent), chardata);
         }
 
         chardata_m = std::vector<char>();
     }
 
-    static std::string repair_whitespace(const std::string& src)
+    element_forest_t*                       forest_m;
+    std::vector<element_forest_t::iterator> open_element_stack_m;
+    std::vector<char>                       chardata_m;
+};
+
+/**************************************************************************************************/
+/*!
+    A stream buffer appending everything written through it to a string.
+*/
+class string_appender_streambuf_t : public std::streambuf
+{
+public:
+    explicit string_appender_streambuf_t(std::string& str) :
+        str_m(str)
+    { }
+
+protected:
+    int_type overflow(int_type c)
     {
-        std::string                               result;
-        std::string::const_iterator               iter(src.begin());
-        std::string::const_iterator               last(src.end());
-        static const boost::function<bool (char)> isspace =
-            boost::bind(&std::isspace<char>, _1, std::locale());
+        if (!traits_type::eq_int_type(c, traits_type::eof()))
+            str_m += traits_type::to_char_type(c);
 
-        while (true)
-        {
-            std::string::const_iterator ws_begin(std::find_if(iter, last, isspace));
+        return traits_type::not_eof(c);
+    }
 
-            if (iter != ws_begin)
-                result << std::string(iter, ws_begin);
+    std::streamsize xsputn(const char* s, std::streamsize n)
+    {
+        str_m.append(s, static_cast<std::size_t>(n));
 
-            if (ws_begin == last)
-                break;
+        return n;
+    }
 
-            std::string::const_iterator ws_end(find_if_not(ws_begin, last, isspace));
+private:
+    std::string& str_m;
+};
 
-            result += ' ';
+/**************************************************************************************************/
+/*!
+    The output of element_forest_to_xml is gathered in a buffer, handed to
+    the stream a buffer_size_k block at a time and never flushed. Without a
+    stream the buffer just grows, holding everything written.
+
+    Values and numbers are formatted by operator<< on a stream of the
+    writer's own, appending to the buffer, that carries the format of the
+    stream passed (to the constructor or to copyfmt()) so they come out as
+    streaming them to that stream would write them.
+*/
+class xml_writer_t : boost::noncopyable
+{
+public:
+    enum { buffer_size_k = 64 * 1024 };
 
-            iter = ws_end;
-        }
+    explicit xml_writer_t(std::ostream* output = 0) :
+        output_m(output),
+        streambuf_m(buffer_m),
+        stream_m(&streambuf_m)
+    {
+        buffer_m.reserve(output_m ? std::size_t(buffer_size_k) : 0);
+
+        if (output_m)
+            copyfmt(*output_m);
+    }
+
+    /// formats values as format would; format is not written to or flushed
+    void copyfmt(const std::ostream& format)
+    {
+        stream_m.copyfmt(format);
+        stream_m.tie(0);
+    }
+
+    void write(char c)
+    {
+        buffer_m += c;
+
+        flush_full();
+    }
+
+    void write(const char* str)
+    {
+        buffer_m += str;
+
+        flush_full();
+    }
+
+    void write(const std::string& str)
+    {
+        buffer_m += str;
+
+        flush_full();
+    }
+
+    void write(const any_regular_t& x)
+    {
+        stream_m << x;
+
+        flush_full();
+    }
+
+    void write(std::ptrdiff_t n)
+    {
+        stream_m << n;
+
+        flush_full();
+    }
+
+    template <typename T>
+    void indent(T count)
+    { for (; count != 0; --count) buffer_m += "  "; }
+
+    void flush()
+    {
+        if (!output_m || buffer_m.empty())
+            return;
+
+        output_m->write(buffer_m.data(), static_cast<std::streamsize>(buffer_m.size()));
+
+        buffer_m.clear();
+    }
+
+    const std::string& str() const
+    { return buffer_m; }
+
+private:
+    void flush_full()
+    {
+        if (buffer_m.size() >= buffer_size_k)
+            flush();
+    }
+
+    std::ostream*               output_m;
+    std::string                 buffer_m;
+    string_appender_streambuf_t streambuf_m;
+    std::ostream                stream_m;
+};
 
-        return result;
+/**************************************************************************************************/
+/*!
+    Joins every joinable thread of a set when it goes out of scope, so a
+    thread that cannot be started does not leave the others running, and
+    being destroyed joinable, as the exception unwinds.
+*/
+class thread_set_joiner_t : boost::noncopyable
+{
+public:
+    explicit thread_set_joiner_t(std::vector<std::thread>& thread_set) :
+        thread_set_m(thread_set)
+    { }
+
+    ~thread_set_joiner_t()
+    {
+        for (std::vector<std::thread>::iterator iter(thread_set_m.begin()),
+             last(thread_set_m.end()); iter != last; ++iter)
+            if (iter->joinable())
+                iter->join();
     }
+
+private:
+    std::vector<std::thread>& thread_set_m;
 };
 
 /**************************************************************************************************/
 
-template <typename T>
-inline void indent_stream(std::ostream& stream, T count)
-{ for (; count != 0; --count) stream << "  "; }
+inline bool is_whitespace(const std::string& str)
+{
+    static const boost::function<bool (char)> isspace =
+        boost::bind(&std::isspace<char>, _1, std::locale());
+
+    return adobe::find_if_not(str, isspace) == str.end();
+}
+
+/**************************************************************************************************/
+/*!
+    Writes the nodes in [first, last), a range of depth adaptor iterators.
+    Each node's dictionary is looked up once, on its leading edge; the name
+    of an element with children is kept on a stack for its end tag.
+*/
+template <typename I> // I models a depth adaptor iterator
+void write_element_forest(I first, I last, xml_writer_t& output, bool verbose)
+{
+    const name_t                      type_key(name_type());
+    const name_t                      element_name_key(name_element_name());
+    const name_t                      chardata_key(name_chardata());
+    std::vector<const any_regular_t*> element_name_stack;
+
+    for (; first != last; ++first)
+    {
+        if (first.edge() != forest_leading_edge)
+        {
+            if (!has_children(first))
+                continue;
+
+            const any_regular_t* element_name(element_name_stack.back());
+
+            element_name_stack.pop_back();
+
+            if (!element_name)
+                continue;
+
+            if (verbose)
+                output.indent(first.depth());
+
+            output.write("</");
+            output.write(*element_name);
+            output.write('>');
+
+            if (verbose)
+                output.write('\n');
+
+            continue;
+        }
+
+        const dictionary_t&  node(*first);
+        const std::string&   type(get_value(node, type_key).cast<std::string>());
+        const any_regular_t* element_name(0);
+
+        if (type == "element")
+        {
+            element_name = &get_value(node, element_name_key);
+
+            if (verbose)
+                output.indent(first.depth());
+
+            output.write('<');
+            output.write(*element_name);
+
+            for (dictionary_t::const_iterator iter(node.begin()), last(node.end());
+                 iter != last; ++iter)
+            {
+                if (iter->first.c_str()[0] == '>')
+                    continue;
+
+                output.write(' ');
+                output.write(iter->first.c_str());
+                output.write("='");
+                output.write(iter->second);
+                output.write('\'');
+            }
+
+            if (has_children(first))
+            {
+                output.write('>');
+
+                if (verbose)
+                {
+                    output.write(" <!-- ");
+                    output.write(static_cast<std::ptrdiff_t>(std::distance(child_begin(first),
+                                                                           child_end(first))));
+                    output.write(" children -->");
+                }
+            }
+            else
+            {
+                output.write("/>");
+            }
+
+            if (verbose)
+                output.write('\n');
+        }
+        else if (type == "chardata")
+        {
+            const std::string& chardata(get_value(node, chardata_key).cast<std::string>());
+
+            if (!verbose)
+            {
+                output.write(chardata);
+            }
+            else if (!is_whitespace(chardata))
+            {
+                output.indent(first.depth());
+                output.write(chardata);
+                output.write('\n');
+            }
+        }
+
+        if (has_children(first))
+            element_name_stack.push_back(element_name);
+    }
+}
 
 /**************************************************************************************************/
 
@@ -226,7 +769,8 @@ inline void indent_stream(std::ostream& stream, T count)
     \param f A depth adaptor range of a forest of dictionaries; the source of
              the eventual XML file.
     \param output The output stream to which the XML serialization will be
-                  written.
+                  written. The output is buffered, and the stream is not
+                  flushed.
     \param verbose If true, will print a more-formatted, easier-to-read version
                    of XML; if false, will not introduce spacing or newlines to
                    the XML output.
@@ -234,77 +778,118 @@ inline void indent_stream(std::ostream& stream, T count)
 template <typename R> // R is a depth adaptor range
 void element_forest_to_xml(const R& f, std::ostream& output, bool verbose = true)
 {
-    typedef typename boost::range_iterator<R>::type iterator;
+    implementation::xml_writer_t writer(&output);
+
+    implementation::write_element_forest(boost::begin(f), boost::end(f), writer, verbose);
+
+    writer.flush();
+}
+
+/**************************************************************************************************/
+/*!
+    \ingroup xml_element_forest
+
+    \brief Converts a forest of dictionaries to an XML file, serializing its
+    top-level subtrees on several threads.
+
+    The top-level subtrees are split into thread_count runs of consecutive
+    subtrees, each written to a buffer of its own on a thread of its own;
+    the buffers are then written to output in order. The result is the same
+    as that of element_forest_to_xml(depth_range(f), output, verbose).
+
+    \param f The forest of dictionaries to serialize, which must not be
+             modified until the call returns.
+    \param output The output stream to which the XML serialization will be
+                  written. It is not flushed.
+    \param verbose As for element_forest_to_xml.
+    \param thread_count The number of threads to use; zero for one per
+                        hardware thread.
+*/
+inline void element_forest_to_xml_parallel(const element_forest_t& f,
+                                           std::ostream&           output,
+                                           bool                    verbose = true,
+                                           std::size_t             thread_count = 0)
+{
+    typedef element_forest_t::const_iterator   iterator;
+    typedef depth_fullorder_iterator<iterator> depth_iterator;
+    typedef std::vector<iterator>              subtree_set_t;
+
+    subtree_set_t subtree_set;
 
-    for (iterator first(boost::begin(f)), last(boost::end(f)); first != last; ++first)
+    for (iterator first(f.begin()), last(f.end()); first != last; ++first)
     {
-        const dictionary_t& node(*first);
-        const std::string&  type(get_value(node, name_type()).cast<std::string>());
+        subtree_set.push_back(first);
 
-        if (type == "element")
-        {
-            if (first.edge() == forest_leading_edge)
-            {
-                if (verbose)
-                    implementation::indent_stream(output, first.depth());
-    
-                output << "<" << get_value(node, name_element_name());
-    
-                for (dictionary_t::const_iterator iter(node.begin()), last(node.end());
-                     iter != last; ++iter)
-                    if (iter->first.c_str()[0] != '>')
-                        output << ' ' << iter->first.c_str() << "='" << iter->second << "'";
-    
-                if (has_children(first))
-                {
-                    output << ">";
+        first = trailing_of(first);
+    }
 
-                    if (verbose)
-                        output << " <!-- "
-                               << std::distance(child_begin(first), child_end(first))
-                               << " children -->";
-                }
-                else
-                {
-                    output << "/>";
-                }
+    subtree_set.push_back(f.end());
 
-                if (verbose)
-                    output << std::endl;
-            }
-            else if (has_children(first))
-            {
-                if (verbose)
-                    implementation::indent_stream(output, first.depth());
+    std::size_t subtree_count(subtree_set.size() - 1);
 
-                output << "</" << get_value(node, name_element_name()) << ">";
+    if (thread_count == 0)
+        thread_count = std::thread::hardware_concurrency();
 
-                if (verbose)
-                    output << std::endl;
-            }
-        }
-        else if (type == "chardata" && first.edge() == forest_leading_edge)
+    thread_count = (std::min)(thread_count, subtree_count);
+
+    if (thread_count <= 1)
+    {
+        element_forest_to_xml(depth_range(f), output, verbose);
+
+        return;
+    }
+
+    // the metadata names are function statics; make them before the threads do
+
+    name_type();
+    name_element_name();
+    name_chardata();
+
+    std::vector<implementation::xml_writer_t> writer_set(thread_count);
+    std::vector<std::exception_ptr>           error_set(thread_count);
+    std::vector<std::thread>                  thread_set;
+
+    // reserved so adding a started thread to the set cannot throw
+
+    thread_set.reserve(thread_count);
+
+    {
+        implementation::thread_set_joiner_t joiner(thread_set);
+
+        for (std::size_t i(0); i != thread_count; ++i)
         {
-            const std::string& chardata(get_value(node, name_chardata()).cast<std::string>());
+            iterator first(subtree_set[subtree_count * i / thread_count]);
+            iterator last(subtree_set[subtree_count * (i + 1) / thread_count]);
 
-            if (!verbose)
-            {
-                output << chardata;
-            }
-            else
-            {
-                if (adobe::find_if_not(chardata,
-                                       boost::bind(&std::isspace<char>,
-                                                   _1,
-                                                   std::locale())) == chardata.end())
-                    continue;
+            implementation::xml_writer_t& writer(writer_set[i]);
+            std::exception_ptr&           error(error_set[i]);
 
-                implementation::indent_stream(output, first.depth());
+            writer.copyfmt(output);
 
-                output << chardata << std::endl;
-            }
+            thread_set.push_back(std::thread([first, last, verbose, &writer, &error]()
+            {
+                try
+                {
+                    implementation::write_element_forest(depth_iterator(first),
+                                                         depth_iterator(last),
+                                                         writer,
+                                                         verbose);
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                }
+            }));
         }
     }
+
+    for (std::size_t i(0); i != thread_count; ++i)
+        if (error_set[i])
+            std::rethrow_exception(error_set[i]);
+
+    for (std::size_t i(0); i != thread_count; ++i)
+        output.write(writer_set[i].str().data(),
+                     static_cast<std::streamsize>(writer_set[i].str().size()));
 }
 
 /**************************************************************************************************/
@@ -318,7 +903,7 @@ void element_forest_to_xml(const R& f, std::ostream& output, bool verbose = true
     \return an element forest. See the documentation on the node format above
             for details on what will be within each node's dictionary.
 */
-element_forest_t xml_parse_to_forest(const char* xml)
+inline element_forest_t xml_parse_to_forest(const char* xml)
 {
     return implementation::converter_t().parse(xml);
 }
@@ -0,0 +1,409 @@
+/*
+    Copyright 2013 Adobe
+    Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*/
+/**************************************************************************************************/
+
+#ifndef ADOBE_XML_ELEMENT_FOREST_INDEX_HPP
+#define ADOBE_XML_ELEMENT_FOREST_INDEX_HPP
+
+/**************************************************************************************************/
+
+#include <adobe/config.hpp>
+
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/next_prior.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <adobe/closed_hash.hpp>
+#include <adobe/xml_element_forest.hpp>
+
+/**************************************************************************************************/
+
+namespace adobe {
+
+/**************************************************************************************************/
+/*!
+    \ingroup xml_element_forest
+
+    \brief An index of the elements of an element_forest_t by element name
+    and by attribute value.
+
+    Every node of the forest is given a label for each of its edges, in
+    fullorder, so that the descendants of a node are exactly the nodes whose
+    leading labels fall between its own two. The index keeps, for each
+    element name and for each (attribute name, attribute value) pair, the
+    elements so named ordered by leading label. Finding the elements of a
+    name under a node, or those matching a path of names, is then a
+    matter of a lower_bound per enclosing element, and takes time in
+    proportion to the elements found rather than to the size of the forest.
+
+    Labels are spaced out so that a node inserted through the index takes
+    labels between those of its neighbours. When there is no room left, the
+    whole forest is labelled and indexed afresh.
+
+    The index stays consistent with the forest as long as nodes are inserted
+    and erased through insert() and erase(). A change made to the forest or
+    to a node's dictionary any other way must be followed by reindex().
+    Only attribute values held as std::string are indexed.
+*/
+class element_forest_index_t : boost::noncopyable
+{
+public:
+    typedef element_forest_t::iterator iterator;
+    typedef boost::uint64_t            label_type;
+
+    explicit element_forest_index_t(element_forest_t& forest) :
+        forest_m(forest)
+    { reindex(); }
+
+    element_forest_t& forest() const { return forest_m; }
+
+    /// writes the elements of the name passed, in document order, to out
+    template <typename O> // O models OutputIterator
+    O find(name_t element_name, O out) const
+    {
+        return copy_within(find_posting(element_name_index_m, element_name),
+                           label_type(0),
+                           max_label(),
+                           out);
+    }
+
+    /// writes the elements with the attribute value passed, in document order, to out
+    template <typename O> // O models OutputIterator
+    O find(name_t attribute_name, const std::string& value, O out) const
+    {
+        return copy_within(find_posting(attribute_index_m, attribute_key_t(attribute_name, value)),
+                           label_type(0),
+                           max_label(),
+                           out);
+    }
+
+    /// writes the elements of the name passed below node, in document order, to out
+    template <typename O> // O models OutputIterator
+    O find_descendants(iterator node, name_t element_name, O out) const
+    {
+        const label_t& label(find_label(node));
+
+        return copy_within(find_posting(element_name_index_m, element_name),
+                           label.leading_m,
+                           label.trailing_m,
+                           out);
+    }
+
+    /*!
+        Writes to out, in document order, the elements named by the last
+        name in [first, last) that are below an element named by the one
+        before, and so on back to the first (as the XPath //a//b//c). The
+        time taken is proportional to the number of elements matching each
+        step of the path, not to the size of the forest.
+    */
+    template <typename I, // I models InputIterator; value_type(I) == name_t
+              typename O> // O models OutputIterator
+    O find_path(I first, I last, O out) const
+    {
+        if (first == last)
+            return out;
+
+        scope_set_t scope_set(1, scope_t(label_type(0), max_label()));
+
+        while (true)
+        {
+            const posting_t* posting(find_posting(element_name_index_m, *first));
+
+            if (++first == last)
+            {
+                for (scope_set_t::const_iterator iter(scope_set.begin()), end(scope_set.end());
+                     iter != end; ++iter)
+                    out = copy_within(posting, iter->first, iter->second, out);
+
+                return out;
+            }
+
+            scope_set = outermost_within(posting, scope_set);
+
+            if (scope_set.empty())
+                return out;
+        }
+    }
+
+    /*!
+        Inserts node before position, as forest().insert(position, node)
+        does, and indexes it.
+    */
+    iterator insert(const iterator& position, const dictionary_t& node)
+    {
+        iterator   result(forest_m.insert(position, node));
+        label_type lower(label_of(boost::prior(result)));
+        label_type upper(label_of(boost::next(trailing_of(result))));
+
+        if (upper - lower < 3)
+        {
+            reindex();
+
+            return result;
+        }
+
+        label_t label = { lower + (upper - lower) / 3, lower + (upper - lower) / 3 * 2 };
+
+        index_node(result, label);
+
+        return result;
+    }
+
+    /*!
+        Removes the node at position, and everything below it, from the index
+        and then from the forest, as forest().erase(position) does.
+    */
+    iterator erase(const iterator& position)
+    {
+        iterator first(leading_of(position));
+        iterator last(boost::next(trailing_of(position)));
+
+        for (; first != last; ++first)
+            if (first.edge() == forest_leading_edge)
+                unindex_node(first);
+
+        return forest_m.erase(position);
+    }
+
+    /// labels and indexes the whole forest afresh
+    void reindex()
+    {
+        label_index_m.clear();
+        element_name_index_m.clear();
+        attribute_index_m.clear();
+
+        std::size_t edge_count(0);
+
+        for (iterator first(forest_m.begin()), last(forest_m.end()); first != last; ++first)
+            ++edge_count;
+
+        label_type spacing(max_label() / (edge_count + 2));
+        label_type next(0);
+
+        for (iterator first(forest_m.begin()), last(forest_m.end()); first != last; ++first)
+        {
+            next += spacing;
+
+            if (first.edge() == forest_leading_edge)
+            {
+                label_t label = { next, 0 };
+
+                label_index_m[&*first] = label;
+            }
+            else
+            {
+                label_t& label(label_index_m[&*first]);
+
+                label.trailing_m = next;
+
+                index_node(leading_of(first), label);
+            }
+        }
+    }
+
+private:
+    static label_type max_label()
+    { return label_type(1) << 62; }
+
+    struct label_t
+    {
+        label_type leading_m;
+        label_type trailing_m;
+    };
+
+    struct entry_t
+    {
+        entry_t(iterator node, label_type trailing) :
+            node_m(node),
+            trailing_m(trailing)
+        { }
+
+        iterator   node_m;
+        label_type trailing_m;
+    };
+
+    typedef std::pair<name_t, std::string>                attribute_key_t;
+    typedef std::map<label_type, entry_t>                 posting_t;
+    typedef closed_hash_map<name_t, posting_t>            element_name_index_t;
+    typedef std::map<attribute_key_t, posting_t>          attribute_index_t;
+    typedef closed_hash_map<const dictionary_t*, label_t> label_index_t;
+    typedef std::pair<label_type, label_type>             scope_t;
+    typedef std::vector<scope_t>                          scope_set_t;
+
+    template <typename Index>
+    static const posting_t* find_posting(const Index& index, const typename Index::key_type& key)
+    {
+        typename Index::const_iterator found(index.find(key));
+
+        return found == index.end() ? 0 : &found->second;
+    }
+
+    // the elements in posting strictly between the labels passed
+
+    template <typename O>
+    static O copy_within(const posting_t* posting, label_type leading, label_type trailing, O out)
+    {
+        if (!posting)
+            return out;
+
+        for (posting_t::const_iterator iter(posting->upper_bound(leading)), last(posting->end());
+             iter != last && iter->first < trailing; ++iter)
+            *out++ = iter->second.node_m;
+
+        return out;
+    }
+
+    // the elements in posting within one of scope_set that are not within another of them
+
+    static scope_set_t outermost_within(const posting_t* posting, const scope_set_t& scope_set)
+    {
+        scope_set_t result;
+
+        if (!posting)
+            return result;
+
+        for (scope_set_t::const_iterator scope(scope_set.begin()), end(scope_set.end());
+             scope != end; ++scope)
+        {
+            posting_t::const_iterator iter(posting->upper_bound(scope->first));
+
+            while (iter != posting->end() && iter->first < scope->second)
+            {
+                result.push_back(scope_t(iter->first, iter->second.trailing_m));
+
+                iter = posting->lower_bound(iter->second.trailing_m);
+            }
+        }
+
+        return result;
+    }
+
+    const label_t& find_label(const iterator& node) const
+    {
+        label_index_t::const_iterator found(label_index_m.find(&*node));
+
+        if (found == label_index_m.end())
+            throw std::logic_error("element_forest_index_t: node not in the index");
+
+        return found->second;
+    }
+
+    // the label of an edge, the leading and trailing edges of the root being 0 and max_label()
+
+    label_type label_of(const iterator& edge) const
+    {
+        if (edge == forest_m.end())
+            return max_label();
+
+        if (edge == leading_of(forest_m.end()))
+            return 0;
+
+        const label_t& label(find_label(edge));
+
+        return edge.edge() == forest_leading_edge ? label.leading_m : label.trailing_m;
+    }
+
+    static const std::string* element_name_of(const dictionary_t& node)
+    {
+        dictionary_t::const_iterator type(node.find(name_type()));
+
+        if (type == node.end() ||
+            type->second.type_info() != type_info<std::string>() ||
+            type->second.cast<std::string>() != "element")
+            return 0;
+
+        dictionary_t::const_iterator name(node.find(name_element_name()));
+
+        if (name == node.end() || name->second.type_info() != type_info<std::string>())
+            return 0;
+
+        return &name->second.cast<std::string>();
+    }
+
+    static bool is_indexed_attribute(const dictionary_t::value_type& attribute)
+    {
+        return attribute.first.c_str()[0] != '>' &&
+               attribute.second.type_info() == type_info<std::string>();
+    }
+
+    static attribute_key_t attribute_key(const dictionary_t::value_type& attribute)
+    { return attribute_key_t(attribute.first, attribute.second.cast<std::string>()); }
+
+    void index_node(const iterator& node, const label_t& label)
+    {
+        label_index_m[&*node] = label;
+
+        const std::string* name(element_name_of(*node));
+
+        if (!name)
+            return;
+
+        posting_t::value_type entry(label.leading_m, entry_t(node, label.trailing_m));
+
+        element_name_index_m[name_t(name->c_str())].insert(entry);
+
+        for (dictionary_t::const_iterator iter(node->begin()), last(node->end()); iter != last; ++iter)
+            if (is_indexed_attribute(*iter))
+                attribute_index_m[attribute_key(*iter)].insert(entry);
+    }
+
+    void unindex_node(const iterator& node)
+    {
+        label_index_t::iterator found(label_index_m.find(&*node));
+
+        if (found == label_index_m.end())
+            return;
+
+        label_type         leading(found->second.leading_m);
+        const std::string* name(element_name_of(*node));
+
+        label_index_m.erase(found);
+
+        if (!name)
+            return;
+
+        erase_entry(element_name_index_m, name_t(name->c_str()), leading);
+
+        for (dictionary_t::const_iterator iter(node->begin()), last(node->end()); iter != last; ++iter)
+            if (is_indexed_attribute(*iter))
+                erase_entry(attribute_index_m, attribute_key(*iter), leading);
+    }
+
+    template <typename Index>
+    static void erase_entry(Index& index, const typename Index::key_type& key, label_type leading)
+    {
+        typename Index::iterator posting(index.find(key));
+
+        if (posting == index.end())
+            return;
+
+        posting->second.erase(leading);
+
+        if (posting->second.empty())
+            index.erase(posting);
+    }
+
+    element_forest_t&    forest_m;
+    label_index_t        label_index_m;
+    element_name_index_t element_name_index_m;
+    attribute_index_t    attribute_index_m;
+};
+
+/**************************************************************************************************/
+
+} // namespace adobe
+
+/**************************************************************************************************/
+
+#endif
+
+/**************************************************************************************************/
@@ -0,0 +1,112 @@
+/*
+    Copyright 2013 Adobe
+    Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*/
+/**************************************************************************************************/
+
+#define BOOST_TEST_MAIN
+
+#include <boost/test/unit_test.hpp>
+
+#include <stdexcept>
+#include <string>
+
+#include <boost/bind.hpp>
+
+#include <adobe/future/behavior.hpp>
+
+/**************************************************************************************************/
+
+namespace {
+
+/**************************************************************************************************/
+
+void record(std::string& log, char c)
+{ log += c; }
+
+/**************************************************************************************************/
+
+void record_and_insert(adobe::behavior_t& behavior, std::string& log, char c, char next)
+{
+    log += c;
+
+    behavior.insert(boost::bind(&record, boost::ref(log), next));
+}
+
+/**************************************************************************************************/
+
+void fail()
+{ throw std::runtime_error("fail"); }
+
+/**************************************************************************************************/
+
+} // namespace
+
+/**************************************************************************************************/
+
+BOOST_AUTO_TEST_CASE(behavior_single_execution)
+{
+    adobe::behavior_t behavior(true);
+    std::string       log;
+
+    // a verb scheduling more work leaves it for the next execution
+
+    behavior.insert(boost::bind(&record_and_insert, boost::ref(behavior), boost::ref(log), 'a', 'c'));
+    behavior.insert(boost::bind(&record, boost::ref(log), 'b'));
+
+    behavior();
+
+    BOOST_CHECK_EQUAL(log, "ab");
+    BOOST_CHECK_EQUAL(behavior.size(), 1u);
+
+    behavior();
+
+    BOOST_CHECK_EQUAL(log, "abc");
+    BOOST_CHECK(behavior.empty());
+}
+
+/**************************************************************************************************/
+
+BOOST_AUTO_TEST_CASE(behavior_single_execution_exception)
+{
+    adobe::behavior_t behavior(true);
+    std::string       log;
+
+    // the verb that throws is dropped; those after it run next time,
+    // ahead of anything scheduled before the throw
+
+    behavior.insert(boost::bind(&record_and_insert, boost::ref(behavior), boost::ref(log), 'a', 'd'));
+    behavior.insert(&fail);
+    behavior.insert(boost::bind(&record, boost::ref(log), 'b'));
+    behavior.insert_behavior(true)->insert(boost::bind(&record, boost::ref(log), 'c'));
+
+    BOOST_CHECK_THROW(behavior(), std::runtime_error);
+
+    BOOST_CHECK_EQUAL(log, "a");
+    BOOST_CHECK_EQUAL(behavior.size(), 3u);
+
+    behavior();
+
+    BOOST_CHECK_EQUAL(log, "abcd");
+    BOOST_CHECK(behavior.empty());
+}
+
+/**************************************************************************************************/
+
+BOOST_AUTO_TEST_CASE(behavior_repeated_execution)
+{
+    adobe::behavior_t behavior(false);
+    std::string       log;
+
+    behavior.insert(boost::bind(&record, boost::ref(log), 'a'));
+    behavior.insert_behavior(false)->insert(boost::bind(&record, boost::ref(log), 'b'));
+
+    behavior();
+    behavior();
+
+    BOOST_CHECK_EQUAL(log, "abab");
+    BOOST_CHECK_EQUAL(behavior.size(), 2u);
+}
+
+/**************************************************************************************************/
@@ -0,0 +1,208 @@
+/*
+    Copyright 2013 Adobe
+    Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*/
+/******************************************************************************/
+
+#define BOOST_TEST_MAIN
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+#include <adobe/filtered_sequence_model.hpp>
+#include <adobe/sequence_hooks.hpp>
+#include <adobe/sequence_model.hpp>
+#include <adobe/sorted_sequence_model.hpp>
+
+#include "../sequence_mirror_view.hpp"
+
+/******************************************************************************/
+
+namespace {
+
+/******************************************************************************/
+
+typedef adobe::sequence_model<int>          model_type;
+typedef adobe::filtered_sequence_model<int> filtered_type;
+typedef adobe::sorted_sequence_model<int>   sorted_type;
+typedef model_type::key_type                key_type;
+typedef adobe::sequence_mirror_view_t<int>  mirror_view_t;
+
+/******************************************************************************/
+
+int  threshold_g(500);
+bool descending_g(false);
+
+bool passes(const int& x)
+{ return x < threshold_g; }
+
+bool descending(const int& x, const int& y)
+{ return y < x; }
+
+/******************************************************************************/
+
+template <typename DerivedModel>
+bool consistent(const DerivedModel&     derived,
+                const mirror_view_t&    mirror,
+                const std::vector<int>& expected)
+{
+    if (derived.size() != expected.size() || mirror.key_set_m.size() != expected.size())
+        return false;
+
+    if (mirror.unknown_refresh_m)
+        return false;
+
+    for (std::size_t i(0); i != expected.size(); ++i)
+    {
+        key_type key(derived.key_at(i));
+
+        if (mirror.key_set_m[i] != key ||
+            *DerivedModel::at(key) != expected[i] ||
+            derived.position_of(key) != i)
+            return false;
+    }
+
+    return true;
+}
+
+/******************************************************************************/
+
+} // namespace
+
+/******************************************************************************/
+
+BOOST_AUTO_TEST_CASE(derived_sequence_model)
+{
+    model_type          model;
+    filtered_type       filtered(&passes);
+    sorted_type         sorted;
+    mirror_view_t       filtered_view;
+    mirror_view_t       sorted_view;
+    adobe::assemblage_t assemblage;
+
+    std::srand(11);
+
+    for (int i(0); i != 200; ++i)
+        model.push_back(std::rand() % 1000);
+
+    // attached after the source has contents, and with a view attached
+    // before the derived model is
+
+    adobe::attach_sequence_view_to_sequence_model(assemblage, filtered, filtered_view);
+    adobe::attach_sequence_view_to_sequence_model(assemblage, model, filtered);
+    adobe::attach_sequence_view_to_sequence_model(assemblage, model, sorted);
+    adobe::attach_sequence_view_to_sequence_model(assemblage, sorted, sorted_view);
+
+    for (int step(0); step != 3000; ++step)
+    {
+        std::size_t size(model.size());
+        key_type    key(size == 0 ? key_type::nkey : model.key_at(std::rand() % size));
+        int         value(std::rand() % 1000);
+
+        switch (std::rand() % 8)
+        {
+            case 0: model.push_back(value);   break;
+            case 1: model.insert(key, value); break;
+            case 2:
+            case 3: model.set(key, value);    break;
+            case 4:
+            {
+                std::vector<key_type> key_set(1, key);
+
+                model.erase(key_set);
+            }
+            break;
+            case 5:
+            {
+                std::vector<int> value_set(std::rand() % 5 + 1, value);
+
+                value_set.back() = std::rand() % 1000;
+
+                model.insert_set(key, value_set);
+            }
+            break;
+            case 6:
+            {
+                model_type::transaction_t transaction(model);
+
+                model.set(key, value);
+                model.push_back(value / 2);
+            }
+            break;
+            case 7:
+                if (step % 2 == 0)
+                {
+                    threshold_g = std::rand() % 1000;
+
+                    filtered.set_predicate(&passes);
+                }
+                else if (step % 5 == 0)
+                {
+                    descending_g = !descending_g;
+
+                    sorted.set_compare(descending_g ? sorted_type::compare_t(&descending) :
+                                                      sorted_type::compare_t(std::less<int>()));
+                }
+            break;
+        }
+
+        std::vector<int> source;
+
+        for (std::size_t i(0); i != model.size(); ++i)
+            source.push_back(*model_type::at(model.key_at(i)));
+
+        std::vector<int> expected_filtered;
+
+        for (std::size_t i(0); i != source.size(); ++i)
+            if (passes(source[i]))
+                expected_filtered.push_back(source[i]);
+
+        std::vector<int> expected_sorted(source);
+
+        if (descending_g)
+            std::sort(expected_sorted.begin(), expected_sorted.end(), &descending);
+        else
+            std::sort(expected_sorted.begin(), expected_sorted.end());
+
+        if (!consistent(filtered, filtered_view, expected_filtered))
+        {
+            BOOST_ERROR("filtered model does not follow the source");
+
+            break;
+        }
+
+        if (!consistent(sorted, sorted_view, expected_sorted))
+        {
+            BOOST_ERROR("sorted model does not follow the source");
+
+            break;
+        }
+    }
+
+    // a set that keeps the element in place is a refresh
+
+    std::size_t count(sorted_view.notification_count());
+    key_type    middle(sorted.key_at(sorted.size() / 2));
+
+    model.set(middle, *model_type::at(middle));
+
+    BOOST_CHECK_MESSAGE(sorted_view.notification_count() == count + 1,
+                        "set in place is one refresh");
+
+    std::cout << model.size() << " elements, " << filtered.size() << " through the filter"
+              << std::endl;
+
+    model.clear();
+
+    BOOST_CHECK_MESSAGE(filtered.empty() && filtered_view.key_set_m.empty(),
+                        "filtered model cleared");
+    BOOST_CHECK_MESSAGE(sorted.empty() && sorted_view.key_set_m.empty(), "sorted model cleared");
+}
+
+/******************************************************************************/
@@ -260,6 +260,26 @@ try
         std::cout << "pass_through(long, long): " << std::boolalpha << passes_through(long_path, long_path) << std::endl;
     }
 
+    {
+        // deeper than a bitpath_t keeps inline
+
+        adobe::bitpath_t deep_path;
+
+        for (int i(0); i != 200; ++i)
+            deep_path.push(i % 3 == 0);
+
+        adobe::bitpath_t imported(deep_path.portable());
+        adobe::bitpath_t popped(deep_path);
+
+        while (popped.size() > 16)
+            popped.pop();
+
+        std::cout << "deep_path size: " << deep_path.size()
+                  << ", round-trip: " << std::boolalpha << (imported == deep_path)
+                  << ", passes through its prefix: " << passes_through(deep_path, popped)
+                  << std::endl;
+    }
+
     return 0;
 }
 catch(const std::exception& error)
@@ -7,7 +7,9 @@
 /**************************************************************************************************/
 
 #include <iostream>
+#include <iterator>
 #include <sstream>
+#include <vector>
 
 #include <adobe/function_pack.hpp>
 
@@ -21,6 +23,10 @@
 #define TEST_ARITY_5_SUITE 1
 #define TEST_ARITY_6_SUITE 1
 #define TEST_ARITY_7_SUITE 1
+#define TEST_ARITY_10_SUITE 1
+#define TEST_BATCH_SUITE 1
+#define TEST_LOOKUP_SUITE 1
+#define TEST_TRY_INVOKE_SUITE 1
 
 /**************************************************************************************************/
 
@@ -65,6 +71,51 @@ inline void test_pack(adobe::function_pack_t& pack, adobe::name_t function, cons
               << ", result: " << result.str() << std::endl;
 }
 
+/**************************************************************************************************/
+/*
+    Calls the prepared form of a named function twice: with the named argument set, and with the
+    same arguments laid out in slot order.
+*/
+inline void test_prepared(adobe::function_pack_t&    pack,
+                          adobe::name_t              function,
+                          const adobe::dictionary_t& named_argument_set)
+{
+    adobe::prepared_function_t prepared(pack.prepare(function));
+    adobe::array_t             slot_set;
+    adobe::any_regular_t       named_result;
+    adobe::any_regular_t       slot_result;
+
+    for (std::size_t i(0); i != prepared.arity(); ++i)
+    {
+        adobe::dictionary_t::const_iterator found(named_argument_set.find(prepared.name_set()[i]));
+
+        if (found != named_argument_set.end())
+            slot_set.push_back(found->second);
+    }
+
+    bool named_called(prepared(named_argument_set, named_result));
+    bool slot_called(prepared(slot_set, slot_result));
+
+    std::cout << "    prepared: " << function.c_str()
+              << ", arity: " << prepared.arity()
+              << ", arg_set_empty: " << std::boolalpha << named_argument_set.empty()
+              << ", named result: ";
+
+    if (named_called)
+        std::cout << named_result;
+    else
+        std::cout << "not called";
+
+    std::cout << ", slot result: ";
+
+    if (slot_called)
+        std::cout << slot_result;
+    else
+        std::cout << "not called";
+
+    std::cout << std::endl;
+}
+
 /**************************************************************************************************/
 
 template <typename T>
@@ -250,6 +301,18 @@ void test_pack_all(adobe::function_pack_t& pack)
     test_pack(pack, name_fn_obj, empty_named_argument_set);
     test_pack(pack, name_mem_fn, empty_named_argument_set);
     test_pack(pack, name_cmem_fn, empty_named_argument_set);
+
+    std::cout << "  Prepared, should be called:" << std::endl;
+
+    test_prepared(pack, name_fn_ptr, named_argument_set);
+    test_prepared(pack, name_fn_obj, named_argument_set);
+    test_prepared(pack, name_mem_fn, named_argument_set);
+    test_prepared(pack, name_cmem_fn, named_argument_set);
+
+    std::cout << "  Prepared, should not be called:" << std::endl;
+
+    test_prepared(pack, name_fn_ptr, empty_named_argument_set);
+    test_prepared(pack, name_mem_fn, empty_named_argument_set);
 }
 
 /**************************************************************************************************/
@@ -631,6 +694,376 @@ void test()
 } // namespace arity_7
 #endif
 /**************************************************************************************************/
+#if TEST_ARITY_10_SUITE
+namespace arity_10 {
+
+/**************************************************************************************************/
+/*
+    Past the arity of struct_t's member functions: a function of ten arguments, mixing promoted
+    (int, long) and stored (std::string, adobe::name_t) types.
+*/
+double free(int x0, long x1, double x2, const std::string& x3, adobe::name_t x4,
+            int x5, long x6, double x7, const std::string& x8, adobe::name_t x9) // free function
+{
+    return x0 + x1 + x2 + x3.size() + std::strlen(x4.c_str()) +
+           x5 + x6 + x7 + x8.size() + std::strlen(x9.c_str());
+}
+
+/**************************************************************************************************/
+
+void test()
+{
+    boost::function<double (int, long, double, const std::string&, adobe::name_t,
+                            int, long, double, const std::string&, adobe::name_t)> fn_obj(&free);
+    adobe::function_pack_t pack;
+
+    const adobe::name_t name_set[] =
+    {
+        adobe::"x0"_name, adobe::"x1"_name, adobe::"x2"_name, adobe::"x3"_name, adobe::"x4"_name,
+        adobe::"x5"_name, adobe::"x6"_name, adobe::"x7"_name, adobe::"x8"_name, adobe::"x9"_name
+    };
+
+    // unnamed function registration
+    pack.register_function(name_fn_ptr, &free);
+    pack.register_function(name_fn_obj, fn_obj);
+
+    // named function registration
+    pack.register_function(name_fn_ptr, &free, name_set[0], name_set[1], name_set[2], name_set[3],
+                           name_set[4], name_set[5], name_set[6], name_set[7], name_set[8],
+                           name_set[9]);
+    pack.register_function(name_fn_obj, fn_obj, name_set[0], name_set[1], name_set[2], name_set[3],
+                           name_set[4], name_set[5], name_set[6], name_set[7], name_set[8],
+                           name_set[9]);
+
+    adobe::array_t      unnamed_argument_set;
+    adobe::dictionary_t named_argument_set;
+
+    for (std::size_t i(0); i != 2; ++i)
+    {
+        insert_argument(unnamed_argument_set, sample_integer);
+        insert_argument(unnamed_argument_set, sample_integer);
+        insert_argument(unnamed_argument_set, sample_double);
+        insert_argument(unnamed_argument_set, sample_string);
+        insert_argument(unnamed_argument_set, sample_name);
+    }
+
+    for (std::size_t i(0); i != unnamed_argument_set.size(); ++i)
+        named_argument_set.insert(adobe::dictionary_t::value_type(name_set[i],
+                                                                  unnamed_argument_set[i]));
+
+    std::cout << "  Should pass:" << std::endl;
+
+    test_pack(pack, name_fn_ptr, unnamed_argument_set);
+    test_pack(pack, name_fn_obj, unnamed_argument_set);
+
+    test_pack(pack, name_fn_ptr, named_argument_set);
+    test_pack(pack, name_fn_obj, named_argument_set);
+
+    std::cout << "  Should fail:" << std::endl;
+
+    unnamed_argument_set.pop_back();
+    named_argument_set.erase(name_set[9]);
+
+    test_pack(pack, name_fn_ptr, unnamed_argument_set);
+    test_pack(pack, name_fn_ptr, named_argument_set);
+
+    std::cout << "  Prepared, should not be called:" << std::endl;
+
+    test_prepared(pack, name_fn_obj, named_argument_set);
+
+    std::cout << "  Prepared, should be called:" << std::endl;
+
+    insert_argument(named_argument_set, name_set[9], sample_name);
+
+    test_prepared(pack, name_fn_ptr, named_argument_set);
+    test_prepared(pack, name_fn_obj, named_argument_set);
+}
+
+/**************************************************************************************************/
+
+} // namespace arity_10
+#endif
+/**************************************************************************************************/
+#if TEST_BATCH_SUITE
+namespace batch {
+
+/**************************************************************************************************/
+
+double scale(double x, double factor)
+{ return x * factor; }
+
+double check_positive(double x)
+{
+    if (x <= 0)
+        throw std::runtime_error("not positive");
+
+    return x;
+}
+
+// The unnamed forms: a command array holds the function name ahead of the arguments.
+
+double unnamed_scale(adobe::name_t, double x, double factor)
+{ return scale(x, factor); }
+
+double unnamed_check_positive(adobe::name_t, double x)
+{ return check_positive(x); }
+
+/**************************************************************************************************/
+
+template <typename T>
+void test_batch(const adobe::function_pack_t& pack, const std::vector<T>& command_set)
+{
+    std::vector<adobe::function_result_t> result_set;
+
+    pack.invoke_batch(command_set.begin(), command_set.end(), std::back_inserter(result_set));
+
+    std::cout << "  arg_set_type: '" << adobe::type_info<T>().name()
+              << "', command count: " << command_set.size()
+              << ", result count: " << result_set.size() << std::endl;
+
+    for (std::size_t i(0); i != result_set.size(); ++i)
+    {
+        std::cout << "    command " << i << ", result: ";
+
+        try
+        {
+            result_set[i].rethrow();
+
+            std::cout << result_set[i].value_m;
+        }
+        catch (const std::exception& error)
+        {
+            std::cout << "\"Exception: " << error.what() << '"';
+        }
+
+        std::cout << std::endl;
+    }
+}
+
+/**************************************************************************************************/
+
+void test()
+{
+    const adobe::name_t name_scale(adobe::"scale"_name);
+    const adobe::name_t name_check_positive(adobe::"check_positive"_name);
+    const adobe::name_t name_factor(adobe::"factor"_name);
+
+    adobe::function_pack_t pack;
+
+    pack.register_function(name_scale, &unnamed_scale);
+    pack.register_function(name_check_positive, &unnamed_check_positive);
+    pack.register_function(name_scale, &scale, name_double, name_factor);
+    pack.register_function(name_check_positive, &check_positive, name_double);
+
+    std::vector<adobe::array_t>      unnamed_command_set;
+    std::vector<adobe::dictionary_t> named_command_set;
+
+    for (std::size_t i(0); i != 6; ++i)
+    {
+        // an unknown function, a command missing an argument and a call that throws
+
+        adobe::name_t function(i == 5 ? name_check_positive :
+                               i == 2 ? adobe::"unknown"_name :
+                               name_scale);
+        double        x(i == 5 ? -1.0 : static_cast<double>(i));
+
+        adobe::array_t      unnamed_command;
+        adobe::dictionary_t named_command;
+
+        insert_argument(unnamed_command, function);
+        insert_argument(named_command, adobe::"command"_name, function);
+
+        if (i != 3)
+        {
+            insert_argument(unnamed_command, x);
+            insert_argument(named_command, name_double, x);
+        }
+
+        if (function == name_scale)
+        {
+            insert_argument(unnamed_command, 10.0);
+            insert_argument(named_command, name_factor, 10.0);
+        }
+
+        unnamed_command_set.push_back(unnamed_command);
+        named_command_set.push_back(named_command);
+    }
+
+    test_batch(pack, unnamed_command_set);
+    test_batch(pack, named_command_set);
+
+    std::vector<adobe::any_regular_t> mixed_command_set;
+
+    mixed_command_set.push_back(adobe::any_regular_t(named_command_set[1]));
+    mixed_command_set.push_back(adobe::any_regular_t(sample_double));
+    mixed_command_set.push_back(adobe::any_regular_t(named_command_set[4]));
+
+    test_batch(pack, mixed_command_set);
+}
+
+/**************************************************************************************************/
+
+} // namespace batch
+#endif
+/**************************************************************************************************/
+#if TEST_LOOKUP_SUITE
+namespace lookup {
+
+/**************************************************************************************************/
+
+double first()
+{ return 1; }
+
+double second()
+{ return 2; }
+
+/**************************************************************************************************/
+
+template <typename T>
+void test_call(adobe::virtual_machine_t& vm, adobe::name_t function, const T& argument_set)
+{
+    adobe::array_t expression;
+
+    expression.push_back(adobe::any_regular_t(argument_set));
+    expression.push_back(adobe::any_regular_t(function));
+    expression.push_back(adobe::any_regular_t(adobe::".function"_name));
+
+    vm.evaluate(expression);
+
+    std::cout << "    call: " << function.c_str()
+              << ", arg_set_type: '" << adobe::type_info<T>().name()
+              << "', result: " << vm.back().value_m << std::endl;
+
+    vm.pop_back();
+}
+
+/**************************************************************************************************/
+/*
+    The machine keeps the functions it has called in its lookup cache; registering into or
+    clearing the pack must send it back to the pack.
+*/
+void test()
+{
+    const adobe::array_t      unnamed_argument_set;
+    const adobe::dictionary_t named_argument_set;
+
+    adobe::function_pack_t   pack;
+    adobe::virtual_machine_t vm;
+
+    pack.register_function(name_fn_ptr, &first);
+    pack.register_named0_function(name_fn_ptr, &first);
+
+    attach(vm, pack);
+
+    std::cout << "  Should be 1:" << std::endl;
+
+    test_call(vm, name_fn_ptr, unnamed_argument_set);
+    test_call(vm, name_fn_ptr, named_argument_set);
+    test_call(vm, name_fn_ptr, unnamed_argument_set);
+    test_call(vm, name_fn_ptr, named_argument_set);
+
+    pack.clear();
+
+    pack.register_function(name_fn_ptr, &second);
+    pack.register_named0_function(name_fn_ptr, &second);
+
+    std::cout << "  Should be 2:" << std::endl;
+
+    test_call(vm, name_fn_ptr, unnamed_argument_set);
+    test_call(vm, name_fn_ptr, named_argument_set);
+}
+
+/**************************************************************************************************/
+
+} // namespace lookup
+#endif
+/**************************************************************************************************/
+#if TEST_TRY_INVOKE_SUITE
+namespace try_invoke {
+
+/**************************************************************************************************/
+
+double scale(double x, double factor)
+{ return x * factor; }
+
+adobe::any_regular_t raw(const adobe::dictionary_t& named_argument_set)
+{ return adobe::any_regular_t(static_cast<double>(named_argument_set.size())); }
+
+/**************************************************************************************************/
+
+template <typename T>
+void test_try_invoke(const adobe::function_pack_t& pack,
+                     adobe::name_t                 function,
+                     const T&                      argument_set)
+{
+    adobe::try_invoke_result_t result(pack.try_invoke(function, argument_set));
+
+    std::cout << "    call: " << function.c_str()
+              << ", arg_set_type: '" << adobe::type_info<T>().name()
+              << "', status: " << result.status_m
+              << ", result: ";
+
+    if (result.succeeded())
+        std::cout << result.value_m;
+    else
+        std::cout << '"' << result.message() << '"';
+
+    std::cout << std::endl;
+}
+
+/**************************************************************************************************/
+
+void test()
+{
+    const adobe::name_t name_scale(adobe::"scale"_name);
+    const adobe::name_t name_raw(adobe::"raw"_name);
+    const adobe::name_t name_factor(adobe::"factor"_name);
+
+    adobe::function_pack_t pack;
+
+    pack.register_function(name_scale, &scale);
+    pack.register_function(name_scale, &scale, name_double, name_factor);
+    pack.register_named(name_raw, &raw);
+
+    adobe::array_t      unnamed_argument_set;
+    adobe::dictionary_t named_argument_set;
+
+    insert_argument(unnamed_argument_set, sample_double);
+    insert_argument(unnamed_argument_set, 2.0);
+    insert_argument(named_argument_set, name_double, sample_double);
+    insert_argument(named_argument_set, name_factor, 2.0);
+
+    std::cout << "  Should be called:" << std::endl;
+
+    test_try_invoke(pack, name_scale, unnamed_argument_set);
+    test_try_invoke(pack, name_scale, named_argument_set);
+    test_try_invoke(pack, name_raw, named_argument_set);
+
+    std::cout << "  Should not be called:" << std::endl;
+
+    test_try_invoke(pack, adobe::name_t(), named_argument_set);
+    test_try_invoke(pack, name_raw, unnamed_argument_set);
+
+    adobe::array_t      short_argument_set(1, unnamed_argument_set[0]);
+    adobe::dictionary_t mistyped_argument_set(named_argument_set);
+
+    mistyped_argument_set[name_factor] = adobe::any_regular_t(sample_string);
+
+    test_try_invoke(pack, name_scale, short_argument_set);
+    test_try_invoke(pack, name_scale, mistyped_argument_set);
+
+    named_argument_set.erase(name_factor);
+    unnamed_argument_set[1] = adobe::any_regular_t(sample_name);
+
+    test_try_invoke(pack, name_scale, unnamed_argument_set);
+    test_try_invoke(pack, name_scale, named_argument_set);
+}
+
+/**************************************************************************************************/
+
+} // namespace try_invoke
+#endif
+/**************************************************************************************************/
 
 } // namespace
 
@@ -679,6 +1112,26 @@ try
     arity_7::test();
 #endif
 
+#if TEST_ARITY_10_SUITE
+    std::cout << "Arity 10 Test Suite:" << std::endl;
+    arity_10::test();
+#endif
+
+#if TEST_BATCH_SUITE
+    std::cout << "Batch Test Suite:" << std::endl;
+    batch::test();
+#endif
+
+#if TEST_LOOKUP_SUITE
+    std::cout << "Lookup Test Suite:" << std::endl;
+    lookup::test();
+#endif
+
+#if TEST_TRY_INVOKE_SUITE
+    std::cout << "Try Invoke Test Suite:" << std::endl;
+    try_invoke::test();
+#endif
+
     return 0;
 }
 catch (const std::exception& error)
@@ -0,0 +1,269 @@
+/*
+    Copyright 2013 Adobe
+    Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*/
+/****************************************************************************************************/
+
+#include <adobe/config.hpp>
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <adobe/function_pack.hpp>
+#include <adobe/timer.hpp>
+
+/****************************************************************************************************/
+
+namespace {
+
+/****************************************************************************************************/
+
+double sum_g(0);
+
+double command(double x, const std::string& label, adobe::name_t name)
+{
+    sum_g += x + label.size() + (name == adobe::name_t() ? 0 : 1);
+
+    return sum_g;
+}
+
+/****************************************************************************************************/
+
+inline double nanoseconds_per_op(double milliseconds, std::size_t count)
+{ return milliseconds * 1e6 / count; }
+
+void report(const char* label, double time, std::size_t op_count)
+{
+    std::cout << std::setw(28) << label
+              << std::setw(14) << time
+              << std::setw(14) << nanoseconds_per_op(time, op_count)
+              << std::endl;
+}
+
+/****************************************************************************************************/
+
+} // namespace
+
+/****************************************************************************************************/
+
+int main(int argc, char** argv)
+try
+{
+    std::size_t op_count(1000000);
+
+    if (argc > 1)
+        op_count = std::atoi(argv[1]);
+
+    const adobe::name_t name_command("command");
+    const adobe::name_t name_x("x");
+    const adobe::name_t name_label("label");
+    const adobe::name_t name_name("name");
+
+    adobe::function_pack_t pack;
+
+    pack.register_function(name_command, &command);
+    pack.register_function(name_command, &command, name_x, name_label, name_name);
+
+    adobe::dictionary_t named_argument_set;
+
+    named_argument_set[name_x] = adobe::any_regular_t(1.5);
+    named_argument_set[name_label] = adobe::any_regular_t(std::string("label"));
+    named_argument_set[name_name] = adobe::any_regular_t(name_x);
+
+    adobe::array_t argument_set;
+
+    argument_set.push_back(adobe::any_regular_t(1.5));
+    argument_set.push_back(adobe::any_regular_t(std::string("label")));
+    argument_set.push_back(adobe::any_regular_t(name_x));
+
+    std::cout << op_count << " calls of a three argument function: total milliseconds and "
+              << "nanoseconds per call:" << std::endl;
+
+    std::cout << std::setw(28) << "path"
+              << std::setw(14) << "total"
+              << std::setw(14) << "per call"
+              << std::endl;
+
+    {
+    adobe::timer_t timer;
+
+    for (std::size_t i(0); i != op_count; ++i)
+        pack(name_command, named_argument_set);
+
+    report("named, by name", timer.split(), op_count);
+    }
+
+    {
+    adobe::timer_t timer;
+
+    for (std::size_t i(0); i != op_count; ++i)
+        pack(name_command, argument_set);
+
+    report("unnamed, by name", timer.split(), op_count);
+    }
+
+    // as a virtual_machine_t attached to the pack calls it
+
+    adobe::function_pack_t::cached_lookup_t lookup(pack);
+
+    {
+    adobe::timer_t timer;
+
+    for (std::size_t i(0); i != op_count; ++i)
+        lookup(name_command, named_argument_set);
+
+    report("named, cached lookup", timer.split(), op_count);
+    }
+
+    {
+    adobe::timer_t timer;
+
+    for (std::size_t i(0); i != op_count; ++i)
+        lookup(name_command, argument_set);
+
+    report("unnamed, cached lookup", timer.split(), op_count);
+    }
+
+    adobe::prepared_function_t prepared(pack.prepare(name_command));
+    adobe::any_regular_t       result;
+
+    {
+    adobe::timer_t timer;
+
+    for (std::size_t i(0); i != op_count; ++i)
+        prepared(named_argument_set, result);
+
+    report("prepared, dictionary", timer.split(), op_count);
+    }
+
+    {
+    adobe::timer_t timer;
+
+    for (std::size_t i(0); i != op_count; ++i)
+        prepared(argument_set, result);
+
+    report("prepared, slots", timer.split(), op_count);
+    }
+
+    // a command stream: each command names its function under "command"
+
+    adobe::dictionary_t command(named_argument_set);
+
+    command[adobe::name_t("command")] = adobe::any_regular_t(name_command);
+
+    const std::size_t batch_size(1000);
+    const std::size_t batch_count(op_count / batch_size);
+
+    std::vector<adobe::dictionary_t>      command_set(batch_size, command);
+    std::vector<adobe::function_result_t> result_set(batch_size);
+
+    {
+    adobe::timer_t timer;
+
+    for (std::size_t i(0); i != batch_count; ++i)
+        for (std::size_t j(0); j != batch_size; ++j)
+            pack(command_set[j]);
+
+    report("stream, one at a time", timer.split(), batch_count * batch_size);
+    }
+
+    {
+    adobe::timer_t timer;
+
+    for (std::size_t i(0); i != batch_count; ++i)
+        pack.invoke_batch(command_set.begin(), command_set.end(), result_set.begin());
+
+    report("stream, batch", timer.split(), batch_count * batch_size);
+    }
+
+    // a missing argument: an exception on the existing path, false on the prepared one
+
+    adobe::dictionary_t incomplete_argument_set(named_argument_set);
+
+    incomplete_argument_set.erase(name_name);
+
+    std::size_t failure_count(op_count / 100);
+
+    {
+    adobe::timer_t timer;
+
+    for (std::size_t i(0); i != failure_count; ++i)
+    {
+        try
+        {
+            pack(name_command, incomplete_argument_set);
+        }
+        catch (const std::exception&)
+        { }
+    }
+
+    report("named, missing argument", timer.split(), failure_count);
+    }
+
+    {
+    adobe::timer_t timer;
+
+    for (std::size_t i(0); i != failure_count; ++i)
+        prepared(incomplete_argument_set, result);
+
+    report("prepared, missing argument", timer.split(), failure_count);
+    }
+
+    {
+    adobe::timer_t timer;
+
+    for (std::size_t i(0); i != failure_count; ++i)
+        pack.try_invoke(name_command, incomplete_argument_set);
+
+    report("try, missing argument", timer.split(), failure_count);
+    }
+
+    // probing for a function that is not there
+
+    const adobe::name_t name_optional("optional");
+
+    {
+    adobe::timer_t timer;
+
+    for (std::size_t i(0); i != failure_count; ++i)
+    {
+        try
+        {
+            pack(name_optional, named_argument_set);
+        }
+        catch (const std::exception&)
+        { }
+    }
+
+    report("named, missing function", timer.split(), failure_count);
+    }
+
+    {
+    adobe::timer_t timer;
+
+    for (std::size_t i(0); i != failure_count; ++i)
+        pack.try_invoke(name_optional, named_argument_set);
+
+    report("try, missing function", timer.split(), failure_count);
+    }
+
+    return sum_g != 0 ? 0 : 1;
+}
+catch (const std::exception& error)
+{
+    std::cerr << "Exception: " << error.what() << std::endl;
+
+    return 1;
+}
+catch (...)
+{
+    std::cerr << "Exception: unknown" << std::endl;
+
+    return 1;
+}
+
+/****************************************************************************************************/
@@ -0,0 +1,191 @@
+/*
+    Copyright 2013 Adobe
+    Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*/
+/******************************************************************************/
+
+#define BOOST_TEST_MAIN
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <adobe/sequence_hooks.hpp>
+#include <adobe/sequence_ingest_queue.hpp>
+#include <adobe/sequence_model.hpp>
+
+#include "../sequence_mirror_view.hpp"
+
+/******************************************************************************/
+
+namespace {
+
+/******************************************************************************/
+
+const int producer_count_k(8);
+const int item_count_k(20000);
+
+/******************************************************************************/
+/*
+    A value that is not default constructible and throws when the value
+    throw_on_s is copied or moved.
+*/
+struct throwing_t
+{
+    static int throw_on_s;
+
+    explicit throwing_t(int x) :
+        value_m(x)
+    { }
+
+    throwing_t(const throwing_t& x) :
+        value_m(x.value_m)
+    { check(); }
+
+    throwing_t(throwing_t&& x) :
+        value_m(x.value_m)
+    { check(); }
+
+    throwing_t& operator=(const throwing_t& x)
+    {
+        value_m = x.value_m;
+
+        check();
+
+        return *this;
+    }
+
+    void check() const
+    {
+        if (value_m == throw_on_s)
+            throw std::runtime_error("throwing_t");
+    }
+
+    int value_m;
+};
+
+int throwing_t::throw_on_s(-1);
+
+/******************************************************************************/
+
+} // namespace
+
+/******************************************************************************/
+
+BOOST_AUTO_TEST_CASE(sequence_ingest_queue_producers)
+{
+    typedef adobe::sequence_model<int>        model_type;
+    typedef adobe::sequence_ingest_queue<int> queue_type;
+
+    model_type                         model;
+    adobe::sequence_mirror_view_t<int> view;
+    adobe::assemblage_t                assemblage;
+    std::atomic<int>                   wakeup_count(0);
+
+    adobe::attach_sequence_view_to_sequence_model(assemblage, model, view);
+
+    queue_type queue(model, [&wakeup_count]() { ++wakeup_count; });
+
+    std::vector<std::thread> producer_set;
+
+    for (int producer(0); producer != producer_count_k; ++producer)
+        producer_set.push_back(std::thread([&queue, producer]()
+        {
+            for (int i(0); i != item_count_k; ++i)
+                queue.push_back(producer * item_count_k + i);
+        }));
+
+    // the owning thread applies batches of bounded size while the
+    // producers are still running
+
+    std::size_t batch_count(0);
+    std::size_t total(producer_count_k * item_count_k);
+
+    while (model.size() != total)
+    {
+        if (queue.apply(4096) != 0)
+            ++batch_count;
+        else
+            std::this_thread::yield();
+    }
+
+    for (std::vector<std::thread>::iterator iter(producer_set.begin()),
+         last(producer_set.end()); iter != last; ++iter)
+        iter->join();
+
+    BOOST_CHECK(queue.apply() == 0);
+    BOOST_CHECK(queue.pending() == 0);
+
+    // the items each producer pushed, in the order the view has them
+
+    std::vector<std::vector<int> > received(producer_count_k);
+
+    for (std::vector<model_type::key_type>::const_iterator iter(view.key_set_m.begin()),
+         last(view.key_set_m.end()); iter != last; ++iter)
+    {
+        int value(*model_type::at(*iter));
+
+        received[value / item_count_k].push_back(value % item_count_k);
+    }
+
+    for (int producer(0); producer != producer_count_k; ++producer)
+    {
+        BOOST_CHECK_EQUAL(received[producer].size(), std::size_t(item_count_k));
+
+        for (std::size_t i(0); i != received[producer].size(); ++i)
+            if (received[producer][i] != int(i))
+            {
+                BOOST_ERROR("per producer order not kept");
+
+                break;
+            }
+    }
+
+    // one round of notifications per batch
+
+    BOOST_CHECK(view.notification_count() <= batch_count * 2);
+    BOOST_CHECK(wakeup_count.load() != 0);
+
+    std::cout << total << " items in " << batch_count << " batches, "
+              << view.notification_count() << " notifications, "
+              << wakeup_count.load() << " wakeups" << std::endl;
+}
+
+/******************************************************************************/
+
+BOOST_AUTO_TEST_CASE(sequence_ingest_queue_exception)
+{
+    typedef adobe::sequence_model<throwing_t>        model_type;
+    typedef adobe::sequence_ingest_queue<throwing_t> queue_type;
+
+    model_type model;
+    queue_type queue(model);
+
+    queue.push_back(throwing_t(1));
+    queue.push_back(throwing_t(2));
+    queue.push_back(throwing_t(3));
+    queue.erase(model_type::key_type::nkey);
+
+    // the mutation that throws is dropped; those after it stay queued
+
+    throwing_t::throw_on_s = 2;
+
+    BOOST_CHECK_THROW(queue.apply(), std::runtime_error);
+    BOOST_CHECK_EQUAL(model.size(), 1u);
+    BOOST_CHECK_EQUAL(queue.pending(), 2u);
+
+    throwing_t::throw_on_s = -1;
+
+    BOOST_CHECK_EQUAL(queue.apply(), 2u);
+    BOOST_CHECK_EQUAL(queue.pending(), 0u);
+    BOOST_REQUIRE_EQUAL(model.size(), 2u);
+    BOOST_CHECK_EQUAL(model_type::at(model.key_at(0))->value_m, 1);
+    BOOST_CHECK_EQUAL(model_type::at(model.key_at(1))->value_m, 3);
+}
+
+/******************************************************************************/
@@ -0,0 +1,123 @@
+/*
+    Copyright 2013 Adobe
+    Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*/
+/******************************************************************************/
+
+#ifndef ADOBE_TEST_SEQUENCE_MIRROR_VIEW_HPP
+#define ADOBE_TEST_SEQUENCE_MIRROR_VIEW_HPP
+
+/******************************************************************************/
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <adobe/copy_on_write.hpp>
+#include <adobe/sequence_model_fwd.hpp>
+
+/******************************************************************************/
+
+namespace adobe {
+
+/******************************************************************************/
+/*
+    A SequenceView implementing only the required notifications, shared
+    by the sequence_model tests. It rebuilds the order of the sequence it
+    is told about from the notifications alone, the way a list widget
+    would, and counts what it receives. Being told to remove a key it
+    does not hold fails the test.
+*/
+template <typename T>
+struct sequence_mirror_view_t
+{
+    typedef T                          value_type;
+    typedef copy_on_write<value_type>  cow_value_type;
+    typedef sequence_key<value_type>   key_type;
+    typedef std::vector<key_type>      key_set_t;
+
+    sequence_mirror_view_t() :
+        refresh_count_m(0),
+        extend_count_m(0),
+        erase_count_m(0),
+        unknown_refresh_m(false)
+    { }
+
+    void refresh(key_type key, cow_value_type)
+    {
+        ++refresh_count_m;
+
+        if (std::find(key_set_m.begin(), key_set_m.end(), key) == key_set_m.end())
+            unknown_refresh_m = true;
+    }
+
+    void extend(key_type before, key_type key, cow_value_type)
+    {
+        ++extend_count_m;
+
+        insert(before, key_set_t(1, key));
+    }
+
+    void extend_set(key_type before, const key_set_t& key_set)
+    {
+        ++extend_count_m;
+
+        insert(before, key_set);
+    }
+
+    void erase(const key_set_t& key_set)
+    {
+        ++erase_count_m;
+
+        remove(key_set);
+    }
+
+    void clear()
+    { key_set_m.clear(); }
+
+    /// refreshes, extends and erases received; clears are not counted
+    std::size_t notification_count() const
+    { return refresh_count_m + extend_count_m + erase_count_m; }
+
+    void insert(key_type before, const key_set_t& key_set)
+    {
+        key_set_m.insert(std::find(key_set_m.begin(), key_set_m.end(), before),
+                         key_set.begin(), key_set.end());
+    }
+
+    void remove(const key_set_t& key_set)
+    {
+        for (typename key_set_t::const_iterator iter(key_set.begin()), last(key_set.end());
+             iter != last; ++iter)
+        {
+            typename key_set_t::iterator found(std::find(key_set_m.begin(), key_set_m.end(), *iter));
+
+            if (found == key_set_m.end())
+            {
+                BOOST_ERROR("sequence_mirror_view_t: removing a key the view does not hold");
+
+                continue;
+            }
+
+            key_set_m.erase(found);
+        }
+    }
+
+    key_set_t   key_set_m;
+    std::size_t refresh_count_m;
+    std::size_t extend_count_m;
+    std::size_t erase_count_m;
+    bool        unknown_refresh_m; // a refresh arrived for a key not in key_set_m
+};
+
+/******************************************************************************/
+
+} // namespace adobe
+
+/******************************************************************************/
+// ADOBE_TEST_SEQUENCE_MIRROR_VIEW_HPP
+#endif
+/******************************************************************************/
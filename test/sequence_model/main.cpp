@@ -92,9 +92,6 @@ struct test_view
         print();
     }
 
-    key_type key_for(std::size_t index)
-    { return set_m[index]; }
-
 private:
     void print()
     {
@@ -138,11 +135,17 @@ try
     model_type          model;
     controller_type     controller;
     view_type           view;
+    view_type           window_view;
     adobe::assemblage_t assemblage;
 
     attach_sequence_controller_to_sequence_model(assemblage, model, controller);
     attach_sequence_view_to_sequence_model(assemblage, model, view);
 
+    // window_view only sees the elements at positions 1 and 2
+
+    model_type::poly_sequence_view_type& window(
+        attach_sequence_view_to_sequence_model(assemblage, model, window_view, 1, 2));
+
     assert(controller.sequence_m);
 
     controller.sequence_m->push_back(42);
@@ -151,12 +154,12 @@ try
     controller.sequence_m->push_back(4096);
     controller.sequence_m->push_back(8192);
 
-    controller.sequence_m->set(view.key_for(1), 777);
+    controller.sequence_m->set(model.key_at(1), 777);
 
     adobe::vector<key_type> erase_set;
 
-    erase_set.push_back(view.key_for(0));
-    erase_set.push_back(view.key_for(2));
+    erase_set.push_back(model.key_at(0));
+    erase_set.push_back(model.key_at(2));
 
     controller.sequence_m->erase(erase_set);
 
@@ -168,9 +171,88 @@ try
     insert_set.push_back(4);
     insert_set.push_back(5);
 
-    controller.sequence_m->insert_set(view.key_for(1), insert_set);
+    controller.sequence_m->insert_set(model.key_at(1), insert_set);
+
+    adobe::selection_t selection;
+
+    selection.push_back(1);
+    selection.push_back(3);
+
+    model.move_selection(selection, key_type::nkey);
+
+    model.set_view_window(window, 0, 3);
+
+    model.erase_selection(selection);
+
+    {
+    model_type::transaction_t transaction(model);
+
+    model.push_back(16384);
+    model.push_back(32768);
+    model.insert(model.key_at(0), 65536);
+    model.set(model.key_at(1), 999);
+    }
+
+    for (std::size_t i(0), count(model.size()); i != count; ++i)
+        assert(model.position_of(model.key_at(i)) == i);
+
+    assert(model.key_at(model.size()) == key_type::nkey);
+    assert(model.position_of(key_type::nkey) == model.size());
 
     controller.sequence_m->clear();
+
+    // a stale key is ignored even once its element's address has been
+    // reused; pooled allocation hands the freed node straight back
+
+    {
+    model_type pooled(model_type::pooled_allocation);
+
+    pooled.push_back(1);
+    pooled.push_back(2);
+
+    key_type stale(pooled.key_at(0));
+
+    pooled.erase(std::vector<key_type>(1, stale));
+    pooled.push_back(3);
+    pooled.set(stale, 99);
+
+    assert(pooled.size() == 2);
+    assert(model_type::at(pooled.key_at(0)).read() == 2);
+    assert(model_type::at(pooled.key_at(1)).read() == 3);
+    assert(pooled.position_of(stale) == pooled.size());
+    assert(pooled.key_at(1) != stale);
+
+    pooled.erase(std::vector<key_type>(1, stale));
+
+    assert(pooled.size() == 2);
+
+    // keys stay valid across a move
+
+    key_type moved(pooled.key_at(1));
+
+    adobe::selection_t last;
+
+    last.push_back(1);
+    last.push_back(2);
+
+    pooled.move_selection(last, pooled.key_at(0));
+
+    assert(pooled.key_at(0) == moved);
+    assert(pooled.position_of(moved) == 0);
+
+    // clearing a pooled model returns its chunks and starts afresh
+
+    pooled.clear();
+
+    assert(pooled.empty());
+    assert(pooled.position_of(moved) == pooled.size());
+
+    pooled.push_back(4);
+
+    assert(pooled.size() == 1);
+    assert(model_type::at(pooled.key_at(0)).read() == 4);
+    assert(pooled.position_of(moved) == pooled.size());
+    }
 }
 catch (const std::exception& error)
 {
@@ -0,0 +1,526 @@
+/*
+    Copyright 2013 Adobe
+    Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*/
+/****************************************************************************************************/
+
+#include <adobe/config.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <new>
+#include <vector>
+
+#include <adobe/filtered_sequence_model.hpp>
+#include <adobe/sequence_hooks.hpp>
+#include <adobe/sequence_model.hpp>
+#include <adobe/sorted_sequence_model.hpp>
+#include <adobe/timer.hpp>
+
+/****************************************************************************************************/
+
+namespace {
+
+/****************************************************************************************************/
+
+std::size_t allocation_count_g(0);
+
+/****************************************************************************************************/
+
+} // namespace
+
+/****************************************************************************************************/
+/*
+    Every heap allocation made by the benchmark is counted so the cost of
+    the storage strategies can be compared.
+*/
+void* operator new(std::size_t size)
+{
+    ++allocation_count_g;
+
+    void* result(std::malloc(size ? size : 1));
+
+    if (result == 0)
+        throw std::bad_alloc();
+
+    return result;
+}
+
+void operator delete(void* p) noexcept
+{ std::free(p); }
+
+/****************************************************************************************************/
+
+namespace {
+
+/****************************************************************************************************/
+
+typedef adobe::sequence_model<int> model_type;
+typedef model_type::key_type       key_type;
+
+/****************************************************************************************************/
+/*
+    A minimal SequenceView that only remembers the keys appended to the
+    end of the model, so the benchmark has keys to operate on without
+    paying for a mirror of the sequence.
+*/
+struct key_recorder_t
+{
+    typedef int                          value_type;
+    typedef adobe::copy_on_write<int>    cow_value_type;
+    typedef adobe::sequence_key<int>     key_type;
+
+    void refresh(key_type, cow_value_type)
+    { }
+
+    void extend(key_type before, key_type key, cow_value_type)
+    {
+        if (before == key_type::nkey)
+            key_set_m.push_back(key);
+    }
+
+    void extend_set(key_type, const std::vector<key_type>&)
+    { }
+
+    void erase(const std::vector<key_type>&)
+    { }
+
+    void clear()
+    { key_set_m.clear(); }
+
+    std::vector<key_type> key_set_m;
+};
+
+/****************************************************************************************************/
+
+inline double nanoseconds_per_op(double milliseconds, std::size_t count)
+{ return milliseconds * 1e6 / count; }
+
+/****************************************************************************************************/
+
+void bench(std::size_t size, std::size_t op_count)
+{
+    model_type          model;
+    key_recorder_t      recorder;
+    adobe::assemblage_t assemblage;
+
+    adobe::attach_sequence_view_to_sequence_model(assemblage, model, recorder);
+
+    for (std::size_t i(0); i < size; ++i)
+        model.push_back(static_cast<int>(i));
+
+    std::vector<key_type> key_set(recorder.key_set_m);
+
+    std::random_shuffle(key_set.begin(), key_set.end());
+
+    adobe::timer_t timer;
+
+    for (std::size_t i(0); i < op_count; ++i)
+        model.set(key_set[i % size], static_cast<int>(i));
+
+    double set_time(timer.split());
+
+    timer.reset();
+
+    for (std::size_t i(0); i < op_count; ++i)
+        model.insert(key_set[i % size], static_cast<int>(i));
+
+    double insert_time(timer.split());
+
+    // volatile so the queries are not optimized away
+
+    volatile std::size_t position_sum(0);
+
+    timer.reset();
+
+    for (std::size_t i(0); i < op_count; ++i)
+        position_sum += model.position_of(key_set[i % size]);
+
+    double position_time(timer.split());
+
+    timer.reset();
+
+    for (std::size_t i(0); i < op_count; ++i)
+        position_sum += model.key_at(position_sum % model.size()) == key_type::nkey;
+
+    double key_at_time(timer.split());
+
+    std::size_t           erase_count(std::min(op_count, size));
+    std::vector<key_type> erase_set(1);
+
+    timer.reset();
+
+    for (std::size_t i(0); i < erase_count; ++i)
+    {
+        erase_set[0] = key_set[i];
+
+        model.erase(erase_set);
+    }
+
+    double erase_time(timer.split());
+
+    std::cout << std::setw(10) << size
+              << std::setw(14) << nanoseconds_per_op(set_time, op_count)
+              << std::setw(14) << nanoseconds_per_op(insert_time, op_count)
+              << std::setw(14) << nanoseconds_per_op(erase_time, erase_count)
+              << std::setw(14) << nanoseconds_per_op(position_time, op_count)
+              << std::setw(14) << nanoseconds_per_op(key_at_time, op_count)
+              << std::endl;
+}
+
+/****************************************************************************************************/
+
+void bench_bulk_erase(std::size_t size)
+{
+    std::size_t erase_count(size / 2);
+    double      key_set_time(0);
+    double      selection_time(0);
+
+    {
+    model_type          model;
+    key_recorder_t      recorder;
+    adobe::assemblage_t assemblage;
+
+    adobe::attach_sequence_view_to_sequence_model(assemblage, model, recorder);
+
+    for (std::size_t i(0); i < size; ++i)
+        model.push_back(static_cast<int>(i));
+
+    std::vector<key_type> erase_set(recorder.key_set_m.begin() + size / 4,
+                                    recorder.key_set_m.begin() + size / 4 + erase_count);
+
+    adobe::timer_t timer;
+
+    model.erase(erase_set);
+
+    key_set_time = timer.split();
+    }
+
+    {
+    model_type model;
+
+    for (std::size_t i(0); i < size; ++i)
+        model.push_back(static_cast<int>(i));
+
+    adobe::selection_t selection;
+
+    selection.push_back(size / 4);
+    selection.push_back(size / 4 + erase_count);
+
+    adobe::timer_t timer;
+
+    model.erase_selection(selection);
+
+    selection_time = timer.split();
+    }
+
+    std::cout << std::setw(10) << size
+              << std::setw(14) << erase_count
+              << std::setw(14) << key_set_time
+              << std::setw(14) << selection_time
+              << std::endl;
+}
+
+/****************************************************************************************************/
+/*
+    Counts the notifications a view receives.
+*/
+struct counting_view_t
+{
+    typedef int                          value_type;
+    typedef adobe::copy_on_write<int>    cow_value_type;
+    typedef adobe::sequence_key<int>     key_type;
+
+    counting_view_t() : count_m(0) { }
+
+    void refresh(key_type, cow_value_type)
+    { ++count_m; }
+
+    void extend(key_type, key_type, cow_value_type)
+    { ++count_m; }
+
+    void extend_set(key_type, const std::vector<key_type>& key_set)
+    { count_m += key_set.size(); }
+
+    void erase(const std::vector<key_type>& key_set)
+    { count_m += key_set.size(); }
+
+    void clear()
+    { }
+
+    std::size_t count_m;
+};
+
+/****************************************************************************************************/
+
+void bench_window(std::size_t size, std::size_t op_count)
+{
+    model_type model;
+
+    for (std::size_t i(0); i < size; ++i)
+        model.push_back(static_cast<int>(i));
+
+    counting_view_t     full_view;
+    counting_view_t     window_view;
+    adobe::assemblage_t assemblage;
+    adobe::timer_t      timer;
+
+    adobe::attach_sequence_view_to_sequence_model(assemblage, model, full_view);
+
+    double full_attach_time(timer.split());
+
+    timer.reset();
+
+    adobe::attach_sequence_view_to_sequence_model(assemblage, model, window_view, size / 2, 40);
+
+    double window_attach_time(timer.split());
+
+    full_view.count_m = 0;
+    window_view.count_m = 0;
+
+    for (std::size_t i(0); i < op_count; ++i)
+        model.set(model.key_at(std::rand() % size), static_cast<int>(i));
+
+    std::cout << std::setw(10) << size
+              << std::setw(14) << full_attach_time
+              << std::setw(14) << window_attach_time
+              << std::setw(14) << full_view.count_m
+              << std::setw(14) << window_view.count_m
+              << std::endl;
+}
+
+/****************************************************************************************************/
+
+void bench_allocation(std::size_t size, model_type::allocation_t allocation)
+{
+    model_type          model(allocation);
+    counting_view_t     view;
+    adobe::assemblage_t assemblage;
+
+    std::size_t    allocation_count(allocation_count_g);
+    adobe::timer_t timer;
+
+    for (std::size_t i(0); i < size; ++i)
+        model.push_back(static_cast<int>(i));
+
+    double      fill_time(timer.split());
+    std::size_t fill_allocations(allocation_count_g - allocation_count);
+
+    // attaching a full view walks the whole of storage
+
+    timer.reset();
+
+    adobe::attach_sequence_view_to_sequence_model(assemblage, model, view);
+
+    double walk_time(timer.split());
+
+    timer.reset();
+
+    model.clear();
+
+    double clear_time(timer.split());
+
+    std::cout << std::setw(10) << size
+              << std::setw(10) << (allocation == model_type::pooled_allocation ? "pooled" : "heap")
+              << std::setw(14) << fill_allocations
+              << std::setw(14) << fill_time
+              << std::setw(14) << walk_time
+              << std::setw(14) << clear_time
+              << std::endl;
+}
+
+/****************************************************************************************************/
+
+bool below_half(const int& x)
+{ return x < RAND_MAX / 2; }
+
+/****************************************************************************************************/
+/*
+    Cost of keeping a filtered and a sorted list up to date as single
+    elements of the source are set: through the derived models, and by
+    rebuilding the derived list from a plain copy of the source (the
+    cheapest possible rebuild) after every change.
+*/
+void bench_derived(std::size_t size, std::size_t op_count)
+{
+    model_type                          model;
+    adobe::filtered_sequence_model<int> filtered(&below_half);
+    adobe::sorted_sequence_model<int>   sorted;
+    adobe::assemblage_t                 assemblage;
+    std::vector<int>                    source;
+
+    for (std::size_t i(0); i < size; ++i)
+    {
+        source.push_back(std::rand());
+
+        model.push_back(source.back());
+    }
+
+    adobe::timer_t timer;
+
+    adobe::attach_sequence_view_to_sequence_model(assemblage, model, filtered);
+
+    double filtered_attach_time(timer.split());
+
+    timer.reset();
+
+    adobe::attach_sequence_view_to_sequence_model(assemblage, model, sorted);
+
+    double sorted_attach_time(timer.split());
+
+    std::vector<key_type> key_set;
+
+    for (std::size_t i(0); i < op_count; ++i)
+        key_set.push_back(model.key_at(std::rand() % size));
+
+    timer.reset();
+
+    for (std::size_t i(0); i < op_count; ++i)
+        model.set(key_set[i], std::rand());
+
+    double incremental_time(timer.split());
+
+    // rebuilding is O(n) or worse per change; fewer rounds keep it bearable
+
+    std::size_t      rebuild_count(std::max<std::size_t>(1, std::min(op_count, 10000000 / size)));
+    std::vector<int> derived;
+
+    timer.reset();
+
+    for (std::size_t i(0); i < rebuild_count; ++i)
+    {
+        source[std::rand() % size] = std::rand();
+
+        derived.clear();
+
+        std::copy_if(source.begin(), source.end(), std::back_inserter(derived), &below_half);
+    }
+
+    double filter_rebuild_time(timer.split());
+
+    timer.reset();
+
+    for (std::size_t i(0); i < rebuild_count; ++i)
+    {
+        source[std::rand() % size] = std::rand();
+
+        derived.assign(source.begin(), source.end());
+
+        std::stable_sort(derived.begin(), derived.end());
+    }
+
+    double sort_rebuild_time(timer.split());
+
+    std::cout << std::setw(10) << size
+              << std::setw(14) << filtered_attach_time
+              << std::setw(14) << sorted_attach_time
+              << std::setw(14) << nanoseconds_per_op(incremental_time, op_count)
+              << std::setw(14) << nanoseconds_per_op(filter_rebuild_time, rebuild_count)
+              << std::setw(14) << nanoseconds_per_op(sort_rebuild_time, rebuild_count)
+              << std::endl;
+}
+
+/****************************************************************************************************/
+
+} // namespace
+
+/****************************************************************************************************/
+
+int main(int argc, char** argv)
+try
+{
+    std::size_t op_count(10000);
+
+    if (argc > 1)
+        op_count = std::atoi(argv[1]);
+
+    std::cout << "Per-operation cost in nanoseconds (" << op_count << " operations per size):"
+              << std::endl;
+
+    std::cout << std::setw(10) << "size"
+              << std::setw(14) << "set"
+              << std::setw(14) << "insert"
+              << std::setw(14) << "erase"
+              << std::setw(14) << "position_of"
+              << std::setw(14) << "key_at"
+              << std::endl;
+
+    for (std::size_t size(1000); size <= 1000000; size *= 10)
+        bench(size, op_count);
+
+    std::cout << std::endl << "Bulk erase of a contiguous block in milliseconds:" << std::endl;
+
+    std::cout << std::setw(10) << "size"
+              << std::setw(14) << "erased"
+              << std::setw(14) << "key set"
+              << std::setw(14) << "selection"
+              << std::endl;
+
+    for (std::size_t size(1000); size <= 1000000; size *= 10)
+        bench_bulk_erase(size);
+
+    std::cout << std::endl << "Full view against a 40 row window: attach in milliseconds, "
+              << "then notifications over " << op_count << " random sets:" << std::endl;
+
+    std::cout << std::setw(10) << "size"
+              << std::setw(14) << "full attach"
+              << std::setw(14) << "window attach"
+              << std::setw(14) << "full"
+              << std::setw(14) << "window"
+              << std::endl;
+
+    for (std::size_t size(1000); size <= 1000000; size *= 10)
+        bench_window(size, op_count);
+
+    std::cout << std::endl << "Heap against pooled node allocation: allocations to fill, "
+              << "then fill, walk and clear in milliseconds:" << std::endl;
+
+    std::cout << std::setw(10) << "size"
+              << std::setw(10) << "nodes"
+              << std::setw(14) << "allocations"
+              << std::setw(14) << "fill"
+              << std::setw(14) << "walk"
+              << std::setw(14) << "clear"
+              << std::endl;
+
+    for (std::size_t size(1000); size <= 1000000; size *= 10)
+    {
+        bench_allocation(size, model_type::heap_allocation);
+        bench_allocation(size, model_type::pooled_allocation);
+    }
+
+    std::cout << std::endl << "Derived models: filtered and sorted attach in milliseconds, then "
+              << "nanoseconds per set kept up to date in both, against rebuilding "
+              << "the filtered or sorted list after every set:" << std::endl;
+
+    std::cout << std::setw(10) << "size"
+              << std::setw(14) << "filter attach"
+              << std::setw(14) << "sort attach"
+              << std::setw(14) << "incremental"
+              << std::setw(14) << "refilter"
+              << std::setw(14) << "resort"
+              << std::endl;
+
+    for (std::size_t size(1000); size <= 1000000; size *= 10)
+        bench_derived(size, op_count);
+
+    return 0;
+}
+catch (const std::exception& error)
+{
+    std::cerr << "Exception: " << error.what() << std::endl;
+
+    return 1;
+}
+catch (...)
+{
+    std::cerr << "Exception: unknown" << std::endl;
+
+    return 1;
+}
+
+/****************************************************************************************************/
@@ -0,0 +1,187 @@
+/*
+    Copyright 2013 Adobe
+    Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*/
+/******************************************************************************/
+
+#define BOOST_TEST_MAIN
+
+#include <boost/test/unit_test.hpp>
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <adobe/poly_sequence_model.hpp>
+#include <adobe/sequence_hooks.hpp>
+#include <adobe/sequence_model.hpp>
+
+/******************************************************************************/
+
+namespace {
+
+/******************************************************************************/
+/*
+    A row that counts every copy made of it. Moves are free.
+*/
+struct row_t
+{
+    static std::size_t copy_count_s;
+
+    row_t() { }
+
+    explicit row_t(const std::string& name) :
+        name_m(name)
+    { }
+
+    row_t(const std::string& name, std::size_t thumbnail_size) :
+        name_m(name),
+        thumbnail_m(thumbnail_size)
+    { }
+
+    row_t(const row_t& x) :
+        name_m(x.name_m),
+        thumbnail_m(x.thumbnail_m)
+    { ++copy_count_s; }
+
+    row_t(row_t&& x) noexcept :
+        name_m(std::move(x.name_m)),
+        thumbnail_m(std::move(x.thumbnail_m))
+    { }
+
+    row_t& operator=(const row_t& x)
+    {
+        name_m = x.name_m;
+        thumbnail_m = x.thumbnail_m;
+
+        ++copy_count_s;
+
+        return *this;
+    }
+
+    row_t& operator=(row_t&& x) noexcept
+    {
+        name_m = std::move(x.name_m);
+        thumbnail_m = std::move(x.thumbnail_m);
+
+        return *this;
+    }
+
+    friend bool operator==(const row_t& x, const row_t& y)
+    { return x.name_m == y.name_m && x.thumbnail_m == y.thumbnail_m; }
+
+    friend std::ostream& operator<<(std::ostream& s, const row_t& x)
+    { return s << x.name_m; }
+
+    std::string                name_m;
+    std::vector<unsigned char> thumbnail_m;
+};
+
+std::size_t row_t::copy_count_s(0);
+
+/******************************************************************************/
+
+template <typename T>
+struct test_controller
+{
+    typedef T                                            value_type;
+    typedef typename adobe::poly_sequence_model<T>::type poly_sequence_model_type;
+
+    test_controller() :
+        sequence_m(0)
+    { }
+
+    void monitor_sequence(poly_sequence_model_type& sequence)
+    { sequence_m = &sequence; }
+
+    poly_sequence_model_type* sequence_m;
+};
+
+/******************************************************************************/
+
+void check_copies(const char* what, std::size_t expected)
+{
+    BOOST_CHECK_MESSAGE(row_t::copy_count_s == expected,
+                        what << ": " << row_t::copy_count_s << " copies, expected " << expected);
+
+    row_t::copy_count_s = 0;
+}
+
+/******************************************************************************/
+
+} // namespace
+
+/******************************************************************************/
+
+BOOST_AUTO_TEST_CASE(sequence_model_move)
+{
+    typedef adobe::sequence_model<row_t> model_type;
+    typedef model_type::key_type         key_type;
+
+    model_type                  model;
+    test_controller<row_t>      controller;
+    adobe::assemblage_t         assemblage;
+
+    adobe::attach_sequence_controller_to_sequence_model(assemblage, model, controller);
+
+    BOOST_REQUIRE(controller.sequence_m);
+
+    // directly on the model
+
+    model.push_back(row_t("moved", 1024));
+    check_copies("push_back rvalue", 0);
+
+    model.emplace_back("emplaced", 1024);
+    check_copies("emplace_back", 0);
+
+    model.emplace(model.key_at(0), "emplaced before", 1024);
+    check_copies("emplace", 0);
+
+    model.insert(key_type::nkey, row_t("inserted", 1024));
+    check_copies("insert rvalue", 0);
+
+    model.set(model.key_at(1), row_t("set", 1024));
+    check_copies("set rvalue", 0);
+
+    std::vector<row_t> row_set;
+
+    row_set.reserve(3);
+    row_set.push_back(row_t("a", 16));
+    row_set.push_back(row_t("b", 16));
+    row_set.push_back(row_t("c", 16));
+
+    model.insert_set(key_type::nkey, std::move(row_set));
+    check_copies("insert_set rvalue", 0);
+
+    // through the poly_sequence_model handed to controllers
+
+    controller.sequence_m->push_back(row_t("controller moved", 1024));
+    check_copies("controller push_back rvalue", 0);
+
+    controller.sequence_m->emplace_back("controller emplaced", 1024);
+    check_copies("controller emplace_back", 0);
+
+    controller.sequence_m->emplace(model.key_at(0), "controller emplaced before", 1024);
+    check_copies("controller emplace", 0);
+
+    controller.sequence_m->set(model.key_at(0), row_t("controller set", 1024));
+    check_copies("controller set rvalue", 0);
+
+    // lvalues are still copied exactly once
+
+    row_t row("copied", 1024);
+
+    model.push_back(row);
+    check_copies("push_back lvalue", 1);
+
+    controller.sequence_m->insert(model.key_at(0), row);
+    check_copies("controller insert lvalue", 1);
+
+    BOOST_CHECK_EQUAL(model.size(), 12u);
+    BOOST_CHECK_EQUAL(model_type::at(model.key_at(0))->name_m, "copied");
+    BOOST_CHECK_EQUAL(model_type::at(model.key_at(1))->name_m, "controller set");
+}
+
+/******************************************************************************/
@@ -0,0 +1,169 @@
+/*
+    Copyright 2013 Adobe
+    Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*/
+/******************************************************************************/
+
+#define BOOST_TEST_MAIN
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <adobe/selection.hpp>
+#include <adobe/sequence_model.hpp>
+
+/******************************************************************************/
+
+namespace {
+
+/******************************************************************************/
+
+typedef adobe::sequence_model<int> model_type;
+typedef model_type::key_type       key_type;
+typedef model_type::snapshot_type  snapshot_type;
+
+/******************************************************************************/
+
+bool matches(const snapshot_type& snapshot, const std::vector<int>& expected)
+{
+    if (snapshot.size() != expected.size())
+        return false;
+
+    std::vector<int>::const_iterator iter(expected.begin());
+
+    for (snapshot_type::const_iterator first(snapshot.begin()), last(snapshot.end());
+         first != last; ++first, ++iter)
+        if (*first != *iter)
+            return false;
+
+    for (std::size_t i(0); i != expected.size(); ++i)
+        if (snapshot[i] != expected[i])
+            return false;
+
+    return true;
+}
+
+/******************************************************************************/
+
+std::vector<int> contents(const model_type& model)
+{
+    std::vector<int> result;
+
+    for (std::size_t i(0); i != model.size(); ++i)
+        result.push_back(*model_type::at(model.key_at(i)));
+
+    return result;
+}
+
+/******************************************************************************/
+
+} // namespace
+
+/******************************************************************************/
+
+BOOST_AUTO_TEST_CASE(sequence_model_snapshot)
+{
+    model_type model;
+
+    for (int i(0); i != 100; ++i)
+        model.push_back(i);
+
+    // Every snapshot taken is kept along with what the model held at the
+    // time; each mutation below must leave all of them alone.
+
+    std::vector<std::pair<snapshot_type, std::vector<int> > > history;
+
+    history.push_back(std::make_pair(model.snapshot(), contents(model)));
+
+    std::srand(7);
+
+    for (int step(0); step != 2000; ++step)
+    {
+        std::size_t size(model.size());
+        key_type    key(size == 0 ? key_type::nkey : model.key_at(std::rand() % size));
+
+        switch (std::rand() % 6)
+        {
+            case 0: model.push_back(step + 1000);       break;
+            case 1: model.insert(key, step + 1000);     break;
+            case 2: model.set(key, step + 1000);        break;
+            case 3:
+            {
+                std::vector<key_type> key_set(1, key);
+
+                model.erase(key_set);
+            }
+            break;
+            case 4:
+            {
+                adobe::selection_t selection;
+                std::size_t        first(std::rand() % (size + 1));
+
+                selection.push_back(first);
+                selection.push_back(first + std::rand() % (size / 2 + 1));
+
+                model.move_selection(selection, model.key_at(std::rand() % (size + 1)));
+            }
+            break;
+            case 5:
+            {
+                adobe::selection_t selection;
+                std::size_t        first(std::rand() % (size + 1));
+
+                selection.push_back(first);
+                selection.push_back(first + std::rand() % (size / 8 + 1));
+
+                model.erase_selection(selection);
+            }
+            break;
+        }
+
+        if (step % 50 == 0)
+            history.push_back(std::make_pair(model.snapshot(), contents(model)));
+    }
+
+    history.push_back(std::make_pair(model.snapshot(), contents(model)));
+
+    for (std::size_t i(0); i != history.size(); ++i)
+        BOOST_CHECK_MESSAGE(matches(history[i].first, history[i].second), "snapshot unchanged");
+
+    // a snapshot read on another thread while the model keeps changing
+
+    snapshot_type    snapshot(model.snapshot());
+    std::vector<int> expected(contents(model));
+    bool             worker_ok(false);
+
+    std::thread worker([&snapshot, &expected, &worker_ok]()
+    {
+        for (int pass(0); pass != 20; ++pass)
+            worker_ok = matches(snapshot, expected);
+    });
+
+    for (int i(0); i != 5000; ++i)
+    {
+        model.push_back(i);
+
+        if (i % 3 == 0)
+            model.set(model.key_at(0), -i);
+    }
+
+    worker.join();
+
+    BOOST_CHECK_MESSAGE(worker_ok, "snapshot read on a worker thread");
+
+    model.clear();
+
+    BOOST_CHECK_MESSAGE(model.snapshot().empty(), "snapshot after clear");
+    BOOST_CHECK_MESSAGE(matches(history.front().first, history.front().second),
+                        "snapshot outlives clear");
+
+    std::cout << history.size() << " snapshots checked" << std::endl;
+}
+
+/******************************************************************************/
@@ -203,10 +203,134 @@ private:
 };
 
 /******************************************************************************/
+/*
+    A view that only keeps track of the keys it has been told about, so
+    its order can be compared with the model's.
+*/
+template <typename T>
+struct mirror_sequence_view
+{
+    typedef T                                value_type;
+    typedef adobe::copy_on_write<value_type> cow_value_type;
+    typedef typename adobe::sequence_key<T>  key_type;
+
+    mirror_sequence_view() : refresh_count_m(0) { }
+
+    void refresh(key_type, cow_value_type)
+    { ++refresh_count_m; }
+
+    void extend(key_type before, key_type key, cow_value_type)
+    { set_m.insert(adobe::find(set_m, before), key); }
+
+    void extend_set(key_type before, const adobe::vector<key_type>& key_set)
+    { set_m.insert(adobe::find(set_m, before), key_set.begin(), key_set.end()); }
+
+    void erase(const adobe::vector<key_type>& key_set)
+    {
+        for (typename adobe::vector<key_type>::const_iterator iter(key_set.begin()),
+             last(key_set.end()); iter != last; ++iter)
+            set_m.erase(adobe::find(set_m, *iter));
+    }
+
+    void clear()
+    { set_m.clear(); }
+
+    key_type key_for(std::size_t x) const
+    { return set_m[x]; }
+
+    bool mirrors(const adobe::sequence_model<T>& model) const
+    {
+        if (set_m.size() != model.size())
+            return false;
+
+        for (std::size_t i(0); i != set_m.size(); ++i)
+            if (set_m[i] != model.key_at(i))
+                return false;
+
+        return true;
+    }
+
+    adobe::vector<key_type> set_m;
+    std::size_t             refresh_count_m;
+};
 
+/******************************************************************************/
+/*
+    A mirror that, the first time it is extended, pushes one more value
+    back through a controller and flushes its multiplexer, the way a
+    widget reacting to its model would.
+*/
 template <typename T>
+struct echo_sequence_view : mirror_sequence_view<T>
+{
+    typedef mirror_sequence_view<T>      base_type;
+    typedef typename base_type::key_type key_type;
+
+    echo_sequence_view(my_sequence_controller<T>&             controller,
+                       adobe::sequence_model_multiplexer<T>*& mux,
+                       const T&                               echo) :
+        controller_m(controller),
+        mux_m(mux),
+        echo_m(echo),
+        echoed_m(false)
+    { }
+
+    void extend(key_type before, key_type key, typename base_type::cow_value_type value)
+    {
+        base_type::extend(before, key, value);
+
+        echo();
+    }
+
+    void extend_set(key_type before, const adobe::vector<key_type>& key_set)
+    {
+        base_type::extend_set(before, key_set);
+
+        echo();
+    }
+
+    void echo()
+    {
+        if (echoed_m)
+            return;
+
+        echoed_m = true;
+
+        controller_m.push_back(echo_m);
+
+        mux_m->flush();
+    }
+
+    my_sequence_controller<T>&             controller_m;
+    adobe::sequence_model_multiplexer<T>*& mux_m;
+    T                                      echo_m;
+    bool                                   echoed_m;
+};
+
+/******************************************************************************/
+/*
+    Runs the general deferred queue until nothing is left on it; returns
+    the number of passes it took.
+*/
+std::size_t drain_queue()
+{
+    std::size_t pass_count(0);
+
+    while (!adobe::general_deferred_proc_queue().empty() && pass_count != 100)
+    {
+        adobe::general_deferred_proc_queue()();
+
+        ++pass_count;
+    }
+
+    return pass_count;
+}
+
+/******************************************************************************/
+
+template <typename T, typename SequenceView>
 void flex(adobe::sequence_model<T>&  /*model*/,
-          const my_sequence_view<T>& view,
+          const SequenceView&        view,
           my_sequence_controller<T>& controller)
 {
     controller.push_back(42);
@@ -362,3 +486,395 @@ BOOST_AUTO_TEST_CASE(muldex_basic_sheet)
 }
 
 /******************************************************************************/
+
+BOOST_AUTO_TEST_CASE(muldex_encodings)
+{
+    std::cout << "<muldex_encodings>" << std::endl;
+
+    const adobe::name_t            line("line");
+    const adobe::muldex_encoding_t encoding_set[] = { adobe::typed_muldex_encoding,
+                                                       adobe::dictionary_muldex_encoding };
+
+    /*
+        Each encoding is run on both lines, then the two are mixed: the
+        demultiplexers accept whatever the multiplexers send.
+    */
+    for (std::size_t i(0); i != 4; ++i)
+    {
+        adobe::muldex_encoding_t view_encoding(encoding_set[i & 1]);
+        adobe::muldex_encoding_t controller_encoding(encoding_set[i >> 1]);
+
+        adobe::sheet_t               sequence_view_property_model;
+        adobe::sheet_t               sequence_controller_property_model;
+        adobe::sequence_model<foo_t> sequence_model;
+        adobe::array_t               line_initializer(1, adobe::any_regular_t());
+        adobe::assemblage_t          assemblage;
+
+        sequence_view_property_model.add_interface(line, true,
+                                                   adobe::line_position_t(), line_initializer,
+                                                   adobe::line_position_t(), adobe::array_t());
+
+        sequence_controller_property_model.add_interface(line, true,
+                                                         adobe::line_position_t(), line_initializer,
+                                                         adobe::line_position_t(), adobe::array_t());
+
+        sequence_view_property_model.update();
+        sequence_controller_property_model.update();
+
+        mirror_sequence_view<foo_t>   view;
+        my_sequence_controller<foo_t> controller;
+
+        attach_sequence_view_muldex(sequence_model, view, sequence_view_property_model,
+                                    line, assemblage, view_encoding);
+
+        attach_sequence_controller_muldex(sequence_model, controller,
+                                          sequence_controller_property_model,
+                                          line, assemblage, controller_encoding);
+
+        flex(sequence_model, view, controller);
+
+        BOOST_CHECK_EQUAL(sequence_model.size(), 8u);
+        BOOST_CHECK(view.mirrors(sequence_model));
+
+        // identical commands in a row each get through
+
+        controller.set(view.key_for(0), 7);
+        controller.set(view.key_for(0), 7);
+
+        BOOST_CHECK_EQUAL(view.refresh_count_m, 3u);
+        BOOST_CHECK_EQUAL(adobe::sequence_model<foo_t>::at(view.key_for(0))->value_m, 7);
+
+        controller.clear();
+
+        BOOST_CHECK(sequence_model.empty() && view.set_m.empty());
+    }
+
+    std::cout << "</muldex_encodings>" << std::endl;
+}
+
+/******************************************************************************/
+
+BOOST_AUTO_TEST_CASE(muldex_buffered)
+{
+    std::cout << "<muldex_buffered>" << std::endl;
+
+    const adobe::name_t            line("line");
+    const adobe::muldex_encoding_t encoding_set[] = { adobe::typed_muldex_encoding,
+                                                      adobe::dictionary_muldex_encoding };
+
+    for (std::size_t i(0); i != 2; ++i)
+    {
+        adobe::sheet_t               sequence_view_property_model;
+        adobe::sheet_t               sequence_controller_property_model;
+        adobe::sequence_model<foo_t> sequence_model;
+        adobe::array_t               line_initializer(1, adobe::any_regular_t());
+        adobe::assemblage_t          assemblage;
+
+        sequence_view_property_model.add_interface(line, true,
+                                                   adobe::line_position_t(), line_initializer,
+                                                   adobe::line_position_t(), adobe::array_t());
+
+        sequence_controller_property_model.add_interface(line, true,
+                                                         adobe::line_position_t(), line_initializer,
+                                                         adobe::line_position_t(), adobe::array_t());
+
+        sequence_view_property_model.update();
+        sequence_controller_property_model.update();
+
+        mirror_sequence_view<foo_t>   view;
+        my_sequence_controller<foo_t> controller;
+
+        adobe::sequence_view_multiplexer<foo_t>& view_mux(
+            attach_sequence_view_muldex(sequence_model, view, sequence_view_property_model,
+                                        line, assemblage, encoding_set[i],
+                                        adobe::buffered_muldex_delivery));
+
+        adobe::sequence_model_multiplexer<foo_t>& controller_mux(
+            attach_sequence_controller_muldex(sequence_model, controller,
+                                              sequence_controller_property_model,
+                                              line, assemblage, encoding_set[i],
+                                              adobe::buffered_muldex_delivery));
+
+        // the clear sent when the view is attached is waiting on the queue
+
+        adobe::general_deferred_proc_queue()();
+
+        for (int j(0); j != 10; ++j)
+            controller.push_back(j);
+
+        BOOST_CHECK_EQUAL(controller_mux.pending(), 10u);
+        BOOST_CHECK(sequence_model.empty());
+
+        controller_mux.flush();
+
+        BOOST_CHECK_EQUAL(sequence_model.size(), 10u);
+        BOOST_CHECK_EQUAL(view_mux.pending(), 10u);
+        BOOST_CHECK(view.set_m.empty());
+
+        view_mux.flush();
+
+        BOOST_CHECK(view.mirrors(sequence_model));
+
+        // the same command twice in a row, flushed by the queue; the view
+        // line still has a flush scheduled from the push_backs
+
+        controller.set(view.key_for(3), 7);
+        controller.set(view.key_for(3), 7);
+
+        adobe::general_deferred_proc_queue()();
+
+        BOOST_CHECK_EQUAL(adobe::sequence_model<foo_t>::at(view.key_for(3))->value_m, 7);
+        BOOST_CHECK_EQUAL(view.refresh_count_m, 2u);
+
+        // a flush scheduled while the queue runs waits for the next pass
+
+        controller.clear();
+
+        adobe::general_deferred_proc_queue()();
+
+        BOOST_CHECK(sequence_model.empty());
+        BOOST_CHECK_EQUAL(view_mux.pending(), 1u);
+
+        adobe::general_deferred_proc_queue()();
+
+        BOOST_CHECK(view.set_m.empty());
+        BOOST_CHECK_EQUAL(view_mux.pending(), 0u);
+    }
+
+    std::cout << "</muldex_buffered>" << std::endl;
+}
+
+/******************************************************************************/
+/*
+    Both muldex lines on one sheet: with deferred delivery neither line is
+    written while the other is delivering, so the sheet is never updated
+    from within its own update.
+*/
+BOOST_AUTO_TEST_CASE(muldex_shared_sheet)
+{
+    std::cout << "<muldex_shared_sheet>" << std::endl;
+
+    const adobe::name_t            view_line("view_line");
+    const adobe::name_t            controller_line("controller_line");
+    const adobe::muldex_encoding_t encoding_set[] = { adobe::typed_muldex_encoding,
+                                                      adobe::dictionary_muldex_encoding };
+
+    for (std::size_t i(0); i != 2; ++i)
+    {
+        adobe::sheet_t                            property_model;
+        adobe::sequence_model<foo_t>              sequence_model;
+        adobe::array_t                            line_initializer(1, adobe::any_regular_t());
+        adobe::assemblage_t                       assemblage;
+        adobe::sequence_model_multiplexer<foo_t>* controller_mux(0);
+        my_sequence_controller<foo_t>             controller;
+        echo_sequence_view<foo_t>                 view(controller, controller_mux, foo_t(99));
+
+        property_model.add_interface(view_line, true,
+                                     adobe::line_position_t(), line_initializer,
+                                     adobe::line_position_t(), adobe::array_t());
+
+        property_model.add_interface(controller_line, true,
+                                     adobe::line_position_t(), line_initializer,
+                                     adobe::line_position_t(), adobe::array_t());
+
+        property_model.update();
+
+        adobe::sequence_view_multiplexer<foo_t>& view_mux(
+            attach_sequence_view_muldex(sequence_model, view, property_model,
+                                        view_line, assemblage, encoding_set[i],
+                                        adobe::deferred_muldex_delivery));
+
+        controller_mux = &attach_sequence_controller_muldex(sequence_model, controller,
+                                                            property_model, controller_line,
+                                                            assemblage, encoding_set[i],
+                                                            adobe::deferred_muldex_delivery);
+
+        drain_queue();
+
+        // an explicit flush outside any delivery is sent at once; the
+        // commands it causes on the view line wait for the queue
+
+        for (int j(0); j != 10; ++j)
+            controller.push_back(j);
+
+        controller_mux->flush();
+
+        BOOST_CHECK_EQUAL(sequence_model.size(), 10u);
+        BOOST_CHECK_EQUAL(view_mux.pending(), 10u);
+        BOOST_CHECK(view.set_m.empty());
+
+        // the view echoes a push_back while the view line is delivering;
+        // its flush is put off until that delivery is over
+
+        drain_queue();
+
+        BOOST_CHECK_EQUAL(sequence_model.size(), 11u);
+        BOOST_CHECK(view.mirrors(sequence_model));
+        BOOST_CHECK_EQUAL(adobe::sequence_model<foo_t>::at(view.key_for(10))->value_m, 99);
+
+        // a batch limit spreads the view line over several passes
+
+        view_mux.set_batch_limit(4);
+
+        for (std::size_t j(0); j != 10; ++j)
+            controller.set(view.key_for(j), foo_t(static_cast<int>(j) * 2));
+
+        adobe::general_deferred_proc_queue()();
+
+        BOOST_CHECK_EQUAL(view_mux.pending(), 10u);
+        BOOST_CHECK_EQUAL(view.refresh_count_m, 0u);
+
+        adobe::general_deferred_proc_queue()();
+
+        BOOST_CHECK_EQUAL(view_mux.pending(), 6u);
+        BOOST_CHECK_EQUAL(view.refresh_count_m, 4u);
+
+        BOOST_CHECK_EQUAL(drain_queue(), 2u);
+        BOOST_CHECK_EQUAL(view.refresh_count_m, 10u);
+
+        controller.clear();
+
+        drain_queue();
+
+        BOOST_CHECK(sequence_model.empty());
+        BOOST_CHECK(view.set_m.empty());
+    }
+
+    std::cout << "</muldex_shared_sheet>" << std::endl;
+}
+
+/******************************************************************************/
+/*
+    The demultiplexers record what they receive in the statistics attached
+    to them.
+*/
+BOOST_AUTO_TEST_CASE(muldex_statistics)
+{
+    std::cout << "<muldex_statistics>" << std::endl;
+
+    const adobe::name_t            line("line");
+    const adobe::muldex_encoding_t encoding_set[] = { adobe::typed_muldex_encoding,
+                                                      adobe::dictionary_muldex_encoding };
+    const adobe::muldex_delivery_t delivery_set[] = { adobe::immediate_muldex_delivery,
+                                                      adobe::buffered_muldex_delivery };
+
+    for (std::size_t i(0); i != 4; ++i)
+    {
+        adobe::sheet_t               sequence_view_property_model;
+        adobe::sheet_t               sequence_controller_property_model;
+        adobe::sequence_model<foo_t> sequence_model;
+        adobe::array_t               line_initializer(1, adobe::any_regular_t());
+        adobe::assemblage_t          assemblage;
+        adobe::muldex_encoding_t     encoding(encoding_set[i % 2]);
+        adobe::muldex_delivery_t     delivery(delivery_set[i / 2]);
+
+        sequence_view_property_model.add_interface(line, true,
+                                                   adobe::line_position_t(), line_initializer,
+                                                   adobe::line_position_t(), adobe::array_t());
+
+        sequence_controller_property_model.add_interface(line, true,
+                                                         adobe::line_position_t(), line_initializer,
+                                                         adobe::line_position_t(), adobe::array_t());
+
+        sequence_view_property_model.update();
+        sequence_controller_property_model.update();
+
+        mirror_sequence_view<foo_t>   view;
+        my_sequence_controller<foo_t> controller;
+
+        adobe::sequence_view_demultiplexer_t& view_demux(
+            adobe::attach_sequence_view_to_model(assemblage, sequence_view_property_model,
+                                                 line, view));
+
+        adobe::sequence_view_multiplexer<foo_t>& view_mux(
+            adobe::attach_sequence_model_view_to_model(assemblage, sequence_view_property_model,
+                                                       line, sequence_model, encoding,
+                                                       delivery));
+
+        adobe::sequence_model_demultiplexer<foo_t>& model_demux(
+            adobe::attach_sequence_model_controller_to_model(assemblage,
+                                                             sequence_controller_property_model,
+                                                             line, sequence_model));
+
+        adobe::sequence_model_multiplexer<foo_t>& controller_mux(
+            adobe::attach_sequence_controller_to_model(assemblage,
+                                                       sequence_controller_property_model,
+                                                       line, controller, encoding, delivery));
+
+        view_mux.flush();
+
+        adobe::muldex_statistics_t view_statistics;
+        adobe::muldex_statistics_t model_statistics;
+
+        view_demux.set_statistics(&view_statistics);
+        model_demux.set_statistics(&model_statistics);
+
+        for (int j(0); j != 5; ++j)
+            controller.push_back(j);
+
+        controller.insert_set(adobe::sequence_key<foo_t>::nkey, adobe::vector<foo_t>(3, foo_t(7)));
+
+        controller_mux.flush();
+        view_mux.flush();
+
+        BOOST_CHECK(view.mirrors(sequence_model));
+
+        adobe::vector<adobe::sequence_key<foo_t> > key_set;
+
+        key_set.push_back(view.key_for(1));
+        key_set.push_back(view.key_for(6));
+
+        controller.erase(key_set);
+
+        controller_mux.flush();
+        view_mux.flush();
+
+        controller.clear();
+
+        controller_mux.flush();
+        view_mux.flush();
+
+        BOOST_CHECK(view.set_m.empty());
+
+        const adobe::muldex_statistics_t::record_t* record(0);
+
+        BOOST_CHECK_EQUAL(model_statistics.count(adobe::name_t("push_back")), 5u);
+
+        record = model_statistics.find(adobe::name_t("insert_set"));
+
+        BOOST_REQUIRE(record);
+        BOOST_CHECK_EQUAL(record->count_m, 1u);
+        BOOST_CHECK_EQUAL(record->payload_total_m, 3u);
+
+        record = model_statistics.find(adobe::name_t("erase"));
+
+        BOOST_REQUIRE(record);
+        BOOST_CHECK_EQUAL(record->payload_max_m, 2u);
+        BOOST_CHECK_EQUAL(model_statistics.count(adobe::name_t("clear")), 1u);
+
+        BOOST_CHECK_EQUAL(view_statistics.count(adobe::name_t("extend")), 5u);
+        BOOST_CHECK_EQUAL(view_statistics.find(adobe::name_t("extend_set"))->payload_total_m, 3u);
+        BOOST_CHECK_EQUAL(view_statistics.find(adobe::name_t("erase"))->payload_total_m, 2u);
+        BOOST_CHECK_EQUAL(view_statistics.count(adobe::name_t("clear")), 1u);
+
+        std::size_t batch_count(delivery == adobe::buffered_muldex_delivery ? 3 : 0);
+
+        BOOST_CHECK_EQUAL(model_statistics.count(adobe::name_t("batch")), batch_count);
+        BOOST_CHECK_EQUAL(view_statistics.count(adobe::name_t("batch")), batch_count);
+
+        // every dispatch lands in exactly one bucket of the histogram
+
+        std::size_t histogram_total(0);
+
+        for (std::size_t j(0); j != adobe::muldex_statistics_t::histogram_size_k; ++j)
+            histogram_total += model_statistics.find(adobe::name_t("push_back"))->histogram_m[j];
+
+        BOOST_CHECK_EQUAL(histogram_total, 5u);
+
+        std::cout << model_statistics << view_statistics;
+    }
+
+    std::cout << "</muldex_statistics>" << std::endl;
+}
+
+/******************************************************************************/
@@ -0,0 +1,183 @@
+/*
+    Copyright 2013 Adobe
+    Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*/
+/****************************************************************************************************/
+
+#include <adobe/config.hpp>
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <adobe/sequence_model.hpp>
+#include <adobe/sequence_mvc_muldex.hpp>
+#include <adobe/timer.hpp>
+
+/****************************************************************************************************/
+
+namespace {
+
+/****************************************************************************************************/
+
+typedef adobe::sequence_model<int> model_type;
+typedef model_type::key_type       key_type;
+
+/****************************************************************************************************/
+/*
+    The view at the far end of the line. It remembers the keys appended
+    to the model, so the benchmark has keys to set, and counts the
+    refreshes that make it through.
+*/
+struct counting_view_t
+{
+    typedef int                       value_type;
+    typedef adobe::copy_on_write<int> cow_value_type;
+    typedef adobe::sequence_key<int>  key_type;
+
+    counting_view_t() : refresh_count_m(0) { }
+
+    void refresh(key_type, cow_value_type)
+    { ++refresh_count_m; }
+
+    void extend(key_type, key_type key, cow_value_type)
+    { key_set_m.push_back(key); }
+
+    void extend_set(key_type, const std::vector<key_type>& key_set)
+    { key_set_m.insert(key_set_m.end(), key_set.begin(), key_set.end()); }
+
+    void erase(const std::vector<key_type>&)
+    { }
+
+    void clear()
+    { key_set_m.clear(); }
+
+    std::vector<key_type> key_set_m;
+    std::size_t           refresh_count_m;
+};
+
+/****************************************************************************************************/
+
+std::size_t display_count_g(0);
+
+void count_display(const adobe::any_regular_t&)
+{ ++display_count_g; }
+
+/****************************************************************************************************/
+
+inline double nanoseconds_per_op(double milliseconds, std::size_t count)
+{ return milliseconds * 1e6 / count; }
+
+/****************************************************************************************************/
+/*
+    Sends op_count refreshes down a model-to-view line and reports the
+    cost per refresh and the number of values that went through the cell
+    (each one a full update of the sheet.) A buffered line is flushed
+    once, at the end, as it would be on the next trip through the event
+    loop.
+*/
+void bench(const char*              label,
+           std::size_t              size,
+           std::size_t              op_count,
+           adobe::muldex_encoding_t encoding,
+           adobe::muldex_delivery_t delivery)
+{
+    const adobe::name_t line("line");
+
+    adobe::sheet_t      sheet;
+    model_type          model;
+    counting_view_t     view;
+    adobe::assemblage_t assemblage;
+
+    sheet.add_interface(line, true,
+                        adobe::line_position_t(), adobe::array_t(1, adobe::any_regular_t()),
+                        adobe::line_position_t(), adobe::array_t());
+
+    sheet.update();
+
+    adobe::sequence_view_multiplexer<int>& mux(
+        adobe::attach_sequence_view_muldex(model, view, sheet, line, assemblage, encoding, delivery));
+
+    mux.set_flush_queue(0);
+
+    adobe::attach_view_function_to_model<adobe::any_regular_t>(assemblage, sheet, line,
+                                                                &count_display);
+
+    for (std::size_t i(0); i < size; ++i)
+        model.push_back(static_cast<int>(i));
+
+    mux.flush();
+
+    std::vector<key_type> key_set(view.key_set_m);
+
+    display_count_g = 0;
+
+    adobe::timer_t timer;
+
+    for (std::size_t i(0); i < op_count; ++i)
+        model.set(key_set[i % size], static_cast<int>(i));
+
+    mux.flush();
+
+    double time(timer.split());
+
+    if (view.refresh_count_m != op_count)
+        std::cerr << "refreshes lost: " << view.refresh_count_m << std::endl;
+
+    std::cout << std::setw(24) << label
+              << std::setw(14) << time
+              << std::setw(14) << nanoseconds_per_op(time, op_count)
+              << std::setw(14) << display_count_g
+              << std::endl;
+}
+
+/****************************************************************************************************/
+
+} // namespace
+
+/****************************************************************************************************/
+
+int main(int argc, char** argv)
+try
+{
+    std::size_t op_count(1000);
+
+    if (argc > 1)
+        op_count = std::atoi(argv[1]);
+
+    std::cout << op_count << " refreshes down a muldex line (100 rows): total milliseconds, "
+              << "nanoseconds per refresh and values through the cell:" << std::endl;
+
+    std::cout << std::setw(24) << "line"
+              << std::setw(14) << "total"
+              << std::setw(14) << "per refresh"
+              << std::setw(14) << "updates"
+              << std::endl;
+
+    bench("dictionary, immediate", 100, op_count,
+          adobe::dictionary_muldex_encoding, adobe::immediate_muldex_delivery);
+    bench("typed, immediate", 100, op_count,
+          adobe::typed_muldex_encoding, adobe::immediate_muldex_delivery);
+    bench("dictionary, buffered", 100, op_count,
+          adobe::dictionary_muldex_encoding, adobe::buffered_muldex_delivery);
+    bench("typed, buffered", 100, op_count,
+          adobe::typed_muldex_encoding, adobe::buffered_muldex_delivery);
+
+    return 0;
+}
+catch (const std::exception& error)
+{
+    std::cerr << "Exception: " << error.what() << std::endl;
+
+    return 1;
+}
+catch (...)
+{
+    std::cerr << "Exception: unknown" << std::endl;
+
+    return 1;
+}
+
+/****************************************************************************************************/
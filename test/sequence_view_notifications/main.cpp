@@ -0,0 +1,290 @@
+/*
+    Copyright 2013 Adobe
+    Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*/
+/******************************************************************************/
+
+#define BOOST_TEST_MAIN
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/static_assert.hpp>
+
+#include <adobe/selection.hpp>
+#include <adobe/sequence_hooks.hpp>
+#include <adobe/sequence_model.hpp>
+
+#include "../sequence_mirror_view.hpp"
+
+/******************************************************************************/
+
+namespace {
+
+/******************************************************************************/
+
+typedef adobe::sequence_model<int> model_type;
+typedef model_type::key_type       key_type;
+typedef std::vector<key_type>      key_set_t;
+
+/******************************************************************************/
+/*
+    A view implementing only the required notifications. It mirrors the
+    order of the model and counts what it receives.
+*/
+typedef adobe::sequence_mirror_view_t<int> legacy_view_t;
+
+/******************************************************************************/
+/*
+    A view implementing the range-level notifications as well.
+*/
+struct range_view_t : legacy_view_t
+{
+    range_view_t() : move_count_m(0), move_range_count_m(0), refresh_set_count_m(0),
+                     refresh_range_count_m(0), erase_range_count_m(0), refreshed_m(0) { }
+
+    void move(const key_set_t& key_set, key_type before)
+    {
+        ++move_count_m;
+
+        remove(key_set);
+        insert(before, key_set);
+    }
+
+    void move_range(const key_set_t& run, key_type before)
+    {
+        ++move_range_count_m;
+
+        remove(run);
+        insert(before, run);
+    }
+
+    void refresh_set(const key_set_t& key_set)
+    {
+        ++refresh_set_count_m;
+
+        refreshed_m += key_set.size();
+    }
+
+    void refresh_range(const key_set_t& run)
+    {
+        ++refresh_range_count_m;
+
+        refreshed_m += run.size();
+    }
+
+    void erase_range(const key_set_t& run)
+    {
+        ++erase_range_count_m;
+
+        remove(run);
+    }
+
+    std::size_t move_count_m;
+    std::size_t move_range_count_m;
+    std::size_t refresh_set_count_m;
+    std::size_t refresh_range_count_m;
+    std::size_t erase_range_count_m;
+    std::size_t refreshed_m;
+};
+
+BOOST_STATIC_ASSERT((!adobe::implementation::sequence_view_members<legacy_view_t>::has_move::value));
+BOOST_STATIC_ASSERT((adobe::implementation::sequence_view_members<range_view_t>::has_move::value));
+BOOST_STATIC_ASSERT((adobe::implementation::sequence_view_members<range_view_t>::has_erase_range::value));
+
+/******************************************************************************/
+/*
+    A view whose extend throws while armed.
+*/
+struct throwing_view_t : legacy_view_t
+{
+    throwing_view_t() : armed_m(false) { }
+
+    void extend(key_type before, key_type key, legacy_view_t::cow_value_type value)
+    {
+        if (armed_m)
+            throw std::runtime_error("throwing_view_t::extend");
+
+        legacy_view_t::extend(before, key, value);
+    }
+
+    bool armed_m;
+};
+
+/******************************************************************************/
+
+void push_back_in_transaction(model_type& model, int value)
+{
+    model_type::transaction_t transaction(model);
+
+    model.push_back(value);
+}
+
+/******************************************************************************/
+
+void push_back_in_failing_transaction(model_type& model, int value)
+{
+    model_type::transaction_t transaction(model);
+
+    model.push_back(value);
+
+    throw std::logic_error("push_back_in_failing_transaction");
+}
+
+/******************************************************************************/
+
+bool mirrors(const model_type& model, const legacy_view_t& view)
+{
+    if (view.key_set_m.size() != model.size())
+        return false;
+
+    for (std::size_t i(0); i != model.size(); ++i)
+        if (view.key_set_m[i] != model.key_at(i))
+            return false;
+
+    return true;
+}
+
+/******************************************************************************/
+
+adobe::selection_t selection(std::size_t first, std::size_t last)
+{
+    adobe::selection_t result;
+
+    result.push_back(first);
+    result.push_back(last);
+
+    return result;
+}
+
+/******************************************************************************/
+
+} // namespace
+
+/******************************************************************************/
+
+BOOST_AUTO_TEST_CASE(sequence_view_notifications)
+{
+    model_type          model;
+    legacy_view_t       legacy;
+    range_view_t        ranged;
+    adobe::assemblage_t assemblage;
+
+    for (int i(0); i != 20; ++i)
+        model.push_back(i);
+
+    adobe::attach_sequence_view_to_sequence_model(assemblage, model, legacy);
+    adobe::attach_sequence_view_to_sequence_model(assemblage, model, ranged);
+
+    ranged.extend_count_m = 0;
+    legacy.extend_count_m = 0;
+
+    // one run moved: a move_range, or an erase and extend_set for the legacy view
+
+    model.move_selection(selection(2, 5), model.key_at(10));
+
+    BOOST_CHECK_EQUAL(ranged.move_range_count_m, 1u);
+    BOOST_CHECK_EQUAL(ranged.erase_count_m, 0u);
+    BOOST_CHECK_EQUAL(ranged.extend_count_m, 0u);
+    BOOST_CHECK_EQUAL(legacy.erase_count_m, 1u);
+    BOOST_CHECK_EQUAL(legacy.extend_count_m, 1u);
+    BOOST_CHECK(mirrors(model, ranged));
+    BOOST_CHECK(mirrors(model, legacy));
+
+    // two runs moved: a move
+
+    adobe::selection_t two_runs(selection(0, 2));
+
+    two_runs.push_back(12);
+    two_runs.push_back(14);
+
+    model.move_selection(two_runs, adobe::sequence_key<int>::nkey);
+
+    BOOST_CHECK_EQUAL(ranged.move_count_m, 1u);
+    BOOST_CHECK_EQUAL(ranged.erase_count_m, 0u);
+    BOOST_CHECK(mirrors(model, ranged));
+    BOOST_CHECK(mirrors(model, legacy));
+
+    // refreshing a run
+
+    model.refresh_selection(selection(4, 8));
+
+    BOOST_CHECK_EQUAL(ranged.refresh_range_count_m, 1u);
+    BOOST_CHECK_EQUAL(ranged.refreshed_m, 4u);
+    BOOST_CHECK_EQUAL(ranged.refresh_count_m, 0u);
+    BOOST_CHECK_EQUAL(legacy.refresh_count_m, 4u);
+
+    // sets within a transaction arrive as one refresh_set
+
+    {
+    model_type::transaction_t transaction(model);
+
+    model.set(model.key_at(1), 100);
+    model.set(model.key_at(7), 101);
+    model.set(model.key_at(15), 102);
+    }
+
+    BOOST_CHECK_EQUAL(ranged.refresh_set_count_m, 1u);
+    BOOST_CHECK_EQUAL(ranged.refreshed_m, 7u);
+    BOOST_CHECK_EQUAL(ranged.refresh_count_m, 0u);
+    BOOST_CHECK_EQUAL(legacy.refresh_count_m, 7u);
+
+    // erasing a run
+
+    model.erase_selection(selection(3, 9));
+
+    BOOST_CHECK_EQUAL(ranged.erase_range_count_m, 1u);
+    BOOST_CHECK_EQUAL(ranged.erase_count_m, 0u);
+    BOOST_CHECK_EQUAL(legacy.erase_count_m, 3u);
+    BOOST_CHECK(mirrors(model, ranged));
+    BOOST_CHECK(mirrors(model, legacy));
+}
+
+/******************************************************************************/
+
+BOOST_AUTO_TEST_CASE(sequence_model_transaction_exception)
+{
+    model_type          model;
+    throwing_view_t     view;
+    adobe::assemblage_t assemblage;
+
+    adobe::attach_sequence_view_to_sequence_model(assemblage, model, view);
+
+    // a view throwing from the commit is passed on, and leaves the model
+    // outside any transaction with nothing left to send
+
+    view.armed_m = true;
+
+    BOOST_CHECK_THROW(push_back_in_transaction(model, 1), std::runtime_error);
+
+    view.armed_m = false;
+
+    model.push_back(2);
+
+    BOOST_CHECK_EQUAL(view.extend_count_m, 1u);
+
+    push_back_in_transaction(model, 3);
+
+    BOOST_CHECK_EQUAL(view.extend_count_m, 2u);
+    BOOST_CHECK_EQUAL(model.size(), 3u);
+
+    // while an exception propagates the commit drops what the view throws
+
+    view.armed_m = true;
+
+    BOOST_CHECK_THROW(push_back_in_failing_transaction(model, 4), std::logic_error);
+
+    view.armed_m = false;
+
+    model.push_back(5);
+
+    BOOST_CHECK_EQUAL(view.extend_count_m, 3u);
+    BOOST_CHECK_EQUAL(model.size(), 5u);
+}
+
+/******************************************************************************/
@@ -0,0 +1,205 @@
+/*
+    Copyright 2013 Adobe
+    Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*/
+/****************************************************************************************************/
+
+#define BOOST_TEST_MAIN
+
+#include <boost/test/unit_test.hpp>
+
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <adobe/xml_element_forest.hpp>
+#include <adobe/xml_element_forest_index.hpp>
+
+/****************************************************************************************************/
+
+namespace {
+
+/****************************************************************************************************/
+
+typedef adobe::element_forest_t::iterator iterator;
+typedef std::vector<iterator>             iterator_set_t;
+
+/****************************************************************************************************/
+
+const char* const test_document =
+    "<math-test>\n"
+    "   <expression>\n"
+    "       <operand value=\"2\"/>\n"
+    "       <operand value=\"3\"/>\n"
+    "       <expression>\n"
+    "           <operand value=\"4\"/>\n"
+    "           <operand value=\"5\"/>\n"
+    "           <multiply/>\n"
+    "       </expression>\n"
+    "       <add/>\n"
+    "       <multiply/>\n"
+    "   </expression>\n"
+    "   <result value=\"46\"/>\n"
+    "</math-test>\n";
+
+/****************************************************************************************************/
+
+std::string element_name(iterator node)
+{
+    std::string result;
+
+    adobe::get_value(*node, adobe::name_element_name(), result);
+
+    return result;
+}
+
+std::string attribute(iterator node, const char* name)
+{
+    std::string result;
+
+    adobe::get_value(*node, adobe::name_t(name), result);
+
+    return result;
+}
+
+std::string values(const iterator_set_t& set)
+{
+    std::string result;
+
+    for (iterator_set_t::const_iterator iter(set.begin()), last(set.end()); iter != last; ++iter)
+        result += attribute(*iter, "value");
+
+    return result;
+}
+
+/****************************************************************************************************/
+
+// the elements named name, found by walking the whole forest
+
+iterator_set_t walk_find(adobe::element_forest_t& forest, const std::string& name)
+{
+    iterator_set_t result;
+
+    for (iterator first(forest.begin()), last(forest.end()); first != last; ++first)
+        if (first.edge() == adobe::forest_leading_edge && element_name(first) == name)
+            result.push_back(first);
+
+    return result;
+}
+
+iterator_set_t index_find(const adobe::element_forest_index_t& index, const char* name)
+{
+    iterator_set_t result;
+
+    index.find(adobe::name_t(name), std::back_inserter(result));
+
+    return result;
+}
+
+iterator_set_t index_find_path(const adobe::element_forest_index_t& index,
+                               const char*                          first,
+                               const char*                          second,
+                               const char*                          third = 0)
+{
+    std::vector<adobe::name_t> path;
+    iterator_set_t             result;
+
+    path.push_back(adobe::name_t(first));
+    path.push_back(adobe::name_t(second));
+
+    if (third)
+        path.push_back(adobe::name_t(third));
+
+    index.find_path(path.begin(), path.end(), std::back_inserter(result));
+
+    return result;
+}
+
+adobe::dictionary_t make_element(const char* name, const std::string& value)
+{
+    adobe::dictionary_t result;
+
+    result[adobe::name_type()] = adobe::any_regular_t(std::string("element"));
+    result[adobe::name_element_name()] = adobe::any_regular_t(std::string(name));
+    result[adobe::name_t("value")] = adobe::any_regular_t(value);
+
+    return result;
+}
+
+/****************************************************************************************************/
+
+} // namespace
+
+/****************************************************************************************************/
+
+BOOST_AUTO_TEST_CASE(xml_element_forest_index)
+{
+    adobe::element_forest_t       forest(adobe::xml_parse_to_forest(test_document));
+    adobe::element_forest_index_t index(forest);
+
+    BOOST_CHECK_MESSAGE(index_find(index, "operand") == walk_find(forest, "operand"),
+                        "find by name");
+    BOOST_CHECK_MESSAGE(values(index_find(index, "operand")) == "2345", "find in document order");
+    BOOST_CHECK_MESSAGE(index_find(index, "divide").empty(), "find missing name");
+
+    BOOST_CHECK_MESSAGE(values(index_find_path(index, "expression", "operand")) == "2345",
+                        "path, nested scopes counted once");
+    BOOST_CHECK_EQUAL(values(index_find_path(index, "expression", "expression", "operand")), "45");
+    BOOST_CHECK_MESSAGE(index_find_path(index, "result", "operand").empty(),
+                        "path without matches");
+
+    iterator_set_t result_set;
+
+    index.find(adobe::name_t("value"), "46", std::back_inserter(result_set));
+
+    BOOST_CHECK_MESSAGE(result_set.size() == 1 && element_name(result_set[0]) == "result",
+                        "find by attribute value");
+
+    // insert and erase through the index
+
+    iterator inner(walk_find(forest, "expression")[1]);
+
+    index.insert(adobe::trailing_of(inner), make_element("operand", "6"));
+
+    iterator_set_t descendant_set;
+
+    index.find_descendants(inner, adobe::name_t("operand"), std::back_inserter(descendant_set));
+
+    BOOST_CHECK_MESSAGE(values(descendant_set) == "456", "find below an inserted node");
+    BOOST_CHECK_MESSAGE(values(index_find_path(index, "expression", "operand")) == "23456",
+                        "path after insert");
+
+    result_set.clear();
+
+    index.find(adobe::name_t("value"), "6", std::back_inserter(result_set));
+
+    BOOST_CHECK_MESSAGE(result_set.size() == 1, "attribute of an inserted node");
+
+    // enough insertions at one place to use up the room between labels
+
+    iterator position(adobe::trailing_of(inner));
+
+    for (int i(0); i != 200; ++i)
+        position = index.insert(position, make_element("operand", "7"));
+
+    BOOST_CHECK_MESSAGE(index_find(index, "operand") == walk_find(forest, "operand"),
+                        "find after many insertions");
+    BOOST_CHECK_MESSAGE(index_find_path(index, "expression", "expression", "operand").size() == 203,
+                        "path after many insertions");
+
+    index.erase(walk_find(forest, "expression")[0]);
+
+    BOOST_CHECK_MESSAGE(index_find(index, "operand").empty(), "erase removes descendants");
+    BOOST_CHECK_MESSAGE(index_find(index, "expression").empty(), "erase removes the node");
+    BOOST_CHECK_MESSAGE(index_find(index, "result") == walk_find(forest, "result"),
+                        "erase keeps others");
+
+    result_set.clear();
+
+    index.find(adobe::name_t("value"), "7", std::back_inserter(result_set));
+
+    BOOST_CHECK_MESSAGE(result_set.empty(), "erase removes attributes");
+}
+
+/****************************************************************************************************/
@@ -5,9 +5,16 @@
 */
 /****************************************************************************************************/
 
-#include <exception>
+#define BOOST_TEST_MAIN
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
 #include <iostream>
+#include <sstream>
+#include <string>
 
+#include <adobe/xml_element_arena_forest.hpp>
 #include <adobe/xml_element_forest.hpp>
 
 /****************************************************************************************************/
@@ -94,18 +101,91 @@ const char* const test_document_5 =
     "</html>";
 
 /****************************************************************************************************/
+/*
+    Writes the forest parsed from xml back out in a canonical form: tags
+    without whitespace, every element with an end tag, attributes quoted
+    with '. Only the dictionaries are looked at, so this checks the parse
+    alone.
+*/
+std::string parse_canonical(const char* xml)
+{
+    typedef adobe::element_forest_t::const_iterator iterator;
 
-} // namespace
+    adobe::element_forest_t forest(adobe::xml_parse_to_forest(xml));
+    std::string             result;
+
+    for (iterator iter(forest.begin()), last(forest.end()); iter != last; ++iter)
+    {
+        const adobe::dictionary_t& node(*iter);
+        const std::string&         type(get_value(node, adobe::name_type()).cast<std::string>());
+
+        if (type == "chardata")
+        {
+            if (iter.edge() == adobe::forest_leading_edge)
+                result += get_value(node, adobe::name_chardata()).cast<std::string>();
+
+            continue;
+        }
+
+        const std::string& name(get_value(node, adobe::name_element_name()).cast<std::string>());
+
+        if (iter.edge() == adobe::forest_trailing_edge)
+        {
+            result += "</" + name + ">";
+
+            continue;
+        }
+
+        result += "<" + name;
+
+        for (adobe::dictionary_t::const_iterator attribute(node.begin()), attribute_last(node.end());
+             attribute != attribute_last; ++attribute)
+        {
+            if (attribute->first.c_str()[0] == '>')
+                continue;
+
+            result += std::string(" ") + attribute->first.c_str() + "='" +
+                      attribute->second.cast<std::string>() + "'";
+        }
+
+        result += ">";
+    }
+
+    return result;
+}
 
 /****************************************************************************************************/
 
-int main()
-try
+std::string serialize(const adobe::element_forest_t& forest, bool verbose)
 {
-    //adobe::element_forest_to_xml(adobe::depth_range(adobe::xml_parse_to_forest(test_document_1)), std::cout);
+    std::ostringstream result;
 
-    //adobe::element_forest_to_xml(adobe::depth_range(adobe::xml_parse_to_forest(test_document_2)), std::cout);
+    adobe::element_forest_to_xml(adobe::depth_range(forest), result, verbose);
 
+    return result.str();
+}
+
+/****************************************************************************************************/
+
+std::string serialize_parallel(const adobe::element_forest_t& forest,
+                               bool                           verbose,
+                               std::size_t                    thread_count)
+{
+    std::ostringstream result;
+
+    adobe::element_forest_to_xml_parallel(forest, result, verbose, thread_count);
+
+    return result.str();
+}
+
+/****************************************************************************************************/
+
+} // namespace
+
+/****************************************************************************************************/
+
+BOOST_AUTO_TEST_CASE(xml_to_forest)
+{
     adobe::element_forest_to_xml(adobe::depth_range(adobe::xml_parse_to_forest(test_document_3)), std::cout);
 
     adobe::element_forest_to_xml(adobe::depth_range(adobe::xml_parse_to_forest(test_document_4)), std::cout);
@@ -116,19 +196,103 @@ try
 
     std::cout << std::endl;
 
-    return 0;
+    adobe::element_arena_forest_t arena_forest(test_document_5);
+
+    adobe::element_forest_to_xml(adobe::depth_range(arena_forest.to_element_forest()), std::cout, false);
+
+    std::cout << std::endl;
+}
+
+/****************************************************************************************************/
+
+BOOST_AUTO_TEST_CASE(xml_to_forest_markup)
+{
+    // comments within character data are dropped, whatever they contain
+
+    BOOST_CHECK_EQUAL(parse_canonical("<a>x<!-- c -->y</a>"), "<a>xy</a>");
+    BOOST_CHECK_EQUAL(parse_canonical("<a>x<!-- <b> -> --->y</a>"), "<a>xy</a>");
+
+    // a CDATA section is kept whole, markup and all
+
+    BOOST_CHECK_EQUAL(parse_canonical("<a>x<![CDATA[<b>&]>]]>y</a>"), "<a>x<![CDATA[<b>&]>]]>y</a>");
+
+    // processing instructions and the XML declaration are dropped
+
+    BOOST_CHECK_EQUAL(parse_canonical("<?xml version='1.0'?><a><?pi x > y?>z</a>"), "<a>z</a>");
+
+    // document type declarations are dropped, internal subset and all
+
+    BOOST_CHECK_EQUAL(parse_canonical("<!DOCTYPE a SYSTEM \"a>b.dtd\"><a/>"), "<a></a>");
+    BOOST_CHECK_EQUAL(parse_canonical("<!DOCTYPE a [ <!ENTITY e 'v'> ]><a/>"), "<a></a>");
+    BOOST_CHECK_EQUAL(parse_canonical("<!DOCTYPE a [ <!ENTITY e ']>'> <!-- ]> --> <?pi ]>?> ]><a/>"),
+                      "<a></a>");
+
+    // a '>' within an attribute value does not end the tag
+
+    BOOST_CHECK_EQUAL(parse_canonical("<a v='x>y'>z</a>"), "<a v='x>y'>z</a>");
+    BOOST_CHECK_EQUAL(parse_canonical("<a v=\"x>y\"/>"), "<a v='x>y'></a>");
+
+    // empty element tags
+
+    BOOST_CHECK_EQUAL(parse_canonical("<a><b/><c /><d></d></a>"), "<a><b></b><c></c><d></d></a>");
 }
-catch(const std::exception& error)
+
+/****************************************************************************************************/
+
+BOOST_AUTO_TEST_CASE(xml_to_forest_errors)
 {
-    std::cerr << "Exception: " << error.what() << std::endl;
+    // mismatched end tags
+
+    BOOST_CHECK_THROW(adobe::xml_parse_to_forest("<a></b>"), adobe::stream_error_t);
+    BOOST_CHECK_THROW(adobe::xml_parse_to_forest("<a><b></a></b>"), adobe::stream_error_t);
+    BOOST_CHECK_THROW(adobe::xml_parse_to_forest("</a>"), adobe::stream_error_t);
+
+    // unterminated elements
 
-    return 1;
+    BOOST_CHECK_THROW(adobe::xml_parse_to_forest("<a><b></b>"), adobe::stream_error_t);
+    BOOST_CHECK_THROW(adobe::xml_parse_to_forest("<a"), adobe::stream_error_t);
+
+    // unterminated markup
+
+    BOOST_CHECK_THROW(adobe::xml_parse_to_forest("<a><!-- </a>"), adobe::stream_error_t);
+    BOOST_CHECK_THROW(adobe::xml_parse_to_forest("<!DOCTYPE a [ <!ENTITY e 'v'> <a/>"),
+                      adobe::stream_error_t);
 }
-catch(...)
+
+/****************************************************************************************************/
+
+BOOST_AUTO_TEST_CASE(xml_to_forest_parallel)
 {
-    std::cerr << "Exception" << std::endl;
+    // several top-level subtrees, top-level character data among them
+
+    std::string document(test_document_4);
+
+    document += "loose text";
+    document += test_document_5;
+    document += "<empty/>";
+    document += test_document_3;
+    document += "<leaf value='x'>y</leaf>";
+
+    adobe::element_forest_t forest(adobe::xml_parse_to_forest(document.c_str()));
+    adobe::element_forest_t empty_forest;
+
+    // 0 is one thread per hardware thread; 64 is more threads than subtrees
+
+    const std::size_t thread_count_set[] = { 1, 2, 3, 0, 64 };
+
+    for (int verbose(0); verbose != 2; ++verbose)
+    {
+        std::string expected(serialize(forest, verbose != 0));
+
+        BOOST_CHECK(!expected.empty());
 
-    return 1;
+        for (std::size_t i(0); i != sizeof(thread_count_set) / sizeof(thread_count_set[0]); ++i)
+        {
+            BOOST_CHECK_EQUAL(serialize_parallel(forest, verbose != 0, thread_count_set[i]), expected);
+            BOOST_CHECK_EQUAL(serialize_parallel(empty_forest, verbose != 0, thread_count_set[i]),
+                              serialize(empty_forest, verbose != 0));
+        }
+    }
 }
 
 /****************************************************************************************************/
@@ -0,0 +1,308 @@
+/*
+    Copyright 2013 Adobe
+    Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+*/
+/****************************************************************************************************/
+
+#include <adobe/config.hpp>
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+#include <adobe/timer.hpp>
+#include <adobe/xml_element_arena_forest.hpp>
+#include <adobe/xml_element_forest.hpp>
+#include <adobe/xml_element_forest_index.hpp>
+
+/****************************************************************************************************/
+
+namespace {
+
+/****************************************************************************************************/
+
+void open_element(std::ostream& stream, std::size_t index)
+{
+    stream << "<node index='" << index << "' kind=\"generated\">text " << index;
+}
+
+void close_element(std::ostream& stream)
+{
+    stream << "</node>";
+}
+
+/****************************************************************************************************/
+
+// element_count elements, each nested inside the one before
+
+std::string deep_document(std::size_t element_count)
+{
+    std::ostringstream result;
+
+    for (std::size_t i(0); i != element_count; ++i)
+        open_element(result, i);
+
+    for (std::size_t i(0); i != element_count; ++i)
+        close_element(result);
+
+    return result.str();
+}
+
+// element_count sibling elements under a single root
+
+std::string wide_document(std::size_t element_count)
+{
+    std::ostringstream result;
+
+    result << "<root>\n";
+
+    for (std::size_t i(0); i != element_count; ++i)
+    {
+        result << "    ";
+
+        open_element(result, i);
+        close_element(result);
+
+        result << "\n";
+    }
+
+    result << "</root>\n";
+
+    return result.str();
+}
+
+// a tree of the given depth in which every element has branch_count children
+
+void bushy_element(std::ostream& stream, std::size_t depth, std::size_t branch_count, std::size_t& index)
+{
+    open_element(stream, index++);
+
+    if (depth != 0)
+        for (std::size_t i(0); i != branch_count; ++i)
+            bushy_element(stream, depth - 1, branch_count, index);
+
+    close_element(stream);
+}
+
+std::string bushy_document(std::size_t depth, std::size_t branch_count)
+{
+    std::ostringstream result;
+    std::size_t        index(0);
+
+    bushy_element(result, depth, branch_count, index);
+
+    return result.str();
+}
+
+/****************************************************************************************************/
+
+std::size_t parse_to_forest(const std::string& document)
+{
+    return adobe::xml_parse_to_forest(document.c_str()).size();
+}
+
+std::size_t parse_to_arena_forest(const std::string& document)
+{
+    return adobe::element_arena_forest_t(document.c_str()).size();
+}
+
+/****************************************************************************************************/
+
+void run(const char* label,
+         std::size_t (*parse)(const std::string&),
+         const std::string& document,
+         std::size_t repeat_count)
+{
+    std::size_t node_count(0);
+
+    adobe::timer_t timer;
+
+    for (std::size_t i(0); i != repeat_count; ++i)
+        node_count = parse(document);
+
+    double time(timer.split() / repeat_count);
+
+    std::cout << std::setw(30) << label
+              << std::setw(12) << document.size()
+              << std::setw(12) << node_count
+              << std::setw(14) << time
+              << std::setw(14) << time * 1e6 / document.size()
+              << std::endl;
+}
+
+void run_to_xml(const char* label, const std::string& document, std::size_t thread_count)
+{
+    adobe::element_forest_t forest(adobe::xml_parse_to_forest(document.c_str()));
+    std::size_t             size(0);
+    const std::size_t       repeat_count(10);
+
+    adobe::timer_t timer;
+
+    for (std::size_t i(0); i != repeat_count; ++i)
+    {
+        std::ostringstream output;
+
+        if (thread_count == 1)
+            adobe::element_forest_to_xml(adobe::depth_range(forest), output);
+        else
+            adobe::element_forest_to_xml_parallel(forest, output, true, thread_count);
+
+        size = output.str().size();
+    }
+
+    double time(timer.split() / repeat_count);
+
+    std::cout << std::setw(30) << label
+              << std::setw(12) << size
+              << std::setw(12) << forest.size()
+              << std::setw(14) << time
+              << std::setw(14) << time * 1e6 / size
+              << std::endl;
+}
+
+// lookups of single elements by attribute value, by walking the forest and through an index
+
+void run_lookup(const std::string& document, std::size_t lookup_count)
+{
+    adobe::element_forest_t forest(adobe::xml_parse_to_forest(document.c_str()));
+    const adobe::name_t     name_index("index");
+    std::size_t             found_count(0);
+
+    {
+    adobe::timer_t timer;
+
+    for (std::size_t i(0); i != lookup_count; ++i)
+    {
+        std::ostringstream value;
+
+        value << i * 7;
+
+        for (adobe::element_forest_t::iterator first(forest.begin()), last(forest.end());
+             first != last; ++first)
+        {
+            std::string index;
+
+            if (first.edge() == adobe::forest_leading_edge &&
+                adobe::get_value(*first, name_index, index) && index == value.str())
+                ++found_count;
+        }
+    }
+
+    double time(timer.split());
+
+    std::cout << std::setw(30) << "walk" << std::setw(14) << time
+              << std::setw(14) << time * 1e6 / lookup_count << std::endl;
+    }
+
+    {
+    adobe::timer_t                timer;
+    adobe::element_forest_index_t index(forest);
+
+    std::cout << std::setw(30) << "index, build" << std::setw(14) << timer.split() << std::endl;
+
+    timer.reset();
+
+    std::vector<adobe::element_forest_t::iterator> result;
+
+    for (std::size_t i(0); i != lookup_count; ++i)
+    {
+        std::ostringstream value;
+
+        value << i * 7;
+
+        result.clear();
+
+        index.find(name_index, value.str(), std::back_inserter(result));
+
+        found_count -= result.size();
+    }
+
+    double time(timer.split());
+
+    std::cout << std::setw(30) << "index" << std::setw(14) << time
+              << std::setw(14) << time * 1e6 / lookup_count << std::endl;
+    }
+
+    if (found_count != 0)
+        std::cout << "lookup mismatch" << std::endl;
+}
+
+/****************************************************************************************************/
+
+} // namespace
+
+/****************************************************************************************************/
+
+int main(int argc, char** argv)
+try
+{
+    std::size_t element_count(2000);
+
+    if (argc > 1)
+        element_count = std::atoi(argv[1]);
+
+    const std::string deep(deep_document(element_count));
+    const std::string deep_x4(deep_document(element_count * 4));
+    const std::string wide(wide_document(element_count));
+    const std::string wide_x4(wide_document(element_count * 4));
+    const std::string bushy(bushy_document(6, 4));
+
+    std::cout << "milliseconds per parse and nanoseconds per byte:" << std::endl;
+
+    std::cout << std::setw(30) << "document"
+              << std::setw(12) << "bytes"
+              << std::setw(12) << "nodes"
+              << std::setw(14) << "per parse"
+              << std::setw(14) << "per byte"
+              << std::endl;
+
+    run("deep", &parse_to_forest, deep, 10);
+    run("deep, x4", &parse_to_forest, deep_x4, 10);
+    run("wide", &parse_to_forest, wide, 10);
+    run("wide, x4", &parse_to_forest, wide_x4, 10);
+    run("bushy (depth 6, 4-ary)", &parse_to_forest, bushy, 10);
+
+    // the same documents into an element_arena_forest_t
+
+    run("arena, deep", &parse_to_arena_forest, deep, 10);
+    run("arena, deep, x4", &parse_to_arena_forest, deep_x4, 10);
+    run("arena, wide", &parse_to_arena_forest, wide, 10);
+    run("arena, wide, x4", &parse_to_arena_forest, wide_x4, 10);
+    run("arena, bushy (depth 6, 4-ary)", &parse_to_arena_forest, bushy, 10);
+
+    std::cout << "element_forest_to_xml, verbose: milliseconds per write and nanoseconds per "
+              << "byte written:" << std::endl;
+
+    // four top-level subtrees, for element_forest_to_xml_parallel to divide
+
+    const std::string bushy_x4(bushy + bushy + bushy + bushy);
+
+    run_to_xml("wide, x4", wide_x4, 1);
+    run_to_xml("bushy x4", bushy_x4, 1);
+    run_to_xml("bushy x4, parallel", bushy_x4, 0);
+
+    std::cout << "1000 lookups by attribute value in wide, x4: total milliseconds and "
+              << "nanoseconds per lookup:" << std::endl;
+
+    run_lookup(wide_x4, 1000);
+
+    return 0;
+}
+catch (const std::exception& error)
+{
+    std::cerr << "Exception: " << error.what() << std::endl;
+
+    return 1;
+}
+catch (...)
+{
+    std::cerr << "Exception: unknown" << std::endl;
+
+    return 1;
+}
+
+/****************************************************************************************************/